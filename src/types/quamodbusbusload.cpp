@@ -0,0 +1,234 @@
+#include "quamodbusbusload.h"
+#include "quamodbusclient.h"
+#include "quamodbusrtuserialclient.h"
+#include "quamodbusdatablock.h"
+
+#include <QMetaEnum>
+#include <QtMath>
+
+double  QUaModbusBusLoad::m_targetUtilisation = 70.0;
+double  QUaModbusBusLoad::m_defaultTurnaround = 5.0;
+double  QUaModbusBusLoad::m_maxTurnaround     = 50.0;
+double  QUaModbusBusLoad::m_defaultRoundTrip  = 10.0;
+quint32 QUaModbusBusLoad::m_periodGranularity = 10;
+
+namespace
+{
+
+// start, data, parity and stop bits
+double serialCharBits(QUaModbusRtuSerialClient * serial)
+{
+	double bits = 1.0 + static_cast<double>(serial->getDataBits());
+	bits += serial->getParity() == QSerialPort::NoParity ? 0.0 : 1.0;
+	bits += serial->getStopBits() == QSerialPort::OneAndHalfStop ? 1.5 : static_cast<double>(serial->getStopBits());
+	return bits;
+}
+
+QString serialLink(QUaModbusRtuSerialClient * serial)
+{
+	QString strParity;
+	switch (serial->getParity())
+	{
+	case QSerialPort::EvenParity:
+		strParity = "E";
+		break;
+	case QSerialPort::OddParity:
+		strParity = "O";
+		break;
+	case QSerialPort::NoParity:
+		strParity = "N";
+		break;
+	default:
+		strParity = "?";
+		break;
+	}
+	QString strStop = serial->getStopBits() == QSerialPort::OneAndHalfStop ? QString("1.5") : QString::number(serial->getStopBits());
+	return QString("%1 %2%3%4")
+		.arg(static_cast<int>(serial->getBaudRate()))
+		.arg(static_cast<int>(serial->getDataBits()))
+		.arg(strParity)
+		.arg(strStop);
+}
+
+// rtu adds address and crc, tcp adds mbap header
+int frameOverhead(QUaModbusClient * client)
+{
+	return qobject_cast<QUaModbusRtuSerialClient*>(client) ? 3 : 7;
+}
+
+quint32 roundUpPeriod(const double &period)
+{
+	quint32 granularity = qMax(static_cast<quint32>(1), QUaModbusBusLoad::m_periodGranularity);
+	return static_cast<quint32>(qCeil(period / granularity)) * granularity;
+}
+
+} // namespace
+
+QUaModbusClientLoad QUaModbusBusLoad::analyze(QUaModbusClient * client)
+{
+	QUaModbusClientLoad load;
+	load.strClientId = client->browseName().name();
+	load.utilisation = 0.0;
+	load.feasible    = true;
+	auto serial = qobject_cast<QUaModbusRtuSerialClient*>(client);
+	load.strLink = serial ? serialLink(serial) : QString("TCP");
+	quint32 scanCycleTime = client->getScanCycleTime();
+	auto metaType = QMetaEnum::fromType<QModbusDataBlockType>();
+	auto blocks = client->dataBlocks()->blocks();
+	for (auto block : blocks)
+	{
+		QUaModbusBlockLoad blockLoad;
+		auto type = block->getType();
+		blockLoad.strBlockId      = block->browseName().name();
+		blockLoad.strType         = QString(metaType.valueToKey(type));
+		blockLoad.size            = block->getSize();
+		blockLoad.period          = block->getScanGroup() && scanCycleTime > 0 ? scanCycleTime : block->getSamplingTime();
+		blockLoad.requests        = 0;
+		blockLoad.requestBytes    = 0;
+		blockLoad.responseBytes   = 0;
+		blockLoad.requestTime     = 0.0;
+		blockLoad.measured        = false;
+		blockLoad.busTime         = 0.0;
+		blockLoad.utilisation     = 0.0;
+		blockLoad.feasible        = true;
+		blockLoad.suggestedPeriod = blockLoad.period;
+		// only periodic reads load the link
+		if (block->getBroadcast() || block->getTriggerOnly() || type == QModbusDataBlockType::Invalid || blockLoad.size == 0)
+		{
+			blockLoad.period          = 0;
+			blockLoad.suggestedPeriod = 0;
+			load.blocks << blockLoad;
+			continue;
+		}
+		// repaired blocks read each valid range with its own request
+		QVector<int> sizes;
+		if (block->getRepairLayout().isEmpty())
+		{
+			sizes << static_cast<int>(blockLoad.size);
+		}
+		else
+		{
+			sizes = block->getRepairRanges();
+		}
+		bool isBits = type == QModbusDataBlockType::Coils || type == QModbusDataBlockType::DiscreteInputs;
+		quint32 maxRead = isBits ? QUaModbusBusLoad::m_maxReadBits : QUaModbusBusLoad::m_maxReadRegisters;
+		double latency = block->diagnostics()->getSample().latencyP50;
+		blockLoad.requests = static_cast<quint32>(sizes.count());
+		blockLoad.measured = latency > 0.0;
+		for (auto size : sizes)
+		{
+			if (static_cast<quint32>(size) > maxRead)
+			{
+				blockLoad.feasible = false;
+				blockLoad.strIssue = QObject::tr("Size exceeds %1 per read request.").arg(maxRead);
+			}
+			blockLoad.requestBytes  += QUaModbusBusLoad::readRequestBytes(client);
+			blockLoad.responseBytes += QUaModbusBusLoad::readResponseBytes(client, type, static_cast<quint32>(size));
+			blockLoad.busTime       += QUaModbusBusLoad::readTime(client, type, static_cast<quint32>(size), latency);
+		}
+		// mean over the requests of one poll
+		blockLoad.requestTime = blockLoad.requests > 0 ? blockLoad.busTime / blockLoad.requests : 0.0;
+		blockLoad.utilisation = blockLoad.period > 0 ? 100.0 * blockLoad.busTime / blockLoad.period : 100.0;
+		if (blockLoad.feasible && blockLoad.busTime >= blockLoad.period)
+		{
+			blockLoad.feasible = false;
+			blockLoad.strIssue = QObject::tr("Bus time %1 ms exceeds sampling time.").arg(blockLoad.busTime, 0, 'f', 1);
+		}
+		load.utilisation += blockLoad.utilisation;
+		load.blocks << blockLoad;
+	}
+	// overcommitted link, stretch all periods by the same factor to reach target utilisation
+	double target = qBound(1.0, QUaModbusBusLoad::m_targetUtilisation, 100.0);
+	double scale  = qMax(1.0, load.utilisation / target);
+	for (auto &blockLoad : load.blocks)
+	{
+		if (blockLoad.period == 0)
+		{
+			continue;
+		}
+		double suggested = qMax(blockLoad.period * scale, 100.0 * blockLoad.busTime / target);
+		blockLoad.suggestedPeriod = qMax(blockLoad.period, roundUpPeriod(suggested));
+		if (load.utilisation > 100.0 && blockLoad.feasible)
+		{
+			blockLoad.feasible = false;
+			blockLoad.strIssue = QObject::tr("Client link overcommitted.");
+		}
+		load.feasible = load.feasible && blockLoad.feasible;
+	}
+	return load;
+}
+
+quint32 QUaModbusBusLoad::readRequestBytes(QUaModbusClient * client)
+{
+	// function code, address, count
+	return 5 + static_cast<quint32>(frameOverhead(client));
+}
+
+quint32 QUaModbusBusLoad::readResponseBytes(QUaModbusClient * client, const QModbusDataBlockType & type, const quint32 & size)
+{
+	bool isBits = type == QModbusDataBlockType::Coils || type == QModbusDataBlockType::DiscreteInputs;
+	// function code, byte count, data
+	return 2 + (isBits ? (size + 7) / 8 : 2 * size) + static_cast<quint32>(frameOverhead(client));
+}
+
+double QUaModbusBusLoad::readTime(QUaModbusClient * client, const QModbusDataBlockType & type, const quint32 & size, const double & latency)
+{
+	auto serial = qobject_cast<QUaModbusRtuSerialClient*>(client);
+	if (!serial)
+	{
+		return latency > 0.0 ? latency : QUaModbusBusLoad::m_defaultRoundTrip;
+	}
+	// rtu frames are separated by 3.5 characters of silence
+	double baudRate = static_cast<double>(serial->getBaudRate());
+	double charTime = baudRate > 0.0 ? 1000.0 * serialCharBits(serial) / baudRate : 0.0;
+	double wireTime = (QUaModbusBusLoad::readRequestBytes(client) + QUaModbusBusLoad::readResponseBytes(client, type, size) + 7.0) * charTime;
+	if (latency <= 0.0)
+	{
+		return wireTime + QUaModbusBusLoad::m_defaultTurnaround;
+	}
+	// NOTE : measured latency includes waiting behind other requests queued on the same port,
+	//        counting it as bus time would charge the same wire time twice
+	return qBound(wireTime, latency, wireTime + QUaModbusBusLoad::m_maxTurnaround);
+}
+
+QString QUaModbusBusLoad::toCsv(const QList<QUaModbusClientLoad>& loads)
+{
+	// request times not measured by block diagnostics are marked with *
+	QString strCsv = QString("%1, %2, %3, %4, %5, %6, %7, %8, %9, %10, %11, %12, %13, %14\n")
+		.arg(QObject::tr("Client"))
+		.arg(QObject::tr("Link"))
+		.arg(QObject::tr("ClientUtilisation"))
+		.arg(QObject::tr("Block"))
+		.arg(QObject::tr("Type"))
+		.arg(QObject::tr("Size"))
+		.arg(QObject::tr("SamplingTime"))
+		.arg(QObject::tr("RequestBytes"))
+		.arg(QObject::tr("ResponseBytes"))
+		.arg(QObject::tr("RequestTime"))
+		.arg(QObject::tr("Utilisation"))
+		.arg(QObject::tr("Feasible"))
+		.arg(QObject::tr("SuggestedSamplingTime"))
+		.arg(QObject::tr("Issue"));
+	for (auto &load : loads)
+	{
+		for (auto &blockLoad : load.blocks)
+		{
+			strCsv += QString("%1, %2, %3, %4, %5, %6, %7, %8, %9, %10, %11, %12, %13, %14\n")
+				.arg(load.strClientId)
+				.arg(load.strLink)
+				.arg(load.utilisation, 0, 'f', 1)
+				.arg(blockLoad.strBlockId)
+				.arg(blockLoad.strType)
+				.arg(blockLoad.size)
+				.arg(blockLoad.period)
+				.arg(blockLoad.requestBytes)
+				.arg(blockLoad.responseBytes)
+				.arg(QString("%1%2").arg(blockLoad.requestTime, 0, 'f', 2).arg(blockLoad.measured ? "" : "*"))
+				.arg(blockLoad.utilisation, 0, 'f', 1)
+				.arg(blockLoad.feasible ? 1 : 0)
+				.arg(blockLoad.suggestedPeriod)
+				.arg(blockLoad.strIssue);
+		}
+	}
+	return strCsv;
+}
@@ -0,0 +1,71 @@
+#ifndef QUAMODBUSBUSLOAD_H
+#define QUAMODBUSBUSLOAD_H
+
+#include <QString>
+#include <QList>
+
+#include "quamodbusdatablock.h"
+
+class QUaModbusClient;
+
+// estimated link time needed by one block to meet its sampling time
+struct QUaModbusBlockLoad
+{
+	QString strBlockId;
+	QString strType;
+	quint32 size;
+	quint32 period;         // ms, SamplingTime (or client ScanCycleTime for scan group), 0 if not polled
+	quint32 requests;       // per poll
+	quint32 requestBytes;   // adu bytes per poll
+	quint32 responseBytes;  // adu bytes per poll
+	double  requestTime;    // ms, mean request round trip (measured or estimated)
+	bool    measured;       // request time from block diagnostics latency
+	double  busTime;        // ms per poll
+	double  utilisation;    // percent of link time
+	bool    feasible;
+	quint32 suggestedPeriod; // ms
+	QString strIssue;
+};
+
+// estimated link time needed by all blocks of one client
+struct QUaModbusClientLoad
+{
+	QString strClientId;
+	QString strLink;     // serial parameters or TCP
+	double  utilisation; // percent of link time, sum of blocks
+	bool    feasible;
+	QList<QUaModbusBlockLoad> blocks;
+};
+
+// offline schedule feasibility, polls of one client are assumed to be serialized on its link
+// NOTE : only call in ua server thread (reads configuration and diagnostics)
+class QUaModbusBusLoad
+{
+public:
+	static QUaModbusClientLoad analyze(QUaModbusClient * client);
+
+	// adu bytes of one read request and its response over the client link
+	static quint32 readRequestBytes (QUaModbusClient * client);
+	static quint32 readResponseBytes(QUaModbusClient * client, const QModbusDataBlockType &type, const quint32 &size);
+	// ms to complete one read, measured latency (ms) replaces the default turnaround or round trip if > 0
+	// NOTE : for rtu the measured turnaround is capped at m_maxTurnaround
+	static double  readTime(QUaModbusClient * client, const QModbusDataBlockType &type, const quint32 &size, const double &latency = 0.0);
+
+	static QString toCsv(const QList<QUaModbusClientLoad> &loads);
+
+	// suggested periods keep client utilisation below this percent
+	static double  m_targetUtilisation;
+	// ms, rtu server response time when not measured
+	static double  m_defaultTurnaround;
+	// ms, rtu server response time assumed at most, longer measured latencies are queueing
+	static double  m_maxTurnaround;
+	// ms, tcp round trip when not measured
+	static double  m_defaultRoundTrip;
+	// suggested periods are rounded up to this many ms
+	static quint32 m_periodGranularity;
+	// spec limits for a single read request
+	static const quint32 m_maxReadRegisters = 125;
+	static const quint32 m_maxReadBits      = 2000;
+};
+
+#endif // QUAMODBUSBUSLOAD_H
@@ -2,8 +2,19 @@
 
 #include <QMutexLocker>
 
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#else
+#include <time.h>
+#endif // Q_OS_WIN
+
 #include <QUaModbusDataBlock>
 #include <QUaModbusClientList>
+#include <QUaModbusMetrics>
+
+quint32 QUaModbusClient::m_quarantineTimeouts = 3;
+quint32 QUaModbusClient::m_probePeriod        = 2000;
+quint32 QUaModbusClient::m_statisticsPeriod   = 1000;
 
 QUaModbusClient::QUaModbusClient(QUaServer *server)
 #ifndef QUA_ACCESS_CONTROL
@@ -14,12 +25,41 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	, m_mutex(QMutex::Recursive)
 {
 	m_disconnectRequested = false;
+	m_quarantined = false;
+	m_consecutiveTimeouts = 0;
+	m_probeHandle = -1;
+	m_replyProbe = nullptr;
+	m_probeValid = false;
+	m_probeType = QModbusDataUnit::Invalid;
+	m_probeAddress = 0;
+	m_scanHandle = -1;
+	m_scanPeriod = 0;
+	m_scanning = false;
+	m_scanOverrunCount = 0;
+	m_statsHandle = -1;
+	m_statRequests = 0;
+	m_statBytes = 0;
+	m_statBusTime = 0.0;
+	m_statPending = 0;
+	m_statCpuTime = 0;
+	m_lagHandle = -1;
+	m_requestLogEnabled = false;
 	m_type = nullptr;
 	m_serverAddress = nullptr;
 	m_keepConnecting = nullptr;
+	m_scanCycleTime = nullptr;
+	m_logRequests = nullptr;
 	m_state = nullptr;
 	m_lastError = nullptr;
+	m_scanTime = nullptr;
+	m_scanOverruns = nullptr;
+	m_requestRate = nullptr;
+	m_byteRate = nullptr;
+	m_busUsage = nullptr;
+	m_queueDepth = nullptr;
+	m_cpuUsage = nullptr;
 	m_dataBlocks = nullptr;
+	m_workerLoop = nullptr;
 	if (QMetaType::type("QModbusError") == QMetaType::UnknownType)
 	{
 		qRegisterMetaType<QModbusError>("QModbusError");
@@ -28,6 +68,10 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	{
 		qRegisterMetaType<QModbusState>("QModbusState");
 	}
+	if (QMetaType::type("QUaModbusLoopSample") == QMetaType::UnknownType)
+	{
+		qRegisterMetaType<QUaModbusLoopSample>("QUaModbusLoopSample");
+	}
 	// set defaults
 	state         ()->setDataTypeEnum(QMetaEnum::fromType<QModbusState>());
 	state         ()->setValue(QModbusState::UnconnectedState);
@@ -36,9 +80,28 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	serverAddress ()->setDataType(QMetaType::UChar);
 	serverAddress ()->setValue(1);
 	keepConnecting()->setValue(false);
+	scanCycleTime ()->setDataType(QMetaType::UInt);
+	scanCycleTime ()->setValue(0);
+	logRequests   ()->setValue(false);
+	scanTime      ()->setDataType(QMetaType::Double);
+	scanTime      ()->setValue(0.0);
+	scanOverruns  ()->setDataType(QMetaType::UInt);
+	scanOverruns  ()->setValue(0);
+	requestRate   ()->setDataType(QMetaType::Double);
+	requestRate   ()->setValue(0.0);
+	byteRate      ()->setDataType(QMetaType::Double);
+	byteRate      ()->setValue(0.0);
+	busUsage      ()->setDataType(QMetaType::Double);
+	busUsage      ()->setValue(0.0);
+	queueDepth    ()->setDataType(QMetaType::UInt);
+	queueDepth    ()->setValue(0);
+	cpuUsage      ()->setDataType(QMetaType::Double);
+	cpuUsage      ()->setValue(0.0);
 	// set initial conditions
 	serverAddress ()->setWriteAccess(true);
 	keepConnecting()->setWriteAccess(true);
+	scanCycleTime ()->setWriteAccess(true);
+	logRequests   ()->setWriteAccess(true);
 	// set descriptions
 	/*
 	type          ()->setDescription(tr("Modbus client communication type (TCP or RTU Serial)."));
@@ -47,15 +110,57 @@ QUaModbusClient::QUaModbusClient(QUaServer *server)
 	state         ()->setDescription(tr("Modbus connection state."));
 	lastError     ()->setDescription(tr("Last error occured at connection level."));
 	dataBlocks    ()->setDescription(tr("List of Modbus data blocks updated through polling."));
+	workerLoop    ()->setDescription(tr("Event loop latency and stalls of the client worker thread."));
+	scanCycleTime ()->setDescription(tr("Period to read all ScanGroup blocks back-to-back and publish them as one snapshot (0 = disabled)."));
+	logRequests   ()->setDescription(tr("Whether to log requests and responses, rebuilt from data units, for export as pcap."));
+	scanTime      ()->setDescription(tr("Duration in milliseconds of the last scan cycle."));
+	scanOverruns  ()->setDescription(tr("Number of scan cycles missed because the previous scan was still running."));
+	requestRate   ()->setDescription(tr("Requests per second sent to the Modbus server."));
+	byteRate      ()->setDescription(tr("Bytes per second sent and received, including protocol framing."));
+	busUsage      ()->setDescription(tr("Estimated percent of serial bus time used by this client (0 for TCP)."));
+	queueDepth    ()->setDescription(tr("Number of requests sent and not yet replied."));
+	cpuUsage      ()->setDescription(tr("Percent of one CPU core used by the client worker thread."));
 	*/
 	// handle changes
 	QObject::connect(serverAddress() , &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_serverAddressChanged , Qt::QueuedConnection);
 	QObject::connect(keepConnecting(), &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_keepConnectingChanged, Qt::QueuedConnection);
+	QObject::connect(scanCycleTime() , &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_scanCycleTimeChanged , Qt::QueuedConnection);
+	QObject::connect(logRequests()   , &QUaBaseVariable::valueChanged, this, &QUaModbusClient::on_logRequestsChanged   , Qt::QueuedConnection);
+	// to safely publish scan snapshot in ua server thread
+	QObject::connect(this, &QUaModbusClient::updateScan, this, &QUaModbusClient::on_updateScan);
+	// to safely publish traffic statistics in ua server thread
+	QObject::connect(this, &QUaModbusClient::updateStatistics, this, &QUaModbusClient::on_updateStatistics);
+	m_statsHandle = m_workerThread.startLoopInThread([this]() {
+		this->publishStatistics();
+	}, QUaModbusClient::m_statisticsPeriod);
+	// to safely publish worker event loop latency in ua server thread
+	QObject::connect(this, &QUaModbusClient::updateLoopDiagnostics, this, &QUaModbusClient::on_updateLoopDiagnostics);
+	QObject::connect(this, &QUaModbusClient::probeSucceeded, this, &QUaModbusClient::on_probeSucceeded, Qt::QueuedConnection);
+	m_workerThread.execInThread([this]() {
+		m_workerLag.attach();
+	});
+	m_lagHandle = m_workerThread.startLoopInThread([this]() {
+		if (!m_workerLag.beat())
+		{
+			return;
+		}
+		emit this->updateLoopDiagnostics(m_workerLag.sample());
+	}, QUaModbusLagMonitor::m_beatPeriod);
 }
 
 QUaModbusClient::~QUaModbusClient()
 {
 	emit this->aboutToDestroy();
+	this->stopProbe();
+	this->stopScan();
+	m_workerThread.stopLoopInThread(m_statsHandle);
+	m_workerThread.stopLoopInThread(m_lagHandle);
+	// do not hold or wait for a connection slot anymore
+	auto list = this->list();
+	if (list)
+	{
+		list->cancelConnectSlot(this);
+	}
 	emit m_dataBlocks->aboutToClear();
 	// delete while client still valid, because in views blocks reference parent client
 	for (auto block : m_dataBlocks->blocks())
@@ -66,7 +171,7 @@ QUaModbusClient::~QUaModbusClient()
 
 QUaProperty * QUaModbusClient::type()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_type)
 	{
 		m_type = this->browseChild<QUaProperty>("Type");
@@ -76,7 +181,7 @@ QUaProperty * QUaModbusClient::type()
 
 QUaProperty * QUaModbusClient::serverAddress()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_serverAddress)
 	{
 		m_serverAddress = this->browseChild<QUaProperty>("ServerAddress");
@@ -86,7 +191,7 @@ QUaProperty * QUaModbusClient::serverAddress()
 
 QUaProperty * QUaModbusClient::keepConnecting()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_keepConnecting)
 	{
 		m_keepConnecting = this->browseChild<QUaProperty>("KeepConnecting");
@@ -94,9 +199,29 @@ QUaProperty * QUaModbusClient::keepConnecting()
 	return m_keepConnecting;
 }
 
+QUaProperty * QUaModbusClient::scanCycleTime()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_scanCycleTime)
+	{
+		m_scanCycleTime = this->browseChild<QUaProperty>("ScanCycleTime");
+	}
+	return m_scanCycleTime;
+}
+
+QUaProperty * QUaModbusClient::logRequests()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_logRequests)
+	{
+		m_logRequests = this->browseChild<QUaProperty>("LogRequests");
+	}
+	return m_logRequests;
+}
+
 QUaBaseDataVariable * QUaModbusClient::state()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_state)
 	{
 		m_state = this->browseChild<QUaBaseDataVariable>("State");
@@ -106,7 +231,7 @@ QUaBaseDataVariable * QUaModbusClient::state()
 
 QUaBaseDataVariable * QUaModbusClient::lastError()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_lastError)
 	{
 		m_lastError = this->browseChild<QUaBaseDataVariable>("LastError");
@@ -114,9 +239,79 @@ QUaBaseDataVariable * QUaModbusClient::lastError()
 	return m_lastError;
 }
 
+QUaBaseDataVariable * QUaModbusClient::scanTime()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_scanTime)
+	{
+		m_scanTime = this->browseChild<QUaBaseDataVariable>("ScanTime");
+	}
+	return m_scanTime;
+}
+
+QUaBaseDataVariable * QUaModbusClient::scanOverruns()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_scanOverruns)
+	{
+		m_scanOverruns = this->browseChild<QUaBaseDataVariable>("ScanOverruns");
+	}
+	return m_scanOverruns;
+}
+
+QUaBaseDataVariable * QUaModbusClient::requestRate()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_requestRate)
+	{
+		m_requestRate = this->browseChild<QUaBaseDataVariable>("RequestRate");
+	}
+	return m_requestRate;
+}
+
+QUaBaseDataVariable * QUaModbusClient::byteRate()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_byteRate)
+	{
+		m_byteRate = this->browseChild<QUaBaseDataVariable>("ByteRate");
+	}
+	return m_byteRate;
+}
+
+QUaBaseDataVariable * QUaModbusClient::busUsage()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_busUsage)
+	{
+		m_busUsage = this->browseChild<QUaBaseDataVariable>("BusUsage");
+	}
+	return m_busUsage;
+}
+
+QUaBaseDataVariable * QUaModbusClient::queueDepth()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_queueDepth)
+	{
+		m_queueDepth = this->browseChild<QUaBaseDataVariable>("QueueDepth");
+	}
+	return m_queueDepth;
+}
+
+QUaBaseDataVariable * QUaModbusClient::cpuUsage()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_cpuUsage)
+	{
+		m_cpuUsage = this->browseChild<QUaBaseDataVariable>("CpuUsage");
+	}
+	return m_cpuUsage;
+}
+
 QUaModbusDataBlockList * QUaModbusClient::dataBlocks()
 {
-	QMutexLocker locker(&this->m_mutex);
+	QUA_MODBUS_LOCKER(&this->m_mutex);
 	if (!m_dataBlocks)
 	{
 		m_dataBlocks = this->browseChild<QUaModbusDataBlockList>("DataBlocks");
@@ -124,30 +319,67 @@ QUaModbusDataBlockList * QUaModbusClient::dataBlocks()
 	return m_dataBlocks;
 }
 
+QUaModbusLoopDiagnostics * QUaModbusClient::workerLoop()
+{
+	QUA_MODBUS_LOCKER(&this->m_mutex);
+	if (!m_workerLoop)
+	{
+		m_workerLoop = this->browseChild<QUaModbusLoopDiagnostics>("WorkerLoop");
+	}
+	return m_workerLoop;
+}
+
 void QUaModbusClient::remove()
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->disconnectDevice();
 	this->deleteLater();
 }
 
 void QUaModbusClient::connectDevice()
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	// check if same
 	if (this->getState() == QModbusState::ConnectedState)
 	{
 		return;
 	}
+	// limit concurrent connection attempts gateway-wide
+	// NOTE : if no slot available, list calls this method again when one is released
+	auto list = this->list();
+	if (list && !list->requestConnectSlot(this))
+	{
+		return;
+	}
 	// exec in thread, for thread-safety
 	m_workerThread.execInThread([this]() {
 		m_modbusClient->connectDevice();
 	});
 }
 
+void QUaModbusClient::abortConnect()
+{
+	// exec in thread, for thread-safety
+	// NOTE : not a requested disconnection, so the unconnected state releases
+	//        the connection slot and keep connecting queues a new attempt
+	m_workerThread.execInThread([this]() {
+		if (m_modbusClient->state() != QModbusState::ConnectingState)
+		{
+			return;
+		}
+		m_modbusClient->disconnectDevice();
+	});
+}
+
 void QUaModbusClient::disconnectDevice()
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
+	// stop waiting for connection slot or give it away
+	auto list = this->list();
+	if (list)
+	{
+		list->cancelConnectSlot(this);
+	}
 	// check if same
 	if (this->getState() == QModbusState::UnconnectedState)
 	{
@@ -167,65 +399,163 @@ void QUaModbusClient::disconnectDevice()
 	});
 }
 
+QByteArray QUaModbusClient::exportRequestLog()
+{
+	return this->recordsToPcap(m_requestLog.records());
+}
+
+void QUaModbusClient::clearRequestLog()
+{
+	m_requestLog.clear();
+}
+
 quint8 QUaModbusClient::getServerAddress() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return const_cast<QUaModbusClient*>(this)->serverAddress()->value().value<quint8>();
 }
 
 void QUaModbusClient::setServerAddress(const quint8 & serverAddress)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->serverAddress()->setValue(serverAddress);
 	this->on_serverAddressChanged(serverAddress, true);
 }
 
 bool QUaModbusClient::getKeepConnecting() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return const_cast<QUaModbusClient*>(this)->keepConnecting()->value().toBool();
 }
 
 void QUaModbusClient::setKeepConnecting(const bool & keepConnecting)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->keepConnecting()->setValue(keepConnecting);
 	this->on_keepConnectingChanged(keepConnecting, true);
 }
 
 QModbusError QUaModbusClient::getLastError() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return const_cast<QUaModbusClient*>(this)->lastError()->value().value<QModbusError>();
 }
 
 void QUaModbusClient::setLastError(const QModbusError & error)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->on_errorChanged(error);
 }
 
+quint32 QUaModbusClient::getScanCycleTime() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->scanCycleTime()->value().value<quint32>();
+}
+
+void QUaModbusClient::setScanCycleTime(const quint32 & scanCycleTime)
+{
+	QUA_MODBUS_LOCKER(&m_mutex);
+	this->scanCycleTime()->setValue(scanCycleTime);
+	this->on_scanCycleTimeChanged(scanCycleTime, true);
+}
+
+bool QUaModbusClient::getLogRequests() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->logRequests()->value().toBool();
+}
+
+void QUaModbusClient::setLogRequests(const bool & logRequests)
+{
+	QUA_MODBUS_LOCKER(&m_mutex);
+	this->logRequests()->setValue(logRequests);
+	this->on_logRequestsChanged(logRequests, true);
+}
+
+double QUaModbusClient::getScanTime() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->scanTime()->value().toDouble();
+}
+
+quint32 QUaModbusClient::getScanOverruns() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	return const_cast<QUaModbusClient*>(this)->scanOverruns()->value().value<quint32>();
+}
+
+double QUaModbusClient::getRequestRate() const
+{
+	return const_cast<QUaModbusClient*>(this)->requestRate()->value().toDouble();
+}
+
+double QUaModbusClient::getByteRate() const
+{
+	return const_cast<QUaModbusClient*>(this)->byteRate()->value().toDouble();
+}
+
+double QUaModbusClient::getBusUsage() const
+{
+	return const_cast<QUaModbusClient*>(this)->busUsage()->value().toDouble();
+}
+
+quint32 QUaModbusClient::getQueueDepth() const
+{
+	return const_cast<QUaModbusClient*>(this)->queueDepth()->value().value<quint32>();
+}
+
+double QUaModbusClient::getCpuUsage() const
+{
+	return const_cast<QUaModbusClient*>(this)->cpuUsage()->value().toDouble();
+}
+
 QUaModbusClientList * QUaModbusClient::list() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return qobject_cast<QUaModbusClientList*>(this->parent());
 }
 
+QUaModbusMemoryUsage QUaModbusClient::memoryUsage() const
+{
+	QUaModbusMemoryUsage usage;
+	usage.objects += sizeof(QUaModbusClient) + QUaModbusMemoryUsage::m_workerBytes;
+	// includes diagnostics objects and the data blocks folder
+	usage.addNodes(const_cast<QUaModbusClient*>(this));
+	usage.buffers += m_requestLog.memoryUsage();
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	for (auto &sample : m_scanSnapshot)
+	{
+		usage.buffers += sizeof(QUaModbusScanSample) + static_cast<quint64>(sample.data.capacity()) * sizeof(quint16);
+	}
+	return usage;
+}
+
+bool QUaModbusClient::isQuarantined() const
+{
+	return m_quarantined;
+}
+
+bool QUaModbusClient::isPollingSuspended() const
+{
+	return m_quarantined || this->getState() != QModbusState::ConnectedState;
+}
+
 QModbusClientType QUaModbusClient::getType() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return const_cast<QUaModbusClient*>(this)->type()->value().value<QModbusClientType>();
 }
 
 QModbusState QUaModbusClient::getState() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusClient*>(this)->m_mutex));
 	return const_cast<QUaModbusClient*>(this)->state()->value().value<QModbusState>();
 }
 
 void QUaModbusClient::setState(const QModbusState & state)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->state()->setValue(state);
 	// NOTE : need to add custom signal because OPC UA valueChanged
 	//        only works for changes through network
@@ -240,6 +570,13 @@ void QUaModbusClient::resetModbusClient()
 	QObject::connect(m_modbusClient.data(), &QModbusClient::errorOccurred, this, &QUaModbusClient::on_errorChanged, Qt::QueuedConnection);
 }
 
+bool QUaModbusClient::failover(const quint32 & consecutiveTimeouts)
+{
+	// no redundant endpoints by default
+	Q_UNUSED(consecutiveTimeouts);
+	return false;
+}
+
 QDomElement QUaModbusClient::toDomElement(QDomDocument & domDoc) const
 {
 	// must never reach here
@@ -256,6 +593,57 @@ void QUaModbusClient::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& erro
 	Q_UNUSED(errorLogs);
 }
 
+void QUaModbusClient::toDomElementCommon(QDomElement & elemClient) const
+{
+	elemClient.setAttribute("ScanCycleTime", getScanCycleTime());
+	elemClient.setAttribute("LogRequests", getLogRequests());
+}
+
+void QUaModbusClient::fromDomElementCommon(QDomElement & domElem, QQueue<QUaLog>& errorLogs)
+{
+	QString strBrowseName = domElem.attribute("BrowseName", "");
+	bool bOK;
+	// ScanCycleTime (optional)
+	if (domElem.hasAttribute("ScanCycleTime"))
+	{
+		auto scanCycleTime = domElem.attribute("ScanCycleTime").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setScanCycleTime(scanCycleTime);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid ScanCycleTime attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("ScanCycleTime")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// LogRequests (optional)
+	if (domElem.hasAttribute("LogRequests"))
+	{
+		auto logRequests = (bool)domElem.attribute("LogRequests").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setLogRequests(logRequests);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid LogRequests attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("LogRequests")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+}
+
+QByteArray QUaModbusClient::recordsToPcap(const QVector<QUaModbusLogRecord>& frames) const
+{
+	return QUaModbusRequestLog::toPcapRtu(frames);
+}
+
 void QUaModbusClient::on_serverAddressChanged(const QVariant & value, const bool& networkChange)
 {
 
@@ -278,16 +666,116 @@ void QUaModbusClient::on_keepConnectingChanged(const QVariant & value, const boo
 	emit this->keepConnectingChanged(value.toBool());
 }
 
+void QUaModbusClient::on_scanCycleTimeChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto scanCycleTime = value.value<quint32>();
+	// set in thread for safety
+	m_workerThread.execInThread([this, scanCycleTime]() {
+		m_scanPeriod = scanCycleTime;
+	});
+	// restart scan with new period
+	this->stopScan();
+	if (!this->isPollingSuspended())
+	{
+		this->startScan();
+	}
+	// emit
+	emit this->scanCycleTimeChanged(scanCycleTime);
+}
+
+void QUaModbusClient::on_logRequestsChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto logRequests = value.toBool();
+	// NOTE : ring allocated here so worker thread never allocates while recording
+	m_requestLog.setEnabled(logRequests);
+	m_workerThread.execInThread([this, logRequests]() {
+		m_requestLogEnabled = logRequests;
+	});
+	// emit
+	emit this->logRequestsChanged(logRequests);
+}
+
+void QUaModbusClient::on_updateStatistics(const double & requestRate, const double & byteRate, const double & busUsage, const quint32 & queueDepth, const double & cpuUsage)
+{
+	this->requestRate()->setValue(requestRate);
+	this->byteRate()   ->setValue(byteRate);
+	this->busUsage()   ->setValue(busUsage);
+	this->queueDepth() ->setValue(queueDepth);
+	this->cpuUsage()   ->setValue(cpuUsage);
+	// emit
+	emit this->statisticsChanged();
+}
+
+void QUaModbusClient::on_updateLoopDiagnostics(const QUaModbusLoopSample & sample)
+{
+	this->workerLoop()->setSample(sample);
+}
+
+void QUaModbusClient::on_updateScan(const QDateTime & timestamp, const double & scanTime, const quint32 & scanOverruns)
+{
+	QUaModbusTaskScope taskScope("QUaModbusClient::on_updateScan");
+	QList<QUaModbusScanSample> snapshot;
+	{
+		QUA_MODBUS_LOCKER(&m_mutex);
+		snapshot.swap(m_scanSnapshot);
+	}
+	if (m_disconnectRequested || this->getState() != QModbusState::ConnectedState)
+	{
+		return;
+	}
+	// publish all blocks within the same event so ua clients see a consistent snapshot
+	for (auto sample : snapshot)
+	{
+		if (!sample.block)
+		{
+			continue;
+		}
+		sample.block->publishData(sample.data, sample.error, timestamp);
+	}
+	this->scanTime()->setValue(scanTime);
+	if (this->getScanOverruns() != scanOverruns)
+	{
+		this->scanOverruns()->setValue(scanOverruns);
+	}
+	// emit
+	emit this->scanCompleted(timestamp, scanTime);
+}
+
 void QUaModbusClient::on_stateChanged(QModbusState state)
 {
+	auto lastState = this->getState();
 	this->setState(state);
+	// connection attempt finished, give slot to next waiting client
+	if (state == QModbusState::ConnectedState || state == QModbusState::UnconnectedState)
+	{
+		auto list = this->list();
+		if (list)
+		{
+			list->releaseConnectSlot(this);
+		}
+	}
 	// no error if connected correctly
 	if (state == QModbusState::ConnectedState)
 	{
 		this->setLastError(QModbusError::NoError);
+		QUaModbusMetrics::addConnect();
 	}
 	// make copy before modify because used in othe rplaces
 	bool disconnectRequested = m_disconnectRequested;
+	// count connections lost, not failed retries or requested disconnections
+	if (lastState == QModbusState::ConnectedState && !disconnectRequested &&
+		(state == QModbusState::ClosingState || state == QModbusState::UnconnectedState))
+	{
+		QUaModbusMetrics::addReconnect();
+	}
 	// only allow to write connection params if not connected
 	if (state == QModbusState::UnconnectedState)
 	{
@@ -304,6 +792,17 @@ void QUaModbusClient::on_stateChanged(QModbusState state)
 	{
 		serverAddress()->setWriteAccess(false);
 	}
+	// idle block loops while not connected, the reconnection acts as probe
+	if (state == QModbusState::ConnectedState)
+	{
+		m_consecutiveTimeouts = 0;
+		this->resumeBlocks();
+	}
+	else if (state == QModbusState::UnconnectedState)
+	{
+		this->setQuarantined(false);
+		this->suspendBlocks(this->getLastError());
+	}
 	// update block errors
 	if (
 		state == QModbusState::ConnectedState  || 
@@ -337,4 +836,481 @@ void QUaModbusClient::on_errorChanged(QModbusError error)
 	//// TODO : send UA event
 	// emit
 	emit this->lastErrorChanged(error);
-}
\ No newline at end of file
+}
+
+void QUaModbusClient::reportReadResult(const QModbusError & error)
+{
+	// NOTE : exec'd in ua server thread (not in worker thread)
+	if (error != QModbusError::TimeoutError)
+	{
+		m_consecutiveTimeouts = 0;
+		return;
+	}
+	m_consecutiveTimeouts++;
+	// try redundant endpoints first, only quarantine when none left to try
+	if (!m_quarantined && this->failover(m_consecutiveTimeouts))
+	{
+		return;
+	}
+	if (m_quarantined || m_consecutiveTimeouts < QUaModbusClient::m_quarantineTimeouts)
+	{
+		return;
+	}
+	this->setQuarantined(true);
+}
+
+void QUaModbusClient::setQuarantined(const bool & quarantined)
+{
+	if (m_quarantined == quarantined)
+	{
+		return;
+	}
+	m_quarantined = quarantined;
+	m_consecutiveTimeouts = 0;
+	if (m_quarantined)
+	{
+		// idle all blocks and let a single probe find out when device is back
+		this->suspendBlocks(QModbusError::TimeoutError);
+		this->startProbe();
+	}
+	else
+	{
+		this->stopProbe();
+		// NOTE : only resumes if still connected
+		this->resumeBlocks();
+	}
+	// emit
+	emit this->quarantinedChanged(m_quarantined);
+}
+
+void QUaModbusClient::updateProbeTarget()
+{
+	// NOTE : only needed while quarantined, startProbe calls it again
+	if (!m_quarantined)
+	{
+		return;
+	}
+	// probe a single register of the first well configured block
+	// NOTE : broadcast blocks are never answered
+	bool valid = false;
+	QModbusDataUnit::RegisterType type = QModbusDataUnit::Invalid;
+	int address = 0;
+	auto blocks = this->dataBlocks()->blocks();
+	for (auto block : blocks)
+	{
+		if (block->getType() == QModbusDataBlockType::Invalid ||
+			block->getAddress() < 0 ||
+			block->getSize() == 0 ||
+			block->getBroadcast())
+		{
+			continue;
+		}
+		valid   = true;
+		type    = static_cast<QModbusDataUnit::RegisterType>(block->getType());
+		address = block->getAddress();
+		break;
+	}
+	// set in thread for safety
+	m_workerThread.execInThread([this, valid, type, address]() {
+		m_probeValid   = valid;
+		m_probeType    = type;
+		m_probeAddress = address;
+	});
+}
+
+void QUaModbusClient::startProbe()
+{
+	this->stopProbe();
+	this->updateProbeTarget();
+	m_probeHandle = m_workerThread.startLoopInThread(
+	[this]() {
+		// check if ongoing probe
+		if (m_replyProbe)
+		{
+			return;
+		}
+		if (!m_probeValid || this->getState() != QModbusState::ConnectedState)
+		{
+			return;
+		}
+		m_replyProbe = this->sendReadRequest(
+			QModbusDataUnit(m_probeType, m_probeAddress, 1)
+			, this->getServerAddress()
+		);
+		if (!m_replyProbe)
+		{
+			return;
+		}
+		if (m_replyProbe->isFinished())
+		{
+			m_replyProbe->deleteLater();
+			m_replyProbe = nullptr;
+			return;
+		}
+		auto reply = m_replyProbe;
+		QObject::connect(reply, &QModbusReply::finished, reply,
+		[this, reply]() {
+			// NOTE : exec'd in worker thread (reply lives in it)
+			if (m_replyProbe == reply)
+			{
+				m_replyProbe = nullptr;
+			}
+			auto error = reply->error();
+			reply->deleteLater();
+			// an exception response also means the device is alive
+			if (error != QModbusError::NoError && error != QModbusError::ProtocolError)
+			{
+				return;
+			}
+			emit this->probeSucceeded();
+		});
+	}, QUaModbusClient::m_probePeriod);
+}
+
+void QUaModbusClient::on_probeSucceeded()
+{
+	// NOTE : a late reply might arrive after quarantine ended by other means
+	if (!m_quarantined)
+	{
+		return;
+	}
+	this->setQuarantined(false);
+}
+
+void QUaModbusClient::stopProbe()
+{
+	if (m_probeHandle > 0)
+	{
+		m_workerThread.stopLoopInThread(m_probeHandle);
+	}
+	// make handle invalid **after** stopping loop in thread
+	m_probeHandle = -1;
+}
+
+void QUaModbusClient::updateScanGroup()
+{
+	// well configured blocks in scan group, broadcast blocks are never answered
+	QList<QPointer<QUaModbusDataBlock>> scanGroup;
+	auto blocks = this->dataBlocks()->blocks();
+	for (auto block : blocks)
+	{
+		if (!block->getScanGroup() ||
+			block->getBroadcast() ||
+			block->getType() == QModbusDataBlockType::Invalid ||
+			block->getAddress() < 0 ||
+			block->getSize() == 0)
+		{
+			continue;
+		}
+		scanGroup << block;
+	}
+	// set in thread for safety
+	m_workerThread.execInThread([this, scanGroup]() {
+		m_scanGroup = scanGroup;
+	});
+}
+
+void QUaModbusClient::startScan()
+{
+	auto scanCycleTime = this->getScanCycleTime();
+	if (m_scanHandle > 0 || scanCycleTime == 0)
+	{
+		return;
+	}
+	m_scanHandle = m_workerThread.startLoopInThread(
+	[this]() {
+		if (m_scanHandle <= 0)
+		{
+			return;
+		}
+		// previous scan did not finish within the cycle
+		if (m_scanning)
+		{
+			m_scanOverrunCount++;
+			return;
+		}
+		if (this->getState() != QModbusState::ConnectedState)
+		{
+			return;
+		}
+		// NOTE : scan group is built in ua server thread, only read own copy here
+		m_scanBlocks.clear();
+		for (auto block : m_scanGroup)
+		{
+			if (!block)
+			{
+				continue;
+			}
+			m_scanBlocks << block;
+		}
+		if (m_scanBlocks.isEmpty())
+		{
+			return;
+		}
+		// all blocks in the scan share the timestamp of its start
+		m_scanning = true;
+		m_scanNext.clear();
+		m_scanTimestamp = QDateTime::currentDateTimeUtc();
+		m_scanTimer.start();
+		this->scanNext();
+	}, scanCycleTime);
+}
+
+void QUaModbusClient::stopScan()
+{
+	if (m_scanHandle > 0)
+	{
+		m_workerThread.stopLoopInThread(m_scanHandle);
+	}
+	// make handle invalid **after** stopping loop in thread
+	// NOTE : ongoing scan is discarded on its next reply
+	m_scanHandle = -1;
+}
+
+void QUaModbusClient::scanNext()
+{
+	// NOTE : exec'd in worker thread
+	QUaModbusTaskScope taskScope("QUaModbusClient::scanNext");
+	if (!m_scanning)
+	{
+		return;
+	}
+	// check if scan was stopped meanwhile
+	if (m_scanHandle <= 0)
+	{
+		m_scanning = false;
+		return;
+	}
+	// check if done
+	if (m_scanNext.count() >= m_scanBlocks.count())
+	{
+		double scanTime = m_scanTimer.nsecsElapsed() / 1000000.0;
+		{
+			QUA_MODBUS_LOCKER(&m_mutex);
+			m_scanSnapshot = m_scanNext;
+		}
+		m_scanNext.clear();
+		m_scanning = false;
+		emit this->updateScan(m_scanTimestamp, scanTime, m_scanOverrunCount);
+		return;
+	}
+	// abort scan if connection lost
+	if (this->getState() != QModbusState::ConnectedState)
+	{
+		m_scanning = false;
+		return;
+	}
+	auto block = m_scanBlocks.at(m_scanNext.count());
+	if (!block)
+	{
+		m_scanNext << QUaModbusScanSample({ block, QVector<quint16>(), QModbusError::ReplyAbortedError });
+		this->scanNext();
+		return;
+	}
+	block->accountPoll();
+	QElapsedTimer sent;
+	sent.start();
+	auto reply = this->sendReadRequest(
+		QModbusDataUnit(
+			static_cast<QModbusDataUnit::RegisterType>(block->m_registerType),
+			block->m_startAddress,
+			block->m_valueCount
+		)
+		, this->getServerAddress()
+	);
+	if (!reply || reply->isFinished())
+	{
+		if (reply)
+		{
+			reply->deleteLater();
+		}
+		m_scanNext << QUaModbusScanSample({ block, QVector<quint16>(), QModbusError::ReplyAbortedError });
+		this->scanNext();
+		return;
+	}
+	// NOTE : reply as context so it is handled in worker thread, next request goes out right away
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[this, reply, block, sent]() {
+		reply->deleteLater();
+		if (block)
+		{
+			block->accountReply(reply, sent.nsecsElapsed());
+		}
+		if (m_scanning)
+		{
+			m_scanNext << QUaModbusScanSample({ block, reply->result().values(), reply->error() });
+		}
+		this->scanNext();
+	});
+}
+
+QModbusReply * QUaModbusClient::sendReadRequest(const QModbusDataUnit & read, const int & serverAddress)
+{
+	QModbusReply * reply = m_modbusClient->sendReadRequest(read, serverAddress);
+	this->accountRequest(reply, read, false, serverAddress);
+	return reply;
+}
+
+QModbusReply * QUaModbusClient::sendWriteRequest(const QModbusDataUnit & write, const int & serverAddress)
+{
+	QModbusReply * reply = m_modbusClient->sendWriteRequest(write, serverAddress);
+	this->accountRequest(reply, write, true, serverAddress);
+	return reply;
+}
+
+void QUaModbusClient::accountRequest(QModbusReply * reply, const QModbusDataUnit & unit, const bool & isWrite, const int & serverAddress)
+{
+	if (!reply)
+	{
+		return;
+	}
+	// estimate pdu sizes from the request, bits are packed in bytes
+	bool isBits = unit.registerType() == QModbusDataUnit::Coils ||
+		          unit.registerType() == QModbusDataUnit::DiscreteInputs;
+	int  count  = static_cast<int>(unit.valueCount());
+	int  data   = isBits ? (count + 7) / 8 : 2 * count;
+	int  reqPdu = isWrite ? (count == 1 ? 5 : 6 + data) : 5;
+	int  resPdu = isWrite ? 5 : 2 + data;
+	int  frame  = this->frameOverhead();
+	m_statRequests++;
+	m_statBytes   += reqPdu + frame;
+	quint16 logId = m_requestLogEnabled ? m_requestLog.addRequest(unit, isWrite, static_cast<quint8>(serverAddress)) : 0;
+	QUaModbusMetrics::addRequest(isWrite, serverAddress != 0);
+	// broadcast requests are not replied, rtu still waits the turnaround delay
+	if (serverAddress == 0)
+	{
+		m_statBusTime += (reqPdu + frame + 3.5) * this->charTime();
+		return;
+	}
+	m_statPending++;
+	QElapsedTimer sent;
+	sent.start();
+	auto account = [this, reqPdu, resPdu, frame, reply, sent, logId, serverAddress]() {
+		m_statPending = m_statPending > 0 ? m_statPending - 1 : 0;
+		if (logId != 0)
+		{
+			m_requestLog.addResponse(reply->rawResult(), logId, static_cast<quint8>(serverAddress));
+		}
+		QUaModbusMetrics::addReply(reply->error(), sent.nsecsElapsed());
+		int res = 0;
+		switch (reply->error())
+		{
+		case QModbusDevice::NoError:
+			res = resPdu + frame;
+			break;
+		case QModbusDevice::ProtocolError:
+			res = 2 + frame;
+			break;
+		default:
+			break;
+		}
+		m_statBytes   += res;
+		m_statBusTime += (reqPdu + frame + 3.5) * this->charTime();
+		m_statBusTime += res > 0 ? (res + 3.5) * this->charTime() : 0.0;
+	};
+	if (reply->isFinished())
+	{
+		account();
+		return;
+	}
+	// NOTE : reply as context, so lambda runs in thread
+	QObject::connect(reply, &QModbusReply::finished, reply, account);
+}
+
+int QUaModbusClient::frameOverhead() const
+{
+	// rtu adds address and crc, tcp adds mbap header
+	return qobject_cast<QModbusRtuSerialMaster*>(m_modbusClient.data()) ? 3 : 7;
+}
+
+double QUaModbusClient::charTime() const
+{
+	// only serial bus time is meaningful
+	if (!qobject_cast<QModbusRtuSerialMaster*>(m_modbusClient.data()))
+	{
+		return 0.0;
+	}
+	double baudRate = m_modbusClient->connectionParameter(QModbusDevice::SerialBaudRateParameter).toDouble();
+	if (baudRate <= 0.0)
+	{
+		return 0.0;
+	}
+	double dataBits = m_modbusClient->connectionParameter(QModbusDevice::SerialDataBitsParameter).toDouble();
+	auto   parity   = m_modbusClient->connectionParameter(QModbusDevice::SerialParityParameter).value<QSerialPort::Parity>();
+	auto   stopBits = m_modbusClient->connectionParameter(QModbusDevice::SerialStopBitsParameter).value<QSerialPort::StopBits>();
+	double bits = 1.0 + dataBits;
+	bits += parity == QSerialPort::NoParity ? 0.0 : 1.0;
+	bits += stopBits == QSerialPort::OneAndHalfStop ? 1.5 : static_cast<double>(stopBits);
+	return bits / baudRate;
+}
+
+void QUaModbusClient::publishStatistics()
+{
+	qint64 cpuTime = QUaModbusClient::threadCpuTime();
+	if (!m_statTimer.isValid())
+	{
+		m_statTimer.start();
+		m_statCpuTime = cpuTime;
+		return;
+	}
+	double elapsed = static_cast<double>(m_statTimer.restart()) / 1000.0;
+	if (elapsed <= 0.0)
+	{
+		return;
+	}
+	double requestRate = static_cast<double>(m_statRequests) / elapsed;
+	double byteRate    = static_cast<double>(m_statBytes) / elapsed;
+	double busUsage    = qMin(100.0, 100.0 * m_statBusTime / elapsed);
+	double cpuUsage    = cpuTime < 0 ? 0.0 : 100.0 * static_cast<double>(cpuTime - m_statCpuTime) / (elapsed * 1e9);
+	m_statRequests = 0;
+	m_statBytes    = 0;
+	m_statBusTime  = 0.0;
+	m_statCpuTime  = cpuTime;
+	emit this->updateStatistics(requestRate, byteRate, busUsage, m_statPending, cpuUsage);
+}
+
+qint64 QUaModbusClient::threadCpuTime()
+{
+	// nanoseconds of cpu time used by calling thread, -1 if not available
+#ifdef Q_OS_WIN
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+	{
+		return -1;
+	}
+	quint64 k = (static_cast<quint64>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+	quint64 u = (static_cast<quint64>(user.dwHighDateTime)   << 32) | user.dwLowDateTime;
+	return static_cast<qint64>((k + u) * 100);
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+	{
+		return -1;
+	}
+	return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#endif // Q_OS_WIN
+}
+
+void QUaModbusClient::suspendBlocks(const QModbusError & error)
+{
+	this->stopScan();
+	auto blocks = this->dataBlocks()->blocks();
+	for (auto block : blocks)
+	{
+		block->suspendLoop(error);
+	}
+}
+
+void QUaModbusClient::resumeBlocks()
+{
+	if (this->isPollingSuspended())
+	{
+		return;
+	}
+	auto blocks = this->dataBlocks()->blocks();
+	for (auto block : blocks)
+	{
+		block->resumeLoop();
+	}
+	this->startScan();
+}
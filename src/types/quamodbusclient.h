@@ -6,7 +6,11 @@
 #include <QModbusRtuSerialMaster>
 #include <QSerialPort>
 #include <QMutex>
+#include <QAtomicInteger>
 #include <QSharedPointer>
+#include <QPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
 
 #include <QLambdaThreadWorker>
 
@@ -23,6 +27,10 @@
 #include <QDomElement>
 
 #include "quamodbusdatablocklist.h"
+#include "quamodbusrequestlog.h"
+#include "quamodbusloopdiagnostics.h"
+#include "quamodbuslockprofiler.h"
+#include "quamodbusmemoryusage.h"
 
 class QUaModbusClientList;
 class QUaModbusDataBlock;
@@ -47,13 +55,23 @@ class QUaModbusClient : public QUaBaseObjectProtected
 	Q_PROPERTY(QUaProperty * Type           READ type          )
 	Q_PROPERTY(QUaProperty * ServerAddress  READ serverAddress )
 	Q_PROPERTY(QUaProperty * KeepConnecting READ keepConnecting)
+	Q_PROPERTY(QUaProperty * ScanCycleTime  READ scanCycleTime )
+	Q_PROPERTY(QUaProperty * LogRequests    READ logRequests   )
 
 	// UA variables
-	Q_PROPERTY(QUaBaseDataVariable * State     READ state    )
-	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
+	Q_PROPERTY(QUaBaseDataVariable * State        READ state       )
+	Q_PROPERTY(QUaBaseDataVariable * LastError    READ lastError   )
+	Q_PROPERTY(QUaBaseDataVariable * ScanTime     READ scanTime    )
+	Q_PROPERTY(QUaBaseDataVariable * ScanOverruns READ scanOverruns)
+	Q_PROPERTY(QUaBaseDataVariable * RequestRate  READ requestRate )
+	Q_PROPERTY(QUaBaseDataVariable * ByteRate     READ byteRate    )
+	Q_PROPERTY(QUaBaseDataVariable * BusUsage     READ busUsage    )
+	Q_PROPERTY(QUaBaseDataVariable * QueueDepth   READ queueDepth  )
+	Q_PROPERTY(QUaBaseDataVariable * CpuUsage     READ cpuUsage    )
 
 	// UA objects
-	Q_PROPERTY(QUaModbusDataBlockList * DataBlocks READ dataBlocks)
+	Q_PROPERTY(QUaModbusDataBlockList   * DataBlocks READ dataBlocks)
+	Q_PROPERTY(QUaModbusLoopDiagnostics * WorkerLoop READ workerLoop)
 
 public:
 	Q_INVOKABLE explicit QUaModbusClient(QUaServer *server);
@@ -72,21 +90,34 @@ public:
 	QUaProperty * type();
 	QUaProperty * serverAddress();
 	QUaProperty * keepConnecting();
+	QUaProperty * scanCycleTime();
+	QUaProperty * logRequests();
 
 	// UA variables
 
 	QUaBaseDataVariable * state();
 	QUaBaseDataVariable * lastError();
+	QUaBaseDataVariable * scanTime();
+	QUaBaseDataVariable * scanOverruns();
+	QUaBaseDataVariable * requestRate();
+	QUaBaseDataVariable * byteRate();
+	QUaBaseDataVariable * busUsage();
+	QUaBaseDataVariable * queueDepth();
+	QUaBaseDataVariable * cpuUsage();
 
 	// UA objects
 
-	QUaModbusDataBlockList * dataBlocks();
+	QUaModbusDataBlockList   * dataBlocks();
+	QUaModbusLoopDiagnostics * workerLoop();
 
 	// UA methods
 
 	Q_INVOKABLE void remove();
 	Q_INVOKABLE void connectDevice();
 	Q_INVOKABLE void disconnectDevice();
+	// logged requests and responses as pcap file contents
+	Q_INVOKABLE QByteArray exportRequestLog();
+	Q_INVOKABLE void clearRequestLog();
 
 	// C++ API
 
@@ -104,8 +135,38 @@ public:
 	QModbusError getLastError() const;
 	void         setLastError(const QModbusError &error);
 
+	// period to read all ScanGroup blocks back-to-back as one snapshot, 0 = disabled
+	quint32 getScanCycleTime() const;
+	void    setScanCycleTime(const quint32 &scanCycleTime);
+
+	// log requests/responses, rebuilt from data units, in a preallocated ring buffer
+	bool   getLogRequests() const;
+	void   setLogRequests(const bool &logRequests);
+
+	// duration in ms of last scan and number of missed scan cycles
+	double  getScanTime() const;
+	quint32 getScanOverruns() const;
+
+	// traffic over last statistics period, requests/s and bytes/s (ADU, both directions)
+	double  getRequestRate() const;
+	double  getByteRate() const;
+	// percent of serial bus time used by frames and silent intervals (0 for TCP)
+	double  getBusUsage() const;
+	// requests sent and not yet replied
+	quint32 getQueueDepth() const;
+	// percent of one core used by the worker thread
+	double  getCpuUsage() const;
+
 	QUaModbusClientList * list() const;
 
+	// approximate memory owned by this client, excluding its blocks (call in ua server thread)
+	QUaModbusMemoryUsage memoryUsage() const;
+
+	// quarantined after consecutive timeouts, blocks idle until probe succeeds
+	bool isQuarantined() const;
+	// whether block loops are idle (not connected or quarantined)
+	bool isPollingSuspended() const;
+
     // Fix for GCC : cannot be protected or "virtual is protected within this context" error
     virtual void resetModbusClient();
 
@@ -115,32 +176,146 @@ signals:
 	void keepConnectingChanged(const bool   &keepConnecting);
 	void stateChanged    (const QModbusState &state);
 	void lastErrorChanged(const QModbusError &error);
+	void quarantinedChanged(const bool &quarantined);
+	void scanCycleTimeChanged(const quint32 &scanCycleTime);
+	void logRequestsChanged(const bool &logRequests);
+	void scanCompleted(const QDateTime &timestamp, const double &scanTime);
+	void statisticsChanged();
 	void aboutToDestroy();
 
+	// (internal) to safely publish scan snapshot in ua server thread
+	void updateScan(const QDateTime &timestamp, const double &scanTime, const quint32 &scanOverruns);
+	// (internal) to safely publish traffic statistics in ua server thread
+	void updateStatistics(const double &requestRate, const double &byteRate, const double &busUsage, const quint32 &queueDepth, const double &cpuUsage);
+	// (internal) to safely publish worker event loop latency in ua server thread
+	void updateLoopDiagnostics(const QUaModbusLoopSample &sample);
+	// (internal) to safely leave quarantine in ua server thread
+	void probeSucceeded();
+
 protected:
 	QMutex m_mutex;
+	// NOTE : set in worker thread, read and cleared in ua server thread
+	QAtomicInteger<bool> m_disconnectRequested;
+	// NOTE : declared before worker so it outlives the worker thread (task scopes reference it)
+	QUaModbusLagMonitor           m_workerLag;
 	QLambdaThreadWorker           m_workerThread;
 	QSharedPointer<QModbusClient> m_modbusClient;
 
+	// switch to a redundant endpoint after consecutive timeouts, returns true
+	// if still trying endpoints (device must not be quarantined yet)
+	virtual bool failover(const quint32 &consecutiveTimeouts);
+
 	// XML import / export
 	// NOTE : cannot be pure virtual, else moc fails
 	virtual QDomElement toDomElement  (QDomDocument & domDoc) const;
 	virtual void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
+	// attributes common to all client types
+	void toDomElementCommon  (QDomElement & elemClient) const;
+	void fromDomElementCommon(QDomElement & domElem, QQueue<QUaLog>& errorLogs);
+	// encapsulate logged records, rtu by default
+	virtual QByteArray recordsToPcap(const QVector<QUaModbusLogRecord> &frames) const;
 
 private slots:
 	void on_serverAddressChanged (const QVariant & value, const bool& networkChange);
 	void on_keepConnectingChanged(const QVariant & value, const bool& networkChange);
+	void on_scanCycleTimeChanged (const QVariant & value, const bool& networkChange);
+	void on_logRequestsChanged   (const QVariant & value, const bool& networkChange);
+	void on_updateScan(const QDateTime &timestamp, const double &scanTime, const quint32 &scanOverruns);
+	void on_updateStatistics(const double &requestRate, const double &byteRate, const double &busUsage, const quint32 &queueDepth, const double &cpuUsage);
+	void on_updateLoopDiagnostics(const QUaModbusLoopSample &sample);
+	void on_probeSucceeded();
 	void on_stateChanged(QModbusState state);
 	void on_errorChanged(QModbusError error);
 
 private:
-	bool m_disconnectRequested;
+	// abort a connection attempt that takes too long, keep connecting still retries
+	void abortConnect();
+
+	// liveness probe (only access in ua server thread)
+	bool m_quarantined;
+	quint32 m_consecutiveTimeouts;
+	int m_probeHandle;
+	// NOTE : only modify and access in thread
+	QModbusReply * m_replyProbe;
+	bool m_probeValid;
+	QModbusDataUnit::RegisterType m_probeType;
+	int m_probeAddress;
+	void reportReadResult(const QModbusError &error);
+	void setQuarantined(const bool &quarantined);
+	void updateProbeTarget();
+	void startProbe();
+	void stopProbe();
+	void suspendBlocks(const QModbusError &error);
+	void resumeBlocks();
+	static quint32 m_quarantineTimeouts;
+	static quint32 m_probePeriod;
+
+	// consistent scan cycle
+	struct QUaModbusScanSample
+	{
+		QPointer<QUaModbusDataBlock> block;
+		QVector<quint16>             data;
+		QModbusError                 error;
+	};
+	int m_scanHandle;
+	// NOTE : only modify and access in thread
+	quint32 m_scanPeriod;
+	bool    m_scanning;
+	quint32 m_scanOverrunCount;
+	QDateTime     m_scanTimestamp;
+	QElapsedTimer m_scanTimer;
+	QList<QPointer<QUaModbusDataBlock>> m_scanGroup;
+	QList<QPointer<QUaModbusDataBlock>> m_scanBlocks;
+	QList<QUaModbusScanSample>          m_scanNext;
+	// NOTE : filled in thread, taken in ua server thread (protected by m_mutex)
+	QList<QUaModbusScanSample>          m_scanSnapshot;
+	void updateScanGroup();
+	void startScan();
+	void stopScan();
+	void scanNext();
+
+	// traffic statistics, all requests go through these (only call in thread)
+	QModbusReply * sendReadRequest (const QModbusDataUnit &read , const int &serverAddress);
+	QModbusReply * sendWriteRequest(const QModbusDataUnit &write, const int &serverAddress);
+	void accountRequest(QModbusReply * reply, const QModbusDataUnit &unit, const bool &isWrite, const int &serverAddress);
+	int    frameOverhead() const;
+	double charTime() const;
+	void   publishStatistics();
+	int     m_statsHandle;
+	// NOTE : only modify and access in thread
+	quint32 m_statRequests;
+	quint64 m_statBytes;
+	double  m_statBusTime;
+	quint32 m_statPending;
+	qint64  m_statCpuTime;
+	QElapsedTimer m_statTimer;
+	static quint32 m_statisticsPeriod;
+	static qint64  threadCpuTime();
+
+	// worker event loop latency
+	int m_lagHandle;
+
+	// request/response log, ring is thread safe
+	QUaModbusRequestLog m_requestLog;
+	// NOTE : only modify and access in thread
+	bool m_requestLogEnabled;
+
 	QUaProperty* m_type;
 	QUaProperty* m_serverAddress;
 	QUaProperty* m_keepConnecting;
+	QUaProperty* m_scanCycleTime;
+	QUaProperty* m_logRequests;
 	QUaBaseDataVariable* m_state;
 	QUaBaseDataVariable* m_lastError;
+	QUaBaseDataVariable* m_scanTime;
+	QUaBaseDataVariable* m_scanOverruns;
+	QUaBaseDataVariable* m_requestRate;
+	QUaBaseDataVariable* m_byteRate;
+	QUaBaseDataVariable* m_busUsage;
+	QUaBaseDataVariable* m_queueDepth;
+	QUaBaseDataVariable* m_cpuUsage;
 	QUaModbusDataBlockList* m_dataBlocks;
+	QUaModbusLoopDiagnostics* m_workerLoop;
 };
 
 typedef QUaModbusClient::ClientType QModbusClientType;
@@ -11,8 +11,17 @@ HEADERS += \
 	$$PWD/quamodbusrtuserialclient.h \
 	$$PWD/quamodbusdatablocklist.h \
 	$$PWD/quamodbusdatablock.h \
+	$$PWD/quamodbusdatablockdiagnostics.h \
 	$$PWD/quamodbusvaluelist.h \
-	$$PWD/quamodbusvalue.h
+	$$PWD/quamodbusvalue.h \
+	$$PWD/quamodbusmetrics.h \
+	$$PWD/quamodbustracer.h \
+	$$PWD/quamodbusrequestlog.h \
+	$$PWD/quamodbusloopdiagnostics.h \
+	$$PWD/quamodbuslockprofiler.h \
+	$$PWD/quamodbusmemoryusage.h \
+	$$PWD/quamodbusbusload.h \
+	$$PWD/quamodbuspartition.h
 
 SOURCES += \
 	$$PWD/quamodbusclientlist.cpp \
@@ -21,5 +30,14 @@ SOURCES += \
 	$$PWD/quamodbusrtuserialclient.cpp \
 	$$PWD/quamodbusdatablocklist.cpp \
 	$$PWD/quamodbusdatablock.cpp \
+	$$PWD/quamodbusdatablockdiagnostics.cpp \
 	$$PWD/quamodbusvaluelist.cpp \
-	$$PWD/quamodbusvalue.cpp
+	$$PWD/quamodbusvalue.cpp \
+	$$PWD/quamodbusmetrics.cpp \
+	$$PWD/quamodbustracer.cpp \
+	$$PWD/quamodbusrequestlog.cpp \
+	$$PWD/quamodbusloopdiagnostics.cpp \
+	$$PWD/quamodbuslockprofiler.cpp \
+	$$PWD/quamodbusmemoryusage.cpp \
+	$$PWD/quamodbusbusload.cpp \
+	$$PWD/quamodbuspartition.cpp
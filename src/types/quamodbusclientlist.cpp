@@ -5,17 +5,26 @@
 
 #include "quamodbusdatablocklist.h"
 #include "quamodbusdatablock.h"
+#include "quamodbusdatablockdiagnostics.h"
 
 #include "quamodbusvaluelist.h"
 #include "quamodbusvalue.h"
+#include "quamodbuslockprofiler.h"
+#include "quamodbustracer.h"
+#include "quamodbusbusload.h"
 
 #include <QUaServer>
 
+#include <QTimer>
+
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #include <QUaPermissionsList>
 #endif // QUA_ACCESS_CONTROL
 
+quint32 QUaModbusClientList::m_defaultMaxConcurrentConnections = 8;
+quint32 QUaModbusClientList::m_connectTimeout                  = 10000;
+
 QUaModbusClientList::QUaModbusClientList(QUaServer *server)
 #ifndef QUA_ACCESS_CONTROL
 	: QUaFolderObject(server)
@@ -23,10 +32,16 @@ QUaModbusClientList::QUaModbusClientList(QUaServer *server)
 	: QUaFolderObjectProtected(server)
 #endif // !QUA_ACCESS_CONTROL
 {
+	m_maxConcurrentConnections = QUaModbusClientList::m_defaultMaxConcurrentConnections;
+	m_connectAttempt = 0;
+	m_metricsPort = 0;
+	m_eventLoop   = nullptr;
 	// register custom types (also registers enums of custom types)
 	server->registerType<QUaModbusTcpClient      >();
 	server->registerType<QUaModbusRtuSerialClient>();
 	server->registerType<QUaModbusDataBlockList  >();
+	server->registerType<QUaModbusDataBlockDiagnostics>();
+	server->registerType<QUaModbusLoopDiagnostics>();
 	server->registerType<QUaModbusDataBlock      >();
 	server->registerType<QUaModbusValueList      >();
 	server->registerType<QUaModbusValue          >();
@@ -39,6 +54,12 @@ QUaModbusClientList::QUaModbusClientList(QUaServer *server)
 	server->registerEnum<QDataBits        >();
 	server->registerEnum<QStopBits        >();
 	server->registerEnum(QUaModbusRtuSerialClient::ComPorts, QUaModbusRtuSerialClient::EnumComPorts());
+	// monitor ua server event loop, list is created in ua server thread
+	m_lagMonitor.attach();
+	QObject::connect(&m_lagTimer, &QTimer::timeout, this, &QUaModbusClientList::on_lagTimeout);
+	m_lagTimer.setTimerType(Qt::PreciseTimer);
+	m_lagTimer.setInterval(QUaModbusLagMonitor::m_beatPeriod);
+	m_lagTimer.start();
 }
 
 QUaModbusClientList::~QUaModbusClientList()
@@ -47,6 +68,15 @@ QUaModbusClientList::~QUaModbusClientList()
 	this->clearInmediatly();
 }
 
+QUaModbusLoopDiagnostics * QUaModbusClientList::eventLoop()
+{
+	if (!m_eventLoop)
+	{
+		m_eventLoop = this->browseChild<QUaModbusLoopDiagnostics>("EventLoop");
+	}
+	return m_eventLoop;
+}
+
 QString QUaModbusClientList::addTcpClient(const QUaQualifiedName& clientId)
 {
 	return this->addClient<QUaModbusTcpClient>(clientId);
@@ -928,6 +958,409 @@ void QUaModbusClientList::clearInmediatly()
 	}
 }
 
+quint32 QUaModbusClientList::getMaxConcurrentConnections() const
+{
+	return m_maxConcurrentConnections;
+}
+
+void QUaModbusClientList::setMaxConcurrentConnections(const quint32 & maxConcurrentConnections)
+{
+	m_maxConcurrentConnections = maxConcurrentConnections;
+	// more slots might be available now
+	this->dispatchPendingConnections();
+}
+
+quint16 QUaModbusClientList::getMetricsPort() const
+{
+	return m_metricsPort;
+}
+
+bool QUaModbusClientList::setMetricsPort(const quint16 & metricsPort)
+{
+	// NOTE : keep configured port even if cannot listen, so it is serialized
+	m_metricsPort = metricsPort;
+	return m_metricsExporter.setPort(metricsPort);
+}
+
+QString QUaModbusClientList::getMetricsFile() const
+{
+	return m_metricsExporter.getFilePath();
+}
+
+void QUaModbusClientList::setMetricsFile(const QString & strMetricsFile)
+{
+	m_metricsExporter.setFilePath(strMetricsFile);
+}
+
+QString QUaModbusClientList::csvBusLoad()
+{
+	QList<QUaModbusClientLoad> loads;
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		loads << QUaModbusBusLoad::analyze(client);
+	}
+	return QUaModbusBusLoad::toCsv(loads);
+}
+
+QQueue<QUaLog> QUaModbusClientList::checkBusLoad()
+{
+	QQueue<QUaLog> logs;
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		auto load = QUaModbusBusLoad::analyze(client);
+		logs << QUaLog(
+			tr("Client %1 (%2) uses %3% of its link.")
+				.arg(load.strClientId)
+				.arg(load.strLink)
+				.arg(load.utilisation, 0, 'f', 1),
+			load.utilisation > QUaModbusBusLoad::m_targetUtilisation ? QUaLogLevel::Warning : QUaLogLevel::Info,
+			QUaLogCategory::Network
+		);
+		for (auto &blockLoad : load.blocks)
+		{
+			if (blockLoad.feasible && blockLoad.suggestedPeriod == blockLoad.period)
+			{
+				continue;
+			}
+			logs << QUaLog(
+				tr("Block %1.%2 needs %3 ms of bus time every %4 ms. %5 Suggested SamplingTime is %6 ms.")
+					.arg(load.strClientId)
+					.arg(blockLoad.strBlockId)
+					.arg(blockLoad.busTime, 0, 'f', 1)
+					.arg(blockLoad.period)
+					.arg(blockLoad.strIssue.isEmpty() ? tr("Client link above target utilisation.") : blockLoad.strIssue)
+					.arg(blockLoad.suggestedPeriod),
+				blockLoad.feasible ? QUaLogLevel::Warning : QUaLogLevel::Error,
+				QUaLogCategory::Network
+			);
+		}
+	}
+	return logs;
+}
+
+bool QUaModbusClientList::getChangeStatistics() const
+{
+	return QUaModbusDataBlock::isChangeStatisticsEnabled();
+}
+
+void QUaModbusClientList::setChangeStatistics(const bool & changeStatistics)
+{
+	if (changeStatistics && !QUaModbusDataBlock::isChangeStatisticsEnabled())
+	{
+		auto clients = this->browseChildren<QUaModbusClient>();
+		for (auto client : clients)
+		{
+			auto blocks = client->dataBlocks()->blocks();
+			for (auto block : blocks)
+			{
+				block->resetChangeStatistics();
+			}
+		}
+	}
+	QUaModbusDataBlock::setChangeStatisticsEnabled(changeStatistics);
+}
+
+QList<QUaModbusPartition> QUaModbusClientList::partitions()
+{
+	QList<QUaModbusPartition> listPartitions;
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		auto blocks = client->dataBlocks()->blocks();
+		for (auto block : blocks)
+		{
+			auto partition = QUaModbusPartitionAdvisor::propose(block);
+			if (partition.blocks.isEmpty())
+			{
+				continue;
+			}
+			listPartitions << partition;
+		}
+	}
+	return listPartitions;
+}
+
+QString QUaModbusClientList::csvPartitionBlocks()
+{
+	QString strCsv;
+#ifndef QUA_ACCESS_CONTROL
+	strCsv += QString("%1, %2, %3, %4, %5, %6\n")
+#else
+	strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
+#endif // !QUA_ACCESS_CONTROL
+		.arg(tr("Name"        ))
+		.arg(tr("Client"      ))
+		.arg(tr("Type"        ))
+		.arg(tr("Address"     ))
+		.arg(tr("Size"        ))
+		.arg(tr("SamplingTime"))
+#ifndef QUA_ACCESS_CONTROL
+		;
+#else
+		.arg(tr("Permissions"));
+#endif // !QUA_ACCESS_CONTROL
+	auto listPartitions = this->partitions();
+	for (auto &partition : listPartitions)
+	{
+		for (auto &part : partition.blocks)
+		{
+			auto strType = QString(QMetaEnum::fromType<QModbusDataBlockType>().valueToKey(part.type));
+#ifndef QUA_ACCESS_CONTROL
+			strCsv += QString("%1, %2, %3, %4, %5, %6\n")
+#else
+			strCsv += QString("%1, %2, %3, %4, %5, %6, %7\n")
+#endif // !QUA_ACCESS_CONTROL
+				.arg(part.strBlockId)
+				.arg(part.strClientId)
+				.arg(strType)
+				.arg(part.address)
+				.arg(part.size)
+				.arg(part.samplingTime)
+#ifndef QUA_ACCESS_CONTROL
+				;
+#else
+				.arg(part.source->permissionsObject() ? part.source->permissionsObject()->browseName().name() : "");
+#endif // !QUA_ACCESS_CONTROL
+		}
+	}
+	return strCsv;
+}
+
+QString QUaModbusClientList::csvPartitionValues()
+{
+	QString strCsv;
+#ifndef QUA_ACCESS_CONTROL
+	strCsv += QString("%1, %2, %3, %4, %5\n")
+#else
+	strCsv += QString("%1, %2, %3, %4, %5, %6\n")
+#endif // !QUA_ACCESS_CONTROL
+		.arg(tr("Name"))
+		.arg(tr("Client"))
+		.arg(tr("Block"))
+		.arg(tr("Type"))
+		.arg(tr("AddressOffset"))
+#ifndef QUA_ACCESS_CONTROL
+		;
+#else
+		.arg(tr("Permissions"));
+#endif // !QUA_ACCESS_CONTROL
+	auto listPartitions = this->partitions();
+	for (auto &partition : listPartitions)
+	{
+		for (auto &part : partition.blocks)
+		{
+			for (auto &pair : part.values)
+			{
+				auto value   = pair.first;
+				auto strType = QString(QMetaEnum::fromType<QModbusValueType>().valueToKey(value->getType()));
+#ifndef QUA_ACCESS_CONTROL
+				strCsv += QString("%1, %2, %3, %4, %5\n")
+#else
+				strCsv += QString("%1, %2, %3, %4, %5, %6\n")
+#endif // !QUA_ACCESS_CONTROL
+					.arg(value->browseName().name())
+					.arg(part.strClientId)
+					.arg(part.strBlockId)
+					.arg(strType)
+					.arg(pair.second)
+#ifndef QUA_ACCESS_CONTROL
+					;
+#else
+					.arg(value->permissionsObject() ? value->permissionsObject()->browseName().name() : "");
+#endif // !QUA_ACCESS_CONTROL
+			}
+		}
+	}
+	return strCsv;
+}
+
+QString QUaModbusClientList::memorySummary()
+{
+	auto kib = [](const quint64 &bytes) {
+		return QString::number(bytes / 1024.0, 'f', 1);
+	};
+	QString strSummary = QString("%1, %2, %3, %4, %5, %6, %7, %8\n")
+		.arg(tr("Client"))
+		.arg(tr("Blocks"))
+		.arg(tr("Values"))
+		.arg(tr("Nodes"))
+		.arg(tr("ClientKiB"))
+		.arg(tr("BlocksKiB"))
+		.arg(tr("ValuesKiB"))
+		.arg(tr("TotalKiB"));
+	// list itself (event loop diagnostics)
+	QUaModbusMemoryUsage total;
+	total.objects += sizeof(QUaModbusClientList);
+	total.addNodes(this);
+	auto clients = this->browseChildren<QUaModbusClient>();
+	for (auto client : clients)
+	{
+		QUaModbusMemoryUsage usageClient = client->memoryUsage();
+		QUaModbusMemoryUsage usageBlocks;
+		QUaModbusMemoryUsage usageValues;
+		int valueCount = 0;
+		auto blocks = client->dataBlocks()->blocks();
+		for (auto block : blocks)
+		{
+			usageBlocks += block->memoryUsage();
+			auto values = block->values()->values();
+			valueCount += values.count();
+			for (auto value : values)
+			{
+				usageValues += value->memoryUsage();
+			}
+		}
+		QUaModbusMemoryUsage usage = usageClient;
+		usage += usageBlocks;
+		usage += usageValues;
+		total += usage;
+		strSummary += QString("%1, %2, %3, %4, %5, %6, %7, %8\n")
+			.arg(client->browseName().name())
+			.arg(blocks.count())
+			.arg(valueCount)
+			.arg(usage.nodeCount)
+			.arg(kib(usageClient.total()))
+			.arg(kib(usageBlocks.total()))
+			.arg(kib(usageValues.total()))
+			.arg(kib(usage.total()));
+	}
+	strSummary += tr("Total %1 KiB in %2 nodes (nodes %3 KiB, buffers %4 KiB, variants %5 KiB, objects %6 KiB)\n")
+		.arg(kib(total.total()))
+		.arg(total.nodeCount)
+		.arg(kib(total.nodes))
+		.arg(kib(total.buffers))
+		.arg(kib(total.variants))
+		.arg(kib(total.objects));
+	return strSummary;
+}
+
+bool QUaModbusClientList::getLockProfiling() const
+{
+	return QUaModbusLockProfiler::isEnabled();
+}
+
+void QUaModbusClientList::setLockProfiling(const bool & lockProfiling)
+{
+	QUaModbusLockProfiler::setEnabled(lockProfiling);
+}
+
+QString QUaModbusClientList::csvLockProfile()
+{
+	return QUaModbusLockProfiler::toCsv();
+}
+
+bool QUaModbusClientList::getTracing() const
+{
+	return QUaModbusTracer::isEnabled();
+}
+
+void QUaModbusClientList::setTracing(const bool & tracing)
+{
+	QUaModbusTracer::setEnabled(tracing);
+}
+
+bool QUaModbusClientList::dumpTrace(const QString & strFilePath)
+{
+	// pause recording for a consistent snapshot
+	bool tracing = QUaModbusTracer::isEnabled();
+	QUaModbusTracer::setEnabled(false);
+	bool ok = QUaModbusTracer::dumpChromeTrace(strFilePath);
+	QUaModbusTracer::setEnabled(tracing);
+	return ok;
+}
+
+bool QUaModbusClientList::requestConnectSlot(QUaModbusClient * client)
+{
+	// already holds a slot
+	if (m_connecting.contains(client))
+	{
+		return true;
+	}
+	// already waiting for a slot
+	if (m_connectPending.contains(client))
+	{
+		return false;
+	}
+	// wait in line if all slots are taken or others are already waiting
+	// NOTE : a client retrying right after releasing its slot must not jump the queue,
+	//        only dispatchPendingConnections hands slots to waiting clients
+	if (!m_connectPending.isEmpty() || (m_maxConcurrentConnections > 0 &&
+		static_cast<quint32>(m_connecting.count()) >= m_maxConcurrentConnections))
+	{
+		m_connectPending.enqueue(client);
+		return false;
+	}
+	this->grantConnectSlot(client);
+	return true;
+}
+
+void QUaModbusClientList::grantConnectSlot(QUaModbusClient * client)
+{
+	quint32 attempt = ++m_connectAttempt;
+	m_connecting.insert(client, attempt);
+	// NOTE : slot is only released by the client's connected or unconnected state change,
+	//        an attempt still connecting after the timeout is aborted (os tcp connect can
+	//        take minutes), which leads to the unconnected state and releases the slot
+	QPointer<QUaModbusClient> pClient(client);
+	QTimer::singleShot(QUaModbusClientList::m_connectTimeout, this,
+	[this, pClient, attempt]() {
+		if (!pClient || m_connecting.value(pClient.data()) != attempt)
+		{
+			return;
+		}
+		if (pClient->getState() == QModbusState::ConnectingState)
+		{
+			pClient->abortConnect();
+			return;
+		}
+		// client never reported the attempt (e.g. connectDevice fails in thread without changing state)
+		this->releaseConnectSlot(pClient.data());
+	});
+}
+
+void QUaModbusClientList::releaseConnectSlot(QUaModbusClient * client)
+{
+	if (!m_connecting.remove(client))
+	{
+		return;
+	}
+	this->dispatchPendingConnections();
+}
+
+void QUaModbusClientList::cancelConnectSlot(QUaModbusClient * client)
+{
+	m_connectPending.removeAll(client);
+	this->releaseConnectSlot(client);
+}
+
+void QUaModbusClientList::dispatchPendingConnections()
+{
+	// NOTE : defer to next event loop exec, so the releasing client finishes
+	//        handling its own state change before others start connecting
+	QTimer::singleShot(0, this,
+	[this]() {
+		while (!m_connectPending.isEmpty())
+		{
+			if (m_maxConcurrentConnections > 0 &&
+				static_cast<quint32>(m_connecting.count()) >= m_maxConcurrentConnections)
+			{
+				return;
+			}
+			auto client = m_connectPending.dequeue();
+			// client might have been deleted or connected while waiting
+			if (!client || client->getState() == QModbusState::ConnectedState)
+			{
+				continue;
+			}
+			// NOTE : slot taken here, so connectDevice finds it already granted
+			this->grantConnectSlot(client.data());
+			client->connectDevice();
+		}
+	});
+}
+
 #ifdef QUA_ACCESS_CONTROL
 QUaPermissionsList * QUaModbusClientList::getPermissionsList()
 {
@@ -955,6 +1388,12 @@ QDomElement QUaModbusClientList::toDomElement(QDomDocument & domDoc) const
 		elemListClients.setAttribute("Permissions", this->permissionsObject()->nodeId());
 	}
 #endif // QUA_ACCESS_CONTROL
+	// set list attributes
+	elemListClients.setAttribute("MaxConcurrentConnections", this->getMaxConcurrentConnections());
+	elemListClients.setAttribute("MetricsPort"             , this->getMetricsPort());
+	elemListClients.setAttribute("MetricsFile"             , this->getMetricsFile());
+	elemListClients.setAttribute("LockProfiling"           , this->getLockProfiling());
+	elemListClients.setAttribute("Tracing"                 , this->getTracing());
 	// loop children and add them as children
 	auto clients = this->browseChildren<QUaModbusClient>();
 	for (auto client : clients)
@@ -983,6 +1422,87 @@ void QUaModbusClientList::fromDomElement(QDomElement & domElem, QQueue<QUaLog>&
 		}
 	}
 #endif // QUA_ACCESS_CONTROL
+	// MaxConcurrentConnections (optional)
+	if (domElem.hasAttribute("MaxConcurrentConnections"))
+	{
+		bool bOK;
+		auto maxConcurrentConnections = domElem.attribute("MaxConcurrentConnections").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setMaxConcurrentConnections(maxConcurrentConnections);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid MaxConcurrentConnections attribute '%1' in Modbus client list. Default value set.").arg(domElem.attribute("MaxConcurrentConnections")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// MetricsPort (optional)
+	if (domElem.hasAttribute("MetricsPort"))
+	{
+		bool bOK;
+		auto metricsPort = domElem.attribute("MetricsPort").toUShort(&bOK);
+		if (!bOK)
+		{
+			errorLogs << QUaLog(
+				tr("Invalid MetricsPort attribute '%1' in Modbus client list. Metrics server disabled.").arg(domElem.attribute("MetricsPort")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+		else if (!this->setMetricsPort(metricsPort))
+		{
+			errorLogs << QUaLog(
+				tr("Cannot serve metrics on port %1 : %2.").arg(metricsPort).arg(m_metricsExporter.errorString()),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// MetricsFile (optional)
+	if (domElem.hasAttribute("MetricsFile"))
+	{
+		this->setMetricsFile(domElem.attribute("MetricsFile"));
+	}
+	// LockProfiling (optional)
+	if (domElem.hasAttribute("LockProfiling"))
+	{
+		bool bOK;
+		auto lockProfiling = (bool)domElem.attribute("LockProfiling").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setLockProfiling(lockProfiling);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid LockProfiling attribute '%1' in Modbus client list. Lock profiling disabled.").arg(domElem.attribute("LockProfiling")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// Tracing (optional)
+	if (domElem.hasAttribute("Tracing"))
+	{
+		bool bOK;
+		auto tracing = (bool)domElem.attribute("Tracing").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setTracing(tracing);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Tracing attribute '%1' in Modbus client list. Tracing disabled.").arg(domElem.attribute("Tracing")),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 	// add TCP clients
 	QDomNodeList listTcpClients = domElem.elementsByTagName(QUaModbusTcpClient::staticMetaObject.className());
 	for (int i = 0; i < listTcpClients.count(); i++)
@@ -1034,6 +1554,12 @@ void QUaModbusClientList::fromDomElement(QDomElement & domElem, QQueue<QUaLog>&
 		}
 		// set client config
 		client->fromDomElement(elemClient, errorLogs);
+		// connect if keepConnecting is set
+		// NOTE : connection attempts are limited by MaxConcurrentConnections
+		if (client->keepConnecting()->value().toBool())
+		{
+			client->connectDevice();
+		}
 	}
 	// add Serial clients
 	QDomNodeList listSerialClients = domElem.elementsByTagName(QUaModbusRtuSerialClient::staticMetaObject.className());
@@ -1090,4 +1616,15 @@ void QUaModbusClientList::fromDomElement(QDomElement & domElem, QQueue<QUaLog>&
 			client->connectDevice();
 		}
 	}
+}
+
+void QUaModbusClientList::on_lagTimeout()
+{
+	bool publish = m_lagMonitor.beat();
+	QUaModbusMetrics::setEventLoopLag(m_lagMonitor.lastLag());
+	if (!publish)
+	{
+		return;
+	}
+	this->eventLoop()->setSample(m_lagMonitor.sample());
 }
\ No newline at end of file
@@ -12,6 +12,14 @@ class QUaPermissionsList;
 #include <QDomElement>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QPointer>
+#include <QQueue>
+#include <QHash>
+#include <QTimer>
+
+#include "quamodbusmetrics.h"
+#include "quamodbusloopdiagnostics.h"
+#include "quamodbuspartition.h"
 
 class QUaModbusClient;
 
@@ -21,12 +29,21 @@ class QUaModbusClientList : public QUaFolderObject
 class QUaModbusClientList : public QUaFolderObjectProtected
 #endif // !QUA_ACCESS_CONTROL
 {
+	friend class QUaModbusClient;
+
     Q_OBJECT
 
+	// UA objects
+	Q_PROPERTY(QUaModbusLoopDiagnostics * EventLoop READ eventLoop)
+
 public:
 	Q_INVOKABLE explicit QUaModbusClientList(QUaServer *server);
 	~QUaModbusClientList();
 
+	// UA objects
+
+	QUaModbusLoopDiagnostics * eventLoop();
+
 	// UA methods
 
 	Q_INVOKABLE QString addTcpClient(const QUaQualifiedName& clientId);
@@ -57,6 +74,48 @@ public:
 
 	void clearInmediatly();
 
+	// estimated link utilisation per block, infeasible blocks and suggested sampling times
+	QString csvBusLoad();
+
+	// infeasible blocks as errors, overcommitted links as warnings, utilisation as info
+	QQueue<QUaLog> checkBusLoad();
+
+	// collect per register change counts of all blocks, enabling restarts the window
+	bool    getChangeStatistics() const;
+	void    setChangeStatistics(const bool &changeStatistics);
+
+	// fast/slow block split proposed from change statistics, importable with setCsvBlocks and setCsvValues
+	// NOTE : proposed blocks are new, remove the source block after import to stop reading it twice
+	QString csvPartitionBlocks();
+	QString csvPartitionValues();
+
+	// approximate memory per client (own, blocks, values) and gateway totals by category, in KiB
+	QString memorySummary();
+
+	// max number of clients allowed to be connecting at the same time (0 is unlimited)
+	quint32 getMaxConcurrentConnections() const;
+	void    setMaxConcurrentConnections(const quint32 &maxConcurrentConnections);
+
+	// prometheus metrics served on localhost port (0 is disabled), returns false if cannot listen
+	quint16 getMetricsPort() const;
+	bool    setMetricsPort(const quint16 &metricsPort);
+
+	// prometheus metrics written periodically to file (empty is disabled)
+	QString getMetricsFile() const;
+	void    setMetricsFile(const QString &strMetricsFile);
+
+	// record client lock wait and hold times per call site, see QUaModbusLockProfiler
+	bool    getLockProfiling() const;
+	void    setLockProfiling(const bool &lockProfiling);
+	// wait and hold statistics per call site recorded since profiling was enabled
+	QString csvLockProfile();
+
+	// record request lifecycle events, see QUaModbusTracer
+	bool    getTracing() const;
+	void    setTracing(const bool &tracing);
+	// write recorded requests as chrome://tracing json, returns false if file cannot be written
+	bool    dumpTrace(const QString &strFilePath);
+
 #ifdef QUA_ACCESS_CONTROL
 	QUaPermissionsList * getPermissionsList();
 #endif // QUA_ACCESS_CONTROL
@@ -73,6 +132,35 @@ private:
 	template<typename T>
 	QString addClient(const QUaQualifiedName &clientId);
 
+	// connection ramp-up (only modify and access in ua server thread)
+	quint32 m_maxConcurrentConnections;
+	quint32 m_connectAttempt;
+	QHash<QUaModbusClient*, quint32>  m_connecting;
+	QQueue<QPointer<QUaModbusClient>> m_connectPending;
+
+	// gateway wide metrics export (only modify and access in ua server thread)
+	QUaModbusMetricsExporter m_metricsExporter;
+	quint16 m_metricsPort;
+
+	// ua server event loop latency (only modify and access in ua server thread)
+	QUaModbusLagMonitor m_lagMonitor;
+	QTimer m_lagTimer;
+	QUaModbusLoopDiagnostics * m_eventLoop;
+
+	void on_lagTimeout();
+
+	QList<QUaModbusPartition> partitions();
+
+	bool requestConnectSlot(QUaModbusClient * client);
+	void grantConnectSlot  (QUaModbusClient * client);
+	void releaseConnectSlot(QUaModbusClient * client);
+	void cancelConnectSlot (QUaModbusClient * client);
+	void dispatchPendingConnections();
+
+	static quint32 m_defaultMaxConcurrentConnections;
+	// ms a connection attempt may take before it is aborted
+	static quint32 m_connectTimeout;
+
 };
 
 template<typename T>
@@ -1,12 +1,24 @@
 #include "quamodbusdatablock.h"
 #include "quamodbusclient.h"
 #include "quamodbusvalue.h"
+#include "quamodbustracer.h"
+
+#include <QTimer>
+#include <cmath>
+#include <algorithm>
 
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #endif // QUA_ACCESS_CONTROL
 
 quint32 QUaModbusDataBlock::m_minSamplingTime = 50;
+quint32 QUaModbusDataBlock::m_diagnosticsPeriod = 5000;
+bool    QUaModbusDataBlock::m_changeStatistics  = false;
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+// protocol limits of write multiple registers and coils
+int QUaModbusDataBlock::m_maxWriteRegisters = 123;
+int QUaModbusDataBlock::m_maxWriteCoils     = 1968;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 
 QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 #ifndef QUA_ACCESS_CONTROL
@@ -16,15 +28,53 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 #endif // !QUA_ACCESS_CONTROL
 {
 	m_loopHandle = -1;
+	m_loopPending = false;
+	m_loopSuspended = false;
+	m_loopRequest = 0;
 	m_firstSample = true;
+	m_queueDelay    = 0.0;
+	m_queueDelayMax = 0.0;
+	m_changeSamples = 0;
 	m_replyRead  = nullptr;
 	m_type = nullptr;
 	m_address = nullptr;
 	m_size = nullptr;
 	m_samplingTime = nullptr;
+	m_repairMode = nullptr;
+	m_scanGroup = nullptr;
+	m_triggerValue = nullptr;
+	m_triggerMode = nullptr;
+	m_triggerOnly = nullptr;
+	m_readBack = nullptr;
+	m_broadcast = nullptr;
 	m_data = nullptr;
 	m_lastError = nullptr;
+	m_repairLayout = nullptr;
 	m_values = nullptr;
+	m_repairEnabled = false;
+	m_repairing = false;
+	m_inScanGroup = false;
+	m_isBroadcast = false;
+	m_triggeredOnly = false;
+	m_readPending = false;
+	m_diagnostics = nullptr;
+	m_diagPolls = 0;
+	m_diagIntervalSum = 0.0;
+	m_diagIntervalSumSq = 0.0;
+	m_diagSample = QUaModbusDiagnosticsSample({ 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0 });
+	// to pass repair results through queued connections
+	if (QMetaType::type("QVector<quint16>") == QMetaType::UnknownType)
+	{
+		qRegisterMetaType<QVector<quint16>>("QVector<quint16>");
+	}
+	if (QMetaType::type("QVector<int>") == QMetaType::UnknownType)
+	{
+		qRegisterMetaType<QVector<int>>("QVector<int>");
+	}
+	if (QMetaType::type("QUaModbusDiagnosticsSample") == QMetaType::UnknownType)
+	{
+		qRegisterMetaType<QUaModbusDiagnosticsSample>("QUaModbusDiagnosticsSample");
+	}
 	// NOTE : QObject parent might not be yet available in constructor
 	type   ()->setDataTypeEnum(QMetaEnum::fromType<QModbusDataBlockType>());
 	type   ()->setValue(QModbusDataBlockType::Invalid);
@@ -36,11 +86,27 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 	samplingTime()->setValue(1000);
 	lastError   ()->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
 	lastError   ()->setValue(QModbusError::NoError);
+	repairMode  ()->setValue(false);
+	scanGroup   ()->setValue(false);
+	triggerValue()->setValue(QString());
+	triggerMode ()->setDataTypeEnum(QMetaEnum::fromType<QModbusTriggerMode>());
+	triggerMode ()->setValue(QModbusTriggerMode::Disabled);
+	triggerOnly ()->setValue(false);
+	readBack    ()->setValue(false);
+	broadcast   ()->setValue(false);
+	repairLayout()->setValue(QString());
 	// set initial conditions
 	type()        ->setWriteAccess(true);
 	address()     ->setWriteAccess(true);
 	size()        ->setWriteAccess(true);
 	samplingTime()->setWriteAccess(true);
+	repairMode()  ->setWriteAccess(true);
+	scanGroup()   ->setWriteAccess(true);
+	triggerValue()->setWriteAccess(true);
+	triggerMode() ->setWriteAccess(true);
+	triggerOnly() ->setWriteAccess(true);
+	readBack()    ->setWriteAccess(true);
+	broadcast()   ->setWriteAccess(true);
 	data()        ->setMinimumSamplingInterval(1000);
 	// handle state changes
 	QObject::connect(type()        , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_typeChanged        , Qt::QueuedConnection);
@@ -48,14 +114,37 @@ QUaModbusDataBlock::QUaModbusDataBlock(QUaServer *server)
 	QObject::connect(size()        , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_sizeChanged        , Qt::QueuedConnection);
 	QObject::connect(samplingTime(), &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_samplingTimeChanged, Qt::QueuedConnection);
 	QObject::connect(data()        , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_dataChanged        , Qt::QueuedConnection);
+	QObject::connect(repairMode()  , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_repairModeChanged  , Qt::QueuedConnection);
+	QObject::connect(scanGroup()   , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_scanGroupChanged   , Qt::QueuedConnection);
+	QObject::connect(triggerValue(), &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_triggerValueChanged, Qt::QueuedConnection);
+	QObject::connect(triggerMode() , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_triggerModeChanged , Qt::QueuedConnection);
+	QObject::connect(triggerOnly() , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_triggerOnlyChanged , Qt::QueuedConnection);
+	QObject::connect(readBack()    , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_readBackChanged    , Qt::QueuedConnection);
+	QObject::connect(broadcast()   , &QUaBaseVariable::valueChanged, this, &QUaModbusDataBlock::on_broadcastChanged   , Qt::QueuedConnection);
 	// to safely update error in ua server thread
 	QObject::connect(this, &QUaModbusDataBlock::updateLastError, this, &QUaModbusDataBlock::on_updateLastError);
+	// to safely update repair results in ua server thread
+	QObject::connect(this, &QUaModbusDataBlock::updateRepairLayout, this, &QUaModbusDataBlock::on_updateRepairLayout);
+	QObject::connect(this, &QUaModbusDataBlock::repairedDataRead  , this, &QUaModbusDataBlock::on_repairedDataRead  );
+	// to safely publish poll statistics in ua server thread
+	QObject::connect(this, &QUaModbusDataBlock::updateDiagnostics , this, &QUaModbusDataBlock::on_updateDiagnostics );
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	QObject::connect(this, &QUaModbusDataBlock::cyclicWrite       , this, &QUaModbusDataBlock::on_cyclicWrite       );
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 	// set descriptions
 	/*
 	type        ()->setDescription(tr("Type of Modbus register for this block."));
 	address     ()->setDescription(tr("Start register address for this block (with respect to the register type)."));
 	size        ()->setDescription(tr("Size (in registers) for this block."));
 	samplingTime()->setDescription(tr("Polling time (cycle time) to read this block."));
+	repairMode  ()->setDescription(tr("Whether to isolate unmapped registers when the device replies with an Illegal Data Address exception."));
+	scanGroup   ()->setDescription(tr("Whether this block is read in the client scan cycle, together with the other ScanGroup blocks, instead of its own polling loop."));
+	triggerValue()->setDescription(tr("Value whose change triggers a read of this block, as ValueName (same block) or BlockName/ValueName."));
+	triggerMode ()->setDescription(tr("Whether any change or only a rising or falling edge of the trigger value reads this block."));
+	triggerOnly ()->setDescription(tr("Whether to stop periodic polling and only read this block when triggered."));
+	readBack    ()->setDescription(tr("Whether to read this block right after a successful write, instead of waiting for the next poll."));
+	broadcast   ()->setDescription(tr("Whether writes to this block are broadcast to all devices (server address 0). Broadcast blocks are never read."));
+	repairLayout()->setDescription(tr("Register ranges read and quarantined as found by the repair mode."));
 	data        ()->setDescription(tr("The current block values as per the last successfull read."));
 	lastError   ()->setDescription(tr("The last error reported while reading or writing this block."));
 	values      ()->setDescription(tr("List of converted values."));
@@ -67,12 +156,10 @@ QUaModbusDataBlock::~QUaModbusDataBlock()
 	emit this->aboutToDestroy();
 	emit m_values->aboutToClear();
 	// stop loop
-	if (m_loopHandle > 0)
-	{
-		this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
-	}	
-	// make handle invalid **after** stopping loop in thread
-	m_loopHandle = -1;
+	this->stopLoop();
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	this->stopCyclicWrites();
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 	// delete while block still valid, because in views values reference parent block
 	for (auto value : m_values->values())
 	{
@@ -116,6 +203,69 @@ QUaProperty * QUaModbusDataBlock::samplingTime()
 	return m_samplingTime;
 }
 
+QUaProperty * QUaModbusDataBlock::repairMode()
+{
+	if (!m_repairMode)
+	{
+		m_repairMode = this->browseChild<QUaProperty>("RepairMode");
+	}
+	return m_repairMode;
+}
+
+QUaProperty * QUaModbusDataBlock::scanGroup()
+{
+	if (!m_scanGroup)
+	{
+		m_scanGroup = this->browseChild<QUaProperty>("ScanGroup");
+	}
+	return m_scanGroup;
+}
+
+QUaProperty * QUaModbusDataBlock::triggerValue()
+{
+	if (!m_triggerValue)
+	{
+		m_triggerValue = this->browseChild<QUaProperty>("TriggerValue");
+	}
+	return m_triggerValue;
+}
+
+QUaProperty * QUaModbusDataBlock::triggerMode()
+{
+	if (!m_triggerMode)
+	{
+		m_triggerMode = this->browseChild<QUaProperty>("TriggerMode");
+	}
+	return m_triggerMode;
+}
+
+QUaProperty * QUaModbusDataBlock::triggerOnly()
+{
+	if (!m_triggerOnly)
+	{
+		m_triggerOnly = this->browseChild<QUaProperty>("TriggerOnly");
+	}
+	return m_triggerOnly;
+}
+
+QUaProperty * QUaModbusDataBlock::readBack()
+{
+	if (!m_readBack)
+	{
+		m_readBack = this->browseChild<QUaProperty>("ReadBack");
+	}
+	return m_readBack;
+}
+
+QUaProperty * QUaModbusDataBlock::broadcast()
+{
+	if (!m_broadcast)
+	{
+		m_broadcast = this->browseChild<QUaProperty>("Broadcast");
+	}
+	return m_broadcast;
+}
+
 QUaBaseDataVariable * QUaModbusDataBlock::data()
 {
 	if (!m_data)
@@ -134,6 +284,15 @@ QUaBaseDataVariable * QUaModbusDataBlock::lastError()
 	return m_lastError;
 }
 
+QUaBaseDataVariable * QUaModbusDataBlock::repairLayout()
+{
+	if (!m_repairLayout)
+	{
+		m_repairLayout = this->browseChild<QUaBaseDataVariable>("RepairLayout");
+	}
+	return m_repairLayout;
+}
+
 QUaModbusValueList * QUaModbusDataBlock::values()
 {
 	if (!m_values)
@@ -143,15 +302,27 @@ QUaModbusValueList * QUaModbusDataBlock::values()
 	return m_values;
 }
 
+QUaModbusDataBlockDiagnostics * QUaModbusDataBlock::diagnostics()
+{
+	if (!m_diagnostics)
+	{
+		m_diagnostics = this->browseChild<QUaModbusDataBlockDiagnostics>("Diagnostics");
+	}
+	return m_diagnostics;
+}
+
 void QUaModbusDataBlock::remove()
 {
 	// stop loop
-	this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
-	// make handle invalid **after** stopping loop in thread
-	m_loopHandle = -1;
+	this->stopLoop();
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	this->stopCyclicWrites();
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 	// call deleteLater in thread, so thread has time to stop loop first
 	// NOTE : deleteLater will delete the object in the correct thread anyways
 	this->client()->m_workerThread.execInThread([this]() {
+		// leave scan group before next scan
+		this->client()->m_scanGroup.removeAll(this);
 		// then delete
 		this->deleteLater();	
 	}, Qt::EventPriority::LowEventPriority);
@@ -167,6 +338,7 @@ void QUaModbusDataBlock::on_typeChanged(const QVariant &value, const bool& netwo
 	// set in thread for safety
 	this->client()->m_workerThread.execInThread([this, type]() {
 		m_registerType = static_cast<QModbusDataBlockType>(type);
+		this->clearRepair();
 	});
 	// set data writable according to type
 	if (type == QModbusDataBlockType::Coils ||
@@ -178,6 +350,10 @@ void QUaModbusDataBlock::on_typeChanged(const QVariant &value, const bool& netwo
 	{
 		data()->setWriteAccess(false);
 	}
+	// keep probe target of quarantined client valid
+	this->client()->updateProbeTarget();
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
 	// emit
 	emit this->typeChanged(type);
 	// update permissions in values
@@ -206,7 +382,12 @@ void QUaModbusDataBlock::on_addressChanged(const QVariant & value, const bool& n
 	// set in thread for safety
 	this->client()->m_workerThread.execInThread([this, address]() {
 		m_startAddress = address;
+		this->clearRepair();
 	});
+	// keep probe target of quarantined client valid
+	this->client()->updateProbeTarget();
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
 	// emit
 	emit this->addressChanged(address);
 }
@@ -221,7 +402,12 @@ void QUaModbusDataBlock::on_sizeChanged(const QVariant & value, const bool& netw
 	// set in thread for safety
 	this->client()->m_workerThread.execInThread([this, size]() {
 		m_valueCount = size;
+		this->clearRepair();
 	});
+	// keep probe target of quarantined client valid
+	this->client()->updateProbeTarget();
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
 	// emit
 	emit this->sizeChanged(size);
 }
@@ -245,10 +431,8 @@ void QUaModbusDataBlock::on_samplingTimeChanged(const QVariant & value, const bo
 		return;
 	}
 	// stop old loop
-	this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
-	// make handle invalid **after** stopping loop in thread
-	m_loopHandle = -1;
-	// start new loop
+	this->stopLoop();
+	// start new loop (stays suspended if client is not polling)
 	this->startLoop();
 	// update ua sample interval for data
 	this->data()->setMinimumSamplingInterval((double)samplingTime);
@@ -270,181 +454,302 @@ void QUaModbusDataBlock::on_dataChanged(const QVariant & value, const bool& netw
 	this->setModbusData(data);
 }
 
-void QUaModbusDataBlock::on_updateLastError(const QModbusError & error)
+void QUaModbusDataBlock::on_repairModeChanged(const QVariant & value, const bool & networkChange)
 {
-	// avoid update or emit if no change, improves performance
-	if (error == this->getLastError())
+	if (!networkChange)
 	{
 		return;
 	}
-	this->lastError()->setValue(error);
-	// NOTE : need to add custom signal because OPC UA valueChanged
-	//        only works for changes through network
-	// emit
-	emit this->lastErrorChanged(error);
-	// update errors in values
-	auto values = this->values()->values();
-	for (auto value : values)
-	{
-		// need to keep configuration error if value is still not well configured
-		auto isWellConfigured = value->isWellConfigured();
-		if (!isWellConfigured)
+	auto repairMode = value.toBool();
+	// set in thread for safety
+	this->client()->m_workerThread.execInThread([this, repairMode]() {
+		m_repairEnabled = repairMode;
+		if (!m_repairEnabled)
 		{
-			continue;
+			this->clearRepair();
 		}
-		value->setLastError(error);
+	});
+	// emit
+	emit this->repairModeChanged(repairMode);
+}
+
+void QUaModbusDataBlock::on_scanGroupChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
 	}
+	auto scanGroup = value.toBool();
+	// set in thread for safety
+	this->client()->m_workerThread.execInThread([this, scanGroup]() {
+		m_inScanGroup = scanGroup;
+	});
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
+	// emit
+	emit this->scanGroupChanged(scanGroup);
 }
 
-QUaModbusDataBlockList * QUaModbusDataBlock::list() const
+void QUaModbusDataBlock::on_triggerValueChanged(const QVariant & value, const bool & networkChange)
 {
-	return qobject_cast<QUaModbusDataBlockList*>(this->parent());
+	if (!networkChange)
+	{
+		return;
+	}
+	this->updateTrigger();
+	// emit
+	emit this->triggerValueChanged(value.toString());
 }
 
-QUaModbusClient * QUaModbusDataBlock::client() const
+void QUaModbusDataBlock::on_triggerModeChanged(const QVariant & value, const bool & networkChange)
 {
-	return this->list()->client();
+	if (!networkChange)
+	{
+		return;
+	}
+	this->updateTrigger();
+	// emit
+	emit this->triggerModeChanged(value.value<QModbusTriggerMode>());
 }
 
-void QUaModbusDataBlock::startLoop()
+void QUaModbusDataBlock::on_triggerOnlyChanged(const QVariant & value, const bool & networkChange)
 {
-	auto samplingTime = this->samplingTime()->value().value<quint32>();
-	// exec read request in client thread
-	m_loopHandle = this->client()->m_workerThread.startLoopInThread(
-	[this]() {
-		//Q_ASSERT(m_loopHandle > 0); // NOTE : this does happen when cleaning all blocks form a client
-		if (m_loopHandle <= 0)
-		{
-			return;
-		}
-		auto client = this->client();
-		// TODO : can happen in shutdown? possible BUG
-		if (!client)
-		{
-			return;
-		}
-		// check if ongoing request
-		if (m_replyRead)
+	if (!networkChange)
+	{
+		return;
+	}
+	this->updateTrigger();
+	// emit
+	emit this->triggerOnlyChanged(value.toBool());
+}
+
+void QUaModbusDataBlock::on_readBackChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->readBackChanged(value.toBool());
+}
+
+void QUaModbusDataBlock::on_broadcastChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	auto broadcast = value.toBool();
+	// set in thread for safety
+	this->client()->m_workerThread.execInThread([this, broadcast]() {
+		m_isBroadcast = broadcast;
+	});
+	// no read ever answers a broadcast, do not report stale errors
+	if (broadcast)
+	{
+		this->setLastError(QModbusError::NoError);
+	}
+	// keep probe target of quarantined client valid
+	this->client()->updateProbeTarget();
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
+	// emit
+	emit this->broadcastChanged(broadcast);
+}
+
+void QUaModbusDataBlock::on_triggerSourceChanged(const QVariant & value)
+{
+	// ignore invalid values published on errors
+	if (!value.isValid())
+	{
+		return;
+	}
+	auto last = m_triggerLast;
+	m_triggerLast = value;
+	if (!last.isValid())
+	{
+		return;
+	}
+	bool fire = false;
+	switch (this->getTriggerMode())
+	{
+	case QModbusTriggerMode::Change:
+		fire = last != value;
+		break;
+	case QModbusTriggerMode::RisingEdge:
+		fire = !last.toBool() && value.toBool();
+		break;
+	case QModbusTriggerMode::FallingEdge:
+		fire = last.toBool() && !value.toBool();
+		break;
+	default:
+		break;
+	}
+	if (!fire)
+	{
+		return;
+	}
+	this->triggerRead();
+}
+
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+void QUaModbusDataBlock::on_cyclicWrite(const quint32 & period)
+{
+	// NOTE : block type and data only read in ua server thread here
+	auto blockType = this->getType();
+	auto blockSize = static_cast<int>(this->getSize());
+	auto blockData = this->getData();
+	// collect registers of all values due in this period
+	struct QUaModbusCyclicSpan
+	{
+		QPointer<QUaModbusValue> value;
+		QVariant next;
+		int      offset;
+		int      count;
+	};
+	QMap<int, quint16> registers;
+	QList<QUaModbusCyclicSpan> spans;
+	bool hasPeriod = false;
+	for (auto value : this->values()->values())
+	{
+		if (value->getCyclicWritePeriod() != period)
 		{
-			return;
+			continue;
 		}
-		// check if request is valid
-		if (m_registerType == QModbusDataBlockType::Invalid)
+		hasPeriod = true;
+		// NOTE : misconfigured values (e.g. being edited) are skipped, not unscheduled
+		if (!value->isWellConfigured())
 		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
+			continue;
 		}
-		if (m_startAddress < 0)
+		auto type   = value->getType();
+		auto offset = value->getAddressOffset();
+		auto next   = value->cyclicWriteValue();
+		bool bOK;
+		auto data   = QUaModbusValue::valueToBlock(next, type, value->getCount(), &bOK);
+		if (!bOK)
 		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
+			value->setLastError(QModbusError::ConfigurationError);
+			continue;
 		}
-		if (m_valueCount == 0)
+		if (offset + data.count() > blockSize)
 		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
+			continue;
 		}
-		// check if connected
-		auto state = client->getState();
-		if (state != QModbusState::ConnectedState)
+		// single bit of a register, keep the other bits (also from other values due now)
+		if (blockType == QModbusDataBlockType::HoldingRegisters &&
+			type >= QModbusValueType::Binary0 && type <= QModbusValueType::Binary15)
 		{
-			if (!m_firstSample)
+			quint16 mask = 0x0001 << type;
+			for (int i = 0; i < data.count(); i++)
 			{
-				// force update last modbus value
-				auto values = this->values()->values();
-				for (auto value : values)
-				{
-					emit value->valueChanged(value->getValue());
-				}
-				m_firstSample = true;
+				quint16 base = registers.contains(offset + i) ? registers.value(offset + i) :
+					offset + i < blockData.count() ? blockData.at(offset + i) : 0;
+				registers[offset + i] = (base & ~mask) | (data.at(i) & mask);
 			}
-			auto clientError = client->getLastError();
-			emit this->updateLastError(clientError);
-			return;
 		}
-		// create and send request		
-		auto serverAddress = client->getServerAddress();
-		// NOTE : need to pass in a fresh QModbusDataUnit instance or reply for coils returns empty
-		//        wierdly, registers work fine when passing m_modbusDataUnit
-		m_replyRead = client->m_modbusClient->sendReadRequest(
-			QModbusDataUnit(
-				static_cast<QModbusDataUnit::RegisterType>(m_registerType),
-				m_startAddress, 
-				m_valueCount
-			)
-			, serverAddress
-		);
-		// check if no error
-		if (!m_replyRead)
+		else
 		{
-			if (!client->m_disconnectRequested)
+			for (int i = 0; i < data.count(); i++)
 			{
-				emit this->updateLastError(QModbusError::ReplyAbortedError);
+				registers[offset + i] = data.at(i);
 			}
-			return;
 		}
-		// check if finished immediately (ignore)
-		if (m_replyRead->isFinished())
+		QUaModbusCyclicSpan span;
+		span.value  = value;
+		span.next   = next;
+		span.offset = offset;
+		span.count  = data.count();
+		spans << span;
+	}
+	// no values left with this period, stop its loop
+	if (!hasPeriod)
+	{
+		int handle = m_cyclicLoops.take(period);
+		this->client()->m_workerThread.stopLoopInThread(handle);
+		return;
+	}
+	// send one request per contiguous run of registers, values are never split across runs
+	// NOTE : a single value larger than the request limit still gets its own run
+	int maxCount = blockType == QModbusDataBlockType::Coils ?
+		QUaModbusDataBlock::m_maxWriteCoils : QUaModbusDataBlock::m_maxWriteRegisters;
+	std::sort(spans.begin(), spans.end(), [](const QUaModbusCyclicSpan &a, const QUaModbusCyclicSpan &b) {
+		return a.offset < b.offset;
+	});
+	int runOffset = -1;
+	int runEnd    = -1;
+	QList<QPair<QPointer<QUaModbusValue>, QVariant>> runWritten;
+	auto flushRun = [this, &registers, &runOffset, &runEnd, &runWritten]() {
+		if (runWritten.isEmpty())
 		{
-			// broadcast replies return immediately
-			m_replyRead->deleteLater();
-			m_replyRead = nullptr;
 			return;
 		}
-		// subscribe to finished
-		QObject::connect(m_replyRead, &QModbusReply::finished, this,
-			[this]() {
-				// NOTE : exec'd in ua server thread (not in worker thread)
-				auto client = this->client();
-				Q_CHECK_PTR(client);
-				if (client->m_disconnectRequested || client->getState() != QModbusState::ConnectedState)
-				{
-					m_replyRead = nullptr;
-					this->setLastError(QModbusError::ReplyAbortedError);
-					return;
-				}
-				// check if reply still valid
-				if (!m_replyRead)
-				{
-					this->setLastError(QModbusError::ReplyAbortedError);
-					return;
-				}
-				// handle error
-				auto error = m_replyRead->error();
-				this->setLastError(error);
-				// update block value
-				QVector<quint16> data = m_replyRead->result().values();
-				// TODO : early exit when refactor QUaModbusValue::setValue
-				if (error == QModbusError::NoError)
-				{
-					Q_ASSERT(data.count() == m_valueCount);
-					this->setData(data, false);
-				}
-				// update modbus values and errors
-				auto values = this->values()->values();
-				for (auto value : values)
-				{
-					value->setValue(data, error, m_firstSample);
-				}
-				// delete reply on next event loop exec
-				m_replyRead->deleteLater();
-				m_replyRead = nullptr;
-				m_firstSample = false;
-			}, Qt::QueuedConnection);
-		}, samplingTime);
-	Q_ASSERT(m_loopHandle > 0);
+		QVector<quint16> runData;
+		for (int i = runOffset; i < runEnd; i++)
+		{
+			runData << registers.value(i);
+		}
+		this->writeCyclicRun(runOffset, runData, runWritten);
+		runWritten.clear();
+	};
+	for (auto &span : spans)
+	{
+		int spanEnd = span.offset + span.count;
+		if (runWritten.isEmpty() || span.offset > runEnd || qMax(runEnd, spanEnd) - runOffset > maxCount)
+		{
+			flushRun();
+			runOffset = span.offset;
+			runEnd    = spanEnd;
+		}
+		runEnd = qMax(runEnd, spanEnd);
+		runWritten << qMakePair(span.value, span.next);
+	}
+	flushRun();
 }
 
-bool QUaModbusDataBlock::loopRunning()
+void QUaModbusDataBlock::updateCyclicWrites()
+{
+	// NOTE : exec'd in ua server thread
+	for (auto value : this->values()->values())
+	{
+		auto period = value->getCyclicWritePeriod();
+		if (period == 0 || m_cyclicLoops.contains(period))
+		{
+			continue;
+		}
+		// NOTE : loops without values left are stopped by on_cyclicWrite
+		m_cyclicLoops[period] = this->client()->m_workerThread.startLoopInThread(
+		[this, period]() {
+			auto state = this->client()->getState();
+			if (state != QModbusState::ConnectedState)
+			{
+				return;
+			}
+			emit this->cyclicWrite(period);
+		},
+		period);
+	}
+}
+
+void QUaModbusDataBlock::stopCyclicWrites()
 {
-	return m_loopHandle >= 0;
+	for (auto handle : m_cyclicLoops)
+	{
+		this->client()->m_workerThread.stopLoopInThread(handle);
+	}
+	m_cyclicLoops.clear();
 }
 
-void QUaModbusDataBlock::setModbusData(const QVector<quint16>& data)
+void QUaModbusDataBlock::writeCyclicRun(
+	const int &offset,
+	const QVector<quint16> &data,
+	const QList<QPair<QPointer<QUaModbusValue>, QVariant>> &written
+)
 {
 	// exec write request in client thread
 	this->client()->m_workerThread.execInThread(
-	[this, data]() {
+	[this, offset, data, written]() {
+		QUaModbusTaskScope taskScope("QUaModbusDataBlock::writeCyclicRun");
 		auto client = this->client();
 		// check if request is valid
 		if (m_registerType != QModbusDataBlockType::Coils &&
@@ -452,57 +757,1006 @@ void QUaModbusDataBlock::setModbusData(const QVector<quint16>& data)
 		{
 			return;
 		}
-		if (m_startAddress < 0)
-		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
-		}
-		if (m_valueCount == 0)
-		{
-			emit this->updateLastError(QModbusError::ConfigurationError);
-			return;
-		}
-		// check if connected
-		auto state = client->getState();
-		if (state != QModbusState::ConnectedState)
+		if (client->getState() != QModbusState::ConnectedState)
 		{
-			auto clientError = client->getLastError();
-			emit this->updateLastError(clientError);
 			return;
 		}
-		// create data target 
 		QModbusDataUnit dataToWrite(
-			static_cast<QModbusDataUnit::RegisterType>(m_registerType), 
-			m_startAddress, 
+			static_cast<QModbusDataUnit::RegisterType>(m_registerType),
+			m_startAddress + offset,
 			data
 		);
-		// create and send request
-		auto serverAddress = client->getServerAddress();
-		QModbusReply * p_reply = client->m_modbusClient->sendWriteRequest(dataToWrite, serverAddress);
+		auto serverAddress = this->writeServerAddress();
+		QModbusReply * p_reply = client->sendWriteRequest(dataToWrite, serverAddress);
 		if (!p_reply)
 		{
 			emit this->updateLastError(QModbusError::ReplyAbortedError);
 			return;
 		}
 		// subscribe to finished
-		QObject::connect(p_reply, &QModbusReply::finished, this, 
-		[this, p_reply]() mutable {
+		this->onWriteFinished(p_reply, serverAddress, this,
+		[this, written](QModbusError error) {
 			// NOTE : exec'd in ua server thread (not in worker thread)
-			// check if reply still valid
-			if (!p_reply)
+			QUaModbusTaskScope taskScope("QUaModbusDataBlock::writeCyclicRun reply");
+			if (this->client()->m_disconnectRequested || this->client()->getState() != QModbusState::ConnectedState)
 			{
-				auto error = QModbusError::ReplyAbortedError;
-				this->setLastError(error);
-				return;
+				error = QModbusError::ReplyAbortedError;
 			}
-			// handle error
-			auto error = p_reply->error();
-			this->setLastError(error);
-			// delete reply on next event loop exec
-			p_reply->deleteLater();
-			p_reply = nullptr;
-		}, Qt::QueuedConnection);
-	});
+			// same result for all values in the run
+			for (auto pair : written)
+			{
+				auto value = pair.first;
+				if (!value)
+				{
+					continue;
+				}
+				value->setLastError(error);
+				if (error == QModbusError::NoError)
+				{
+					emit value->valueChanged(pair.second);
+				}
+			}
+			// confirm device state without waiting for next poll
+			if (error == QModbusError::NoError && this->getReadBack())
+			{
+				this->triggerRead();
+			}
+		});
+	});
+}
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+
+void QUaModbusDataBlock::on_updateRepairLayout(const QString & repairLayout, const QVector<int> &repairRanges)
+{
+	m_repairRanges = repairRanges;
+	// avoid update or emit if no change
+	if (repairLayout == this->getRepairLayout())
+	{
+		return;
+	}
+	this->repairLayout()->setValue(repairLayout);
+	// emit
+	emit this->repairLayoutChanged(repairLayout);
+}
+
+void QUaModbusDataBlock::on_repairedDataRead(const QVector<quint16>& data, const QVector<int>& badOffsets, const QModbusError & error, const QDateTime & sourceTimestamp)
+{
+	// NOTE : same as read reply handling in startLoopNow, but registers in
+	//        bad ranges are quarantined instead of failing the whole block
+	auto client = this->client();
+	if (client->m_disconnectRequested || client->getState() != QModbusState::ConnectedState)
+	{
+		this->setLastError(QModbusError::ReplyAbortedError);
+		return;
+	}
+	this->setLastError(error);
+	client->reportReadResult(error);
+	if (error == QModbusError::NoError)
+	{
+		this->setData(data, false);
+		this->data()->setSourceTimestamp(sourceTimestamp);
+	}
+	auto values = this->values()->values();
+	for (auto value : values)
+	{
+		if (error == QModbusError::NoError && value->isWellConfigured())
+		{
+			int offset = value->getAddressOffset();
+			int size   = value->blockSize();
+			auto it = std::lower_bound(badOffsets.begin(), badOffsets.end(), offset);
+			if (it != badOffsets.end() && *it < offset + size)
+			{
+				value->setLastError(QModbusError::ProtocolError);
+				continue;
+			}
+		}
+		value->setValue(data, error, m_firstSample, sourceTimestamp);
+	}
+	m_firstSample = false;
+}
+
+void QUaModbusDataBlock::on_updateDiagnostics(const QUaModbusDiagnosticsSample & sample)
+{
+	this->diagnostics()->setSample(sample);
+}
+
+void QUaModbusDataBlock::on_updateLastError(const QModbusError & error)
+{
+	// avoid update or emit if no change, improves performance
+	if (error == this->getLastError())
+	{
+		return;
+	}
+	this->lastError()->setValue(error);
+	// NOTE : need to add custom signal because OPC UA valueChanged
+	//        only works for changes through network
+	// emit
+	emit this->lastErrorChanged(error);
+	// update errors in values
+	auto values = this->values()->values();
+	for (auto value : values)
+	{
+		// need to keep configuration error if value is still not well configured
+		auto isWellConfigured = value->isWellConfigured();
+		if (!isWellConfigured)
+		{
+			continue;
+		}
+		value->setLastError(error);
+	}
+}
+
+QUaModbusDataBlockList * QUaModbusDataBlock::list() const
+{
+	return qobject_cast<QUaModbusDataBlockList*>(this->parent());
+}
+
+QUaModbusClient * QUaModbusDataBlock::client() const
+{
+	return this->list()->client();
+}
+
+QUaModbusMemoryUsage QUaModbusDataBlock::memoryUsage() const
+{
+	QUaModbusMemoryUsage usage;
+	usage.objects  += sizeof(QUaModbusDataBlock);
+	// includes Data variable holding the block registers
+	usage.addNodes(const_cast<QUaModbusDataBlock*>(this));
+	usage.buffers  += m_diagLatency.memoryUsage();
+	usage.buffers  += static_cast<quint64>(m_changeLast.capacity())   * sizeof(quint16);
+	usage.buffers  += static_cast<quint64>(m_changeCounts.capacity()) * sizeof(quint32);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	// map node holds key, value and tree links
+	usage.buffers  += static_cast<quint64>(m_cyclicLoops.count()) * (sizeof(quint32) + sizeof(int) + 3 * sizeof(void*));
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+	usage.variants += QUaModbusMemoryUsage::variantBytes(m_triggerLast);
+	return usage;
+}
+
+void QUaModbusDataBlock::startLoop()
+{
+	// do not wake up while client is not connected or quarantined
+	if (this->client()->isPollingSuspended())
+	{
+		m_loopSuspended = true;
+		return;
+	}
+	auto samplingTime = this->samplingTime()->value().value<quint32>();
+	// spread the first poll of the client's blocks across the sampling period,
+	// so blocks created at the same time (e.g. loading config) do not poll in phase
+	auto blockIndex = this->list()->blocks().indexOf(this);
+	auto phase = QUaModbusDataBlock::loopPhase(blockIndex, samplingTime);
+	if (phase == 0)
+	{
+		this->startLoopNow(samplingTime);
+		return;
+	}
+	m_loopPending = true;
+	auto loopRequest = m_loopRequest;
+	QTimer::singleShot(phase, this,
+	[this, loopRequest]() {
+		// check loop was not stopped or restarted in the meantime
+		if (!m_loopPending || loopRequest != m_loopRequest)
+		{
+			return;
+		}
+		m_loopPending = false;
+		this->startLoopNow(this->getSamplingTime());
+	});
+}
+
+void QUaModbusDataBlock::startLoopNow(const quint32 &samplingTime)
+{
+	// exec read request in client thread
+	m_loopHandle = this->client()->m_workerThread.startLoopInThread(
+	[this]() {
+		//Q_ASSERT(m_loopHandle > 0); // NOTE : this does happen when cleaning all blocks form a client
+		if (m_loopHandle <= 0)
+		{
+			return;
+		}
+		// triggered blocks are only read when their trigger fires
+		if (m_triggeredOnly)
+		{
+			return;
+		}
+		this->readBlock();
+	}, samplingTime);
+	Q_ASSERT(m_loopHandle > 0);
+}
+
+void QUaModbusDataBlock::readBlock()
+{
+	// NOTE : exec'd in worker thread
+	QUaModbusTaskScope taskScope("QUaModbusDataBlock::readBlock");
+	auto client = this->client();
+	// TODO : can happen in shutdown? possible BUG
+	if (!client)
+	{
+		return;
+	}
+	// check if ongoing request
+	if (m_replyRead)
+	{
+		m_diagSample.skippedPolls++;
+		return;
+	}
+	// check if request is valid
+	if (m_registerType == QModbusDataBlockType::Invalid)
+	{
+		emit this->updateLastError(QModbusError::ConfigurationError);
+		return;
+	}
+	if (m_startAddress < 0)
+	{
+		emit this->updateLastError(QModbusError::ConfigurationError);
+		return;
+	}
+	if (m_valueCount == 0)
+	{
+		emit this->updateLastError(QModbusError::ConfigurationError);
+		return;
+	}
+	// check if connected
+	// NOTE : client suspends this loop when not connected, this only
+	//        happens while the suspension is being processed
+	auto state = client->getState();
+	if (state != QModbusState::ConnectedState)
+	{
+		return;
+	}
+	// broadcast blocks are write only, devices do not reply to broadcasts
+	if (m_isBroadcast)
+	{
+		return;
+	}
+	// check if read by client scan cycle instead
+	if (m_inScanGroup && client->m_scanPeriod > 0)
+	{
+		return;
+	}
+	// check if repair in progress
+	if (m_repairing)
+	{
+		return;
+	}
+	// repaired block, only read valid ranges
+	if (!m_validRanges.isEmpty() || !m_badRanges.isEmpty())
+	{
+		this->readValidRanges(0, QVector<quint16>(static_cast<int>(m_valueCount), 0));
+		return;
+	}
+	// create and send request		
+	this->accountPoll();
+	auto serverAddress = client->getServerAddress();
+	// NOTE : loop reads are started by the worker thread itself, so there is no queue span
+	quint64 traceId = QUaModbusTracer::newId();
+	QUaModbusTracer::trace(QUaModbusTracer::Send, traceId);
+	// NOTE : need to pass in a fresh QModbusDataUnit instance or reply for coils returns empty
+	//        wierdly, registers work fine when passing m_modbusDataUnit
+	m_replyRead = client->sendReadRequest(
+		QModbusDataUnit(
+			static_cast<QModbusDataUnit::RegisterType>(m_registerType),
+			m_startAddress, 
+			m_valueCount
+		)
+		, serverAddress
+	);
+	// check if no error
+	if (!m_replyRead)
+	{
+		if (!client->m_disconnectRequested)
+		{
+			emit this->updateLastError(QModbusError::ReplyAbortedError);
+		}
+		return;
+	}
+	// check if finished immediately (ignore)
+	if (m_replyRead->isFinished())
+	{
+		// broadcast replies return immediately
+		m_replyRead->deleteLater();
+		m_replyRead = nullptr;
+		return;
+	}
+	// account response latency in worker thread
+	QElapsedTimer sent;
+	sent.start();
+	auto reply = m_replyRead;
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[this, reply, sent]() {
+		this->accountReply(reply, sent.nsecsElapsed());
+	});
+	// subscribe to finished
+	auto receipt = QUaModbusDataBlock::stampOnFinished(m_replyRead);
+	receipt->traceId = traceId;
+	QObject::connect(m_replyRead, &QModbusReply::finished, this,
+		[this, receipt]() {
+			// NOTE : exec'd in ua server thread (not in worker thread)
+			QUaModbusTracer::trace(QUaModbusTracer::Dispatch, receipt->traceId);
+			QUaModbusTraceScope traceScope(receipt->traceId);
+			QUaModbusTaskScope  taskScope("QUaModbusDataBlock::readBlock reply");
+			m_queueDelay    = receipt->elapsed.nsecsElapsed() / 1000000.0;
+			m_queueDelayMax = qMax(m_queueDelayMax, m_queueDelay);
+			auto client = this->client();
+			Q_CHECK_PTR(client);
+			if (client->m_disconnectRequested || client->getState() != QModbusState::ConnectedState)
+			{
+				m_replyRead = nullptr;
+				this->setLastError(QModbusError::ReplyAbortedError);
+				return;
+			}
+			// check if reply still valid
+			if (!m_replyRead)
+			{
+				this->setLastError(QModbusError::ReplyAbortedError);
+				return;
+			}
+			// handle error
+			auto error = m_replyRead->error();
+			this->setLastError(error);
+			// let client know if device is still alive
+			client->reportReadResult(error);
+			// isolate unmapped registers instead of retrying same request forever
+			bool needsRepair = QUaModbusDataBlock::isIllegalAddress(m_replyRead) && this->getRepairMode();
+			// update block and modbus values
+			this->updateData(m_replyRead->result().values(), error, receipt->timestamp);
+			QUaModbusTracer::trace(QUaModbusTracer::Done, receipt->traceId);
+			// delete reply on next event loop exec
+			m_replyRead->deleteLater();
+			m_replyRead = nullptr;
+			// NOTE : start repair only after m_replyRead is reset, repair reuses it
+			if (needsRepair)
+			{
+				this->startRepair();
+			}
+			// serve trigger or read-back requested while this read was ongoing
+			if (m_triggerSource || this->getReadBack())
+			{
+				client->m_workerThread.execInThread([this]() {
+					if (!m_readPending || m_replyRead)
+					{
+						return;
+					}
+					m_readPending = false;
+					this->readBlock();
+				});
+			}
+		}, Qt::QueuedConnection);
+}
+
+void QUaModbusDataBlock::triggerRead()
+{
+	// reads are idle while client is not connected or quarantined
+	auto client = this->client();
+	if (client->isPollingSuspended())
+	{
+		return;
+	}
+	// exec read request in client thread
+	client->m_workerThread.execInThread([this]() {
+		// read again once ongoing request finishes
+		if (m_replyRead)
+		{
+			m_readPending = true;
+			return;
+		}
+		this->readBlock();
+	});
+}
+
+void QUaModbusDataBlock::updateTrigger()
+{
+	// NOTE : exec'd in ua server thread
+	if (m_triggerSource)
+	{
+		QObject::disconnect(m_triggerSource, &QUaModbusValue::valueChanged, this, &QUaModbusDataBlock::on_triggerSourceChanged);
+	}
+	m_triggerSource = nullptr;
+	m_triggerLast   = QVariant();
+	if (this->getTriggerMode() != QModbusTriggerMode::Disabled)
+	{
+		m_triggerSource = this->findTriggerSource();
+	}
+	if (m_triggerSource)
+	{
+		m_triggerLast = m_triggerSource->getValue();
+		QObject::connect(m_triggerSource, &QUaModbusValue::valueChanged, this, &QUaModbusDataBlock::on_triggerSourceChanged);
+	}
+	// only stop periodic polling if trigger is actually bound
+	bool triggeredOnly = m_triggerSource && this->getTriggerOnly();
+	this->client()->m_workerThread.execInThread([this, triggeredOnly]() {
+		m_triggeredOnly = triggeredOnly;
+	});
+}
+
+QUaModbusValue * QUaModbusDataBlock::findTriggerSource() const
+{
+	auto parts = this->getTriggerValue().split('/');
+	if (parts.count() > 2 || parts.last().isEmpty())
+	{
+		return nullptr;
+	}
+	// value name alone refers to this block
+	auto block = const_cast<QUaModbusDataBlock*>(this);
+	if (parts.count() == 2)
+	{
+		block = nullptr;
+		for (auto other : this->list()->blocks())
+		{
+			if (other->browseName() == QUaQualifiedName(parts.first()))
+			{
+				block = other;
+				break;
+			}
+		}
+	}
+	if (!block)
+	{
+		return nullptr;
+	}
+	for (auto value : block->values()->values())
+	{
+		if (value->browseName() == QUaQualifiedName(parts.last()))
+		{
+			return value;
+		}
+	}
+	return nullptr;
+}
+
+void QUaModbusDataBlock::publishData(const QVector<quint16>& data, const QModbusError & error, const QDateTime & sourceTimestamp)
+{
+	// NOTE : exec'd in ua server thread, for reads done outside the block loop
+	auto client = this->client();
+	if (client->m_disconnectRequested || client->getState() != QModbusState::ConnectedState)
+	{
+		this->setLastError(QModbusError::ReplyAbortedError);
+		return;
+	}
+	this->setLastError(error);
+	client->reportReadResult(error);
+	this->updateData(data, error, sourceTimestamp);
+}
+
+void QUaModbusDataBlock::updateData(const QVector<quint16>& data, const QModbusError & error, const QDateTime & sourceTimestamp)
+{
+	// update block value
+	// TODO : early exit when refactor QUaModbusValue::setValue
+	if (error == QModbusError::NoError)
+	{
+		this->setData(data, false);
+		if (sourceTimestamp.isValid())
+		{
+			this->data()->setSourceTimestamp(sourceTimestamp);
+		}
+		if (QUaModbusDataBlock::m_changeStatistics)
+		{
+			this->accountChanges(data);
+		}
+	}
+	// update modbus values and errors
+	auto values = this->values()->values();
+	for (auto value : values)
+	{
+		value->setValue(data, error, m_firstSample, sourceTimestamp);
+	}
+	m_firstSample = false;
+}
+
+void QUaModbusDataBlock::startRepair()
+{
+	// exec probes in client thread
+	this->client()->m_workerThread.execInThread([this]() {
+		if (!m_repairEnabled || m_repairing || m_valueCount == 0)
+		{
+			return;
+		}
+		m_repairing = true;
+		m_repairPending.clear();
+		m_validRanges.clear();
+		m_badRanges.clear();
+		// whole block already failed, start by bisecting it
+		int count = static_cast<int>(m_valueCount);
+		if (count == 1)
+		{
+			m_badRanges << QModbusRange(0, 1);
+		}
+		else
+		{
+			m_repairPending << QModbusRange(0, count / 2) << QModbusRange(count / 2, count - count / 2);
+		}
+		this->repairNext();
+	});
+}
+
+void QUaModbusDataBlock::repairNext()
+{
+	// NOTE : exec'd in worker thread
+	if (!m_repairing)
+	{
+		return;
+	}
+	// check if done
+	if (m_repairPending.isEmpty())
+	{
+		// merge contiguous ranges (pending ranges were probed in order)
+		auto mergeRanges = [](const QList<QModbusRange> &ranges) {
+			QList<QModbusRange> merged;
+			for (auto range : ranges)
+			{
+				if (!merged.isEmpty() && merged.last().first + merged.last().second == range.first)
+				{
+					merged.last().second += range.second;
+					continue;
+				}
+				merged << range;
+			}
+			return merged;
+		};
+		m_validRanges = mergeRanges(m_validRanges);
+		m_badRanges   = mergeRanges(m_badRanges);
+		m_repairing   = false;
+		emit this->updateRepairLayout(this->repairLayoutToString(), this->repairRangeSizes());
+		return;
+	}
+	// abort if not possible to probe, retry on next read failure
+	auto client = this->client();
+	if (client->getState() != QModbusState::ConnectedState)
+	{
+		this->clearRepair();
+		return;
+	}
+	auto range = m_repairPending.first();
+	m_replyRead = client->sendReadRequest(
+		QModbusDataUnit(
+			static_cast<QModbusDataUnit::RegisterType>(m_registerType),
+			m_startAddress + range.first,
+			static_cast<quint16>(range.second)
+		)
+		, client->getServerAddress()
+	);
+	if (!m_replyRead)
+	{
+		this->clearRepair();
+		return;
+	}
+	if (m_replyRead->isFinished())
+	{
+		m_replyRead->deleteLater();
+		m_replyRead = nullptr;
+		this->clearRepair();
+		return;
+	}
+	auto reply = m_replyRead;
+	// NOTE : reply as context so it is handled in worker thread
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[this, reply, range]() {
+		m_replyRead = nullptr;
+		reply->deleteLater();
+		// check if repair was cancelled meanwhile
+		if (!m_repairing)
+		{
+			return;
+		}
+		m_repairPending.removeFirst();
+		auto error = reply->error();
+		if (error == QModbusError::NoError)
+		{
+			m_validRanges << range;
+		}
+		else if (QUaModbusDataBlock::isIllegalAddress(reply))
+		{
+			// single register found, else keep bisecting (depth first keeps order)
+			if (range.second == 1)
+			{
+				m_badRanges << range;
+			}
+			else
+			{
+				int half = range.second / 2;
+				m_repairPending.prepend(QModbusRange(range.first + half, range.second - half));
+				m_repairPending.prepend(QModbusRange(range.first, half));
+			}
+		}
+		else
+		{
+			// any other error makes the result unreliable, retry later
+			this->clearRepair();
+			return;
+		}
+		this->repairNext();
+	});
+}
+
+void QUaModbusDataBlock::clearRepair()
+{
+	// NOTE : exec'd in worker thread
+	m_repairing = false;
+	m_repairPending.clear();
+	m_validRanges.clear();
+	m_badRanges.clear();
+	emit this->updateRepairLayout(QString(), QVector<int>());
+}
+
+void QUaModbusDataBlock::readValidRanges(const int & rangeIndex, QVector<quint16> data, const QDateTime & sourceTimestamp)
+{
+	// NOTE : exec'd in worker thread
+	if (rangeIndex >= m_validRanges.count())
+	{
+		emit this->repairedDataRead(data, this->badOffsets(), QModbusError::NoError,
+			sourceTimestamp.isValid() ? sourceTimestamp : QDateTime::currentDateTimeUtc());
+		return;
+	}
+	auto client = this->client();
+	if (client->getState() != QModbusState::ConnectedState)
+	{
+		return;
+	}
+	auto range = m_validRanges.at(rangeIndex);
+	this->accountPoll(rangeIndex == 0);
+	QElapsedTimer sent;
+	sent.start();
+	m_replyRead = client->sendReadRequest(
+		QModbusDataUnit(
+			static_cast<QModbusDataUnit::RegisterType>(m_registerType),
+			m_startAddress + range.first,
+			static_cast<quint16>(range.second)
+		)
+		, client->getServerAddress()
+	);
+	if (!m_replyRead)
+	{
+		if (!client->m_disconnectRequested)
+		{
+			emit this->updateLastError(QModbusError::ReplyAbortedError);
+		}
+		return;
+	}
+	auto reply = m_replyRead;
+	auto handleReply = [this, reply, range, rangeIndex, data, sent]() mutable {
+		auto timestamp = QDateTime::currentDateTimeUtc();
+		m_replyRead = nullptr;
+		reply->deleteLater();
+		this->accountReply(reply, sent.nsecsElapsed());
+		auto error = reply->error();
+		if (error != QModbusError::NoError)
+		{
+			// layout does not match device anymore, next full read starts a new repair
+			if (QUaModbusDataBlock::isIllegalAddress(reply))
+			{
+				this->clearRepair();
+			}
+			emit this->repairedDataRead(data, this->badOffsets(), error, timestamp);
+			return;
+		}
+		auto values = reply->result().values();
+		for (int i = 0; i < values.count() && range.first + i < data.count(); i++)
+		{
+			data[range.first + i] = values.at(i);
+		}
+		this->readValidRanges(rangeIndex + 1, data, timestamp);
+	};
+	// NOTE : reply that finished immediately (e.g. local error) still reports this poll
+	if (reply->isFinished())
+	{
+		handleReply();
+		return;
+	}
+	// NOTE : reply as context so it is handled in worker thread
+	QObject::connect(reply, &QModbusReply::finished, reply, handleReply);
+}
+
+QSharedPointer<QUaModbusDataBlock::QUaModbusReceipt> QUaModbusDataBlock::stampOnFinished(QModbusReply * reply)
+{
+	// NOTE : reply as context so it is stamped in worker thread, connected before
+	//        any queued handler so the stamp is set by the time the handler runs
+	auto receipt = QSharedPointer<QUaModbusReceipt>::create();
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[receipt]() {
+		receipt->timestamp = QDateTime::currentDateTimeUtc();
+		receipt->elapsed.start();
+		QUaModbusTracer::trace(QUaModbusTracer::Reply, receipt->traceId);
+	});
+	return receipt;
+}
+
+void QUaModbusDataBlock::traceOnFinished(QModbusReply * reply, const quint64 & traceId)
+{
+	// NOTE : reply as context so it is traced in worker thread
+	if (traceId == 0)
+	{
+		return;
+	}
+	QObject::connect(reply, &QModbusReply::finished, reply,
+	[traceId]() {
+		QUaModbusTracer::trace(QUaModbusTracer::Reply, traceId);
+	});
+}
+
+void QUaModbusDataBlock::accountPoll(const bool & newPoll/* = true*/)
+{
+	// NOTE : exec'd in worker thread
+	if (!m_diagPublishTimer.isValid())
+	{
+		m_diagPublishTimer.start();
+	}
+	// time between polls, further requests of the same poll (repaired ranges) only add bytes
+	if (newPoll)
+	{
+		if (m_diagPollTimer.isValid())
+		{
+			double interval = m_diagPollTimer.nsecsElapsed() / 1000000.0;
+			m_diagPolls++;
+			m_diagIntervalSum   += interval;
+			m_diagIntervalSumSq += interval * interval;
+		}
+		m_diagPollTimer.start();
+	}
+	// request PDU : function code, address, count
+	m_diagSample.bytesTransferred += 5;
+}
+
+void QUaModbusDataBlock::accountReply(QModbusReply * reply, const qint64 & latency)
+{
+	// NOTE : exec'd in worker thread
+	auto error = reply->error();
+	if (error == QModbusError::TimeoutError)
+	{
+		m_diagSample.timeouts++;
+	}
+	else
+	{
+		m_diagLatency.add(latency);
+		// response PDU : function code, byte count and data (or exception code)
+		auto count = reply->result().valueCount();
+		m_diagSample.bytesTransferred += 2 + (error != QModbusError::NoError ? 0 :
+			m_registerType == QModbusDataBlockType::Coils || m_registerType == QModbusDataBlockType::DiscreteInputs ?
+			(count + 7) / 8 : count * 2);
+	}
+	// publish at low rate
+	if (m_diagPublishTimer.elapsed() < static_cast<qint64>(QUaModbusDataBlock::m_diagnosticsPeriod))
+	{
+		return;
+	}
+	m_diagPublishTimer.start();
+	if (m_diagPolls > 0)
+	{
+		double mean = m_diagIntervalSum / m_diagPolls;
+		m_diagSample.cycleTime = mean;
+		m_diagSample.jitter    = std::sqrt(qMax(m_diagIntervalSumSq / m_diagPolls - mean * mean, 0.0));
+	}
+	if (m_diagLatency.count() > 0)
+	{
+		m_diagSample.latencyP50 = m_diagLatency.percentile(50.0);
+		m_diagSample.latencyP95 = m_diagLatency.percentile(95.0);
+		m_diagSample.latencyP99 = m_diagLatency.percentile(99.0);
+	}
+	// cycle and latency over last period only, counters are totals
+	m_diagPolls         = 0;
+	m_diagIntervalSum   = 0.0;
+	m_diagIntervalSumSq = 0.0;
+	m_diagLatency.reset();
+	emit this->updateDiagnostics(m_diagSample);
+}
+
+QVector<int> QUaModbusDataBlock::badOffsets() const
+{
+	QVector<int> offsets;
+	for (auto range : m_badRanges)
+	{
+		for (int i = 0; i < range.second; i++)
+		{
+			offsets << range.first + i;
+		}
+	}
+	return offsets;
+}
+
+QString QUaModbusDataBlock::repairLayoutToString() const
+{
+	auto rangesToString = [this](const QList<QModbusRange> &ranges) {
+		QStringList listRanges;
+		for (auto range : ranges)
+		{
+			int first = m_startAddress + range.first;
+			int last  = first + range.second - 1;
+			listRanges << (first == last ? QString::number(first) : QString("%1-%2").arg(first).arg(last));
+		}
+		return listRanges.join(", ");
+	};
+	return tr("Read %1; Bad %2").arg(rangesToString(m_validRanges)).arg(rangesToString(m_badRanges));
+}
+
+QVector<int> QUaModbusDataBlock::repairRangeSizes() const
+{
+	QVector<int> sizes;
+	for (auto range : m_validRanges)
+	{
+		sizes << range.second;
+	}
+	return sizes;
+}
+
+bool QUaModbusDataBlock::isIllegalAddress(QModbusReply * reply)
+{
+	if (!reply || reply->error() != QModbusError::ProtocolError)
+	{
+		return false;
+	}
+	return reply->rawResult().exceptionCode() == QModbusPdu::IllegalDataAddress;
+}
+
+void QUaModbusDataBlock::stopLoop()
+{
+	// invalidate pending delayed start
+	m_loopRequest++;
+	m_loopPending = false;
+	m_loopSuspended = false;
+	if (m_loopHandle > 0)
+	{
+		this->client()->m_workerThread.stopLoopInThread(m_loopHandle);
+	}
+	// make handle invalid **after** stopping loop in thread
+	m_loopHandle = -1;
+}
+
+void QUaModbusDataBlock::suspendLoop(const QModbusError & error)
+{
+	// NOTE : exec'd in ua server thread
+	if (m_loopSuspended)
+	{
+		return;
+	}
+	this->stopLoop();
+	m_loopSuspended = true;
+	// force update last modbus value once, instead of on every loop wakeup
+	if (!m_firstSample)
+	{
+		auto values = this->values()->values();
+		for (auto value : values)
+		{
+			emit value->valueChanged(value->getValue());
+		}
+		m_firstSample = true;
+	}
+	this->setLastError(this->isWellConfigured() ? error : QModbusError::ConfigurationError);
+}
+
+void QUaModbusDataBlock::resumeLoop()
+{
+	if (!m_loopSuspended)
+	{
+		return;
+	}
+	m_loopSuspended = false;
+	this->startLoop();
+	// trigger source might have been created after this block, read once to start with current data
+	this->updateTrigger();
+	if (m_triggerSource)
+	{
+		this->triggerRead();
+	}
+}
+
+bool QUaModbusDataBlock::loopRunning()
+{
+	return m_loopHandle >= 0 || m_loopPending || m_loopSuspended;
+}
+
+quint32 QUaModbusDataBlock::loopPhase(const int & blockIndex, const quint32 & samplingTime)
+{
+	if (blockIndex <= 0)
+	{
+		return 0;
+	}
+	// golden ratio sequence, evenly spread for any number of blocks
+	double frac = std::fmod(static_cast<double>(blockIndex) * 0.6180339887498949, 1.0);
+	return static_cast<quint32>(frac * samplingTime);
+}
+
+void QUaModbusDataBlock::setModbusData(const QVector<quint16>& data)
+{
+	quint64 traceId = QUaModbusTracer::newId();
+	QUaModbusTracer::trace(QUaModbusTracer::Enqueue, traceId);
+	// exec write request in client thread
+	this->client()->m_workerThread.execInThread(
+	[this, data, traceId]() {
+		QUaModbusTaskScope taskScope("QUaModbusDataBlock::setModbusData");
+		auto client = this->client();
+		// check if request is valid
+		if (m_registerType != QModbusDataBlockType::Coils &&
+			m_registerType != QModbusDataBlockType::HoldingRegisters)
+		{
+			return;
+		}
+		if (m_startAddress < 0)
+		{
+			emit this->updateLastError(QModbusError::ConfigurationError);
+			return;
+		}
+		if (m_valueCount == 0)
+		{
+			emit this->updateLastError(QModbusError::ConfigurationError);
+			return;
+		}
+		// check if connected
+		auto state = client->getState();
+		if (state != QModbusState::ConnectedState)
+		{
+			auto clientError = client->getLastError();
+			emit this->updateLastError(clientError);
+			return;
+		}
+		// create data target 
+		QModbusDataUnit dataToWrite(
+			static_cast<QModbusDataUnit::RegisterType>(m_registerType), 
+			m_startAddress, 
+			data
+		);
+		// create and send request
+		auto serverAddress = this->writeServerAddress();
+		QUaModbusTracer::trace(QUaModbusTracer::Send, traceId);
+		QModbusReply * p_reply = client->sendWriteRequest(dataToWrite, serverAddress);
+		if (!p_reply)
+		{
+			emit this->updateLastError(QModbusError::ReplyAbortedError);
+			return;
+		}
+		QUaModbusDataBlock::traceOnFinished(p_reply, traceId);
+		// subscribe to finished
+		this->onWriteFinished(p_reply, serverAddress, this,
+		[this, traceId](QModbusError error) {
+			// NOTE : exec'd in ua server thread (not in worker thread)
+			QUaModbusTracer::trace(QUaModbusTracer::Dispatch, traceId);
+			QUaModbusTaskScope taskScope("QUaModbusDataBlock::setModbusData reply");
+			// handle error
+			this->setLastError(error);
+			QUaModbusTracer::trace(QUaModbusTracer::Done, traceId);
+			// confirm device state without waiting for next poll
+			if (error == QModbusError::NoError && this->getReadBack())
+			{
+				this->triggerRead();
+			}
+		});
+	});
+}
+
+void QUaModbusDataBlock::onWriteFinished(
+	QModbusReply * reply,
+	const quint8 &serverAddress,
+	QObject * context,
+	const std::function<void(const QModbusError &)> &handler
+)
+{
+	// NOTE : exec'd in worker thread
+	auto client = this->client();
+	// tcp client waits for a response that never comes for broadcasts, do not wait for it
+	bool fireAndForget = serverAddress == 0 &&
+		qobject_cast<QModbusTcpClient*>(client->m_modbusClient.data()) != nullptr;
+	if (fireAndForget || reply->isFinished())
+	{
+		auto error = fireAndForget ? QModbusError::NoError : reply->error();
+		reply->deleteLater();
+		QTimer::singleShot(0, context,
+		[handler, error]() {
+			handler(error);
+		});
+		return;
+	}
+	QObject::connect(reply, &QModbusReply::finished, context,
+	[reply, handler]() {
+		auto error = reply->error();
+		// delete reply on next event loop exec
+		reply->deleteLater();
+		handler(error);
+	}, Qt::QueuedConnection);
+}
+
+quint8 QUaModbusDataBlock::writeServerAddress() const
+{
+	// NOTE : exec'd in worker thread
+	return m_isBroadcast ? 0 : this->client()->getServerAddress();
 }
 
 QDomElement QUaModbusDataBlock::toDomElement(QDomDocument & domDoc) const
@@ -522,6 +1776,13 @@ QDomElement QUaModbusDataBlock::toDomElement(QDomDocument & domDoc) const
 	elemBlock.setAttribute("Address"     , getAddress());
 	elemBlock.setAttribute("Size"        , getSize());
 	elemBlock.setAttribute("SamplingTime", getSamplingTime());
+	elemBlock.setAttribute("RepairMode"  , getRepairMode());
+	elemBlock.setAttribute("ScanGroup"   , getScanGroup());
+	elemBlock.setAttribute("TriggerValue", getTriggerValue());
+	elemBlock.setAttribute("TriggerMode" , QMetaEnum::fromType<QModbusTriggerMode>().valueToKey(getTriggerMode()));
+	elemBlock.setAttribute("TriggerOnly" , getTriggerOnly());
+	elemBlock.setAttribute("ReadBack"    , getReadBack());
+	elemBlock.setAttribute("Broadcast"   , getBroadcast());
 	// add value list element
 	auto elemValueList = const_cast<QUaModbusDataBlock*>(this)->values()->toDomElement(domDoc);
 	elemBlock.appendChild(elemValueList);
@@ -609,6 +1870,113 @@ void QUaModbusDataBlock::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 			QUaLogCategory::Serialization
 		);
 	}
+	// RepairMode (optional)
+	if (domElem.hasAttribute("RepairMode"))
+	{
+		auto repairMode = (bool)domElem.attribute("RepairMode").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setRepairMode(repairMode);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid RepairMode attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("RepairMode")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// ScanGroup (optional)
+	if (domElem.hasAttribute("ScanGroup"))
+	{
+		auto scanGroup = (bool)domElem.attribute("ScanGroup").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setScanGroup(scanGroup);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid ScanGroup attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("ScanGroup")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// TriggerValue (optional)
+	if (domElem.hasAttribute("TriggerValue"))
+	{
+		this->setTriggerValue(domElem.attribute("TriggerValue"));
+	}
+	// TriggerMode (optional)
+	if (domElem.hasAttribute("TriggerMode"))
+	{
+		auto triggerMode = QMetaEnum::fromType<QModbusTriggerMode>().keysToValue(domElem.attribute("TriggerMode").toUtf8(), &bOK);
+		if (bOK)
+		{
+			this->setTriggerMode(static_cast<QModbusTriggerMode>(triggerMode));
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid TriggerMode attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("TriggerMode")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// TriggerOnly (optional)
+	if (domElem.hasAttribute("TriggerOnly"))
+	{
+		auto triggerOnly = (bool)domElem.attribute("TriggerOnly").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setTriggerOnly(triggerOnly);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid TriggerOnly attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("TriggerOnly")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// ReadBack (optional)
+	if (domElem.hasAttribute("ReadBack"))
+	{
+		auto readBack = (bool)domElem.attribute("ReadBack").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setReadBack(readBack);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid ReadBack attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("ReadBack")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// Broadcast (optional)
+	if (domElem.hasAttribute("Broadcast"))
+	{
+		auto broadcast = (bool)domElem.attribute("Broadcast").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setBroadcast(broadcast);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Broadcast attribute '%1' in Block %2. Default value set.").arg(domElem.attribute("Broadcast")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 	// get value list
 	QDomElement elemValueList = domElem.firstChildElement(QUaModbusValueList::staticMetaObject.className());
 	if (!elemValueList.isNull())
@@ -687,6 +2055,93 @@ void QUaModbusDataBlock::setSamplingTime(const quint32 & samplingTime)
 	this->on_samplingTimeChanged(samplingTime, true);
 }
 
+bool QUaModbusDataBlock::getRepairMode() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->repairMode()->value().toBool();
+}
+
+void QUaModbusDataBlock::setRepairMode(const bool & repairMode)
+{
+	this->repairMode()->setValue(repairMode);
+	this->on_repairModeChanged(repairMode, true);
+}
+
+bool QUaModbusDataBlock::getScanGroup() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->scanGroup()->value().toBool();
+}
+
+void QUaModbusDataBlock::setScanGroup(const bool & scanGroup)
+{
+	this->scanGroup()->setValue(scanGroup);
+	this->on_scanGroupChanged(scanGroup, true);
+}
+
+QString QUaModbusDataBlock::getTriggerValue() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->triggerValue()->value().toString();
+}
+
+void QUaModbusDataBlock::setTriggerValue(const QString & strTriggerValue)
+{
+	this->triggerValue()->setValue(strTriggerValue);
+	this->on_triggerValueChanged(strTriggerValue, true);
+}
+
+QModbusTriggerMode QUaModbusDataBlock::getTriggerMode() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->triggerMode()->value().value<QModbusTriggerMode>();
+}
+
+void QUaModbusDataBlock::setTriggerMode(const QModbusTriggerMode & triggerMode)
+{
+	this->triggerMode()->setValue(triggerMode);
+	this->on_triggerModeChanged(triggerMode, true);
+}
+
+bool QUaModbusDataBlock::getTriggerOnly() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->triggerOnly()->value().toBool();
+}
+
+void QUaModbusDataBlock::setTriggerOnly(const bool & triggerOnly)
+{
+	this->triggerOnly()->setValue(triggerOnly);
+	this->on_triggerOnlyChanged(triggerOnly, true);
+}
+
+bool QUaModbusDataBlock::getReadBack() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->readBack()->value().toBool();
+}
+
+void QUaModbusDataBlock::setReadBack(const bool & readBack)
+{
+	this->readBack()->setValue(readBack);
+	this->on_readBackChanged(readBack, true);
+}
+
+bool QUaModbusDataBlock::getBroadcast() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->broadcast()->value().toBool();
+}
+
+void QUaModbusDataBlock::setBroadcast(const bool & broadcast)
+{
+	this->broadcast()->setValue(broadcast);
+	this->on_broadcastChanged(broadcast, true);
+}
+
+QString QUaModbusDataBlock::getRepairLayout() const
+{
+	return const_cast<QUaModbusDataBlock*>(this)->repairLayout()->value().toString();
+}
+
+QVector<int> QUaModbusDataBlock::getRepairRanges() const
+{
+	return m_repairRanges;
+}
+
 QVector<quint16> QUaModbusDataBlock::getData() const
 {
 	return QUaModbusDataBlock::variantToInt16Vect(const_cast<QUaModbusDataBlock*>(this)->data()->value());
@@ -719,6 +2174,64 @@ void QUaModbusDataBlock::setLastError(const QModbusError & error)
 	emit this->updateLastError(error);
 }
 
+double QUaModbusDataBlock::getQueueDelay() const
+{
+	return m_queueDelay;
+}
+
+double QUaModbusDataBlock::getQueueDelayMax() const
+{
+	return m_queueDelayMax;
+}
+
+bool QUaModbusDataBlock::isChangeStatisticsEnabled()
+{
+	return QUaModbusDataBlock::m_changeStatistics;
+}
+
+void QUaModbusDataBlock::setChangeStatisticsEnabled(const bool & enabled)
+{
+	QUaModbusDataBlock::m_changeStatistics = enabled;
+}
+
+void QUaModbusDataBlock::resetChangeStatistics()
+{
+	m_changeLast.clear();
+	m_changeCounts.clear();
+	m_changeSamples = 0;
+}
+
+QVector<quint32> QUaModbusDataBlock::getChangeCounts() const
+{
+	return m_changeCounts;
+}
+
+quint32 QUaModbusDataBlock::getChangeSamples() const
+{
+	return m_changeSamples;
+}
+
+void QUaModbusDataBlock::accountChanges(const QVector<quint16>& data)
+{
+	// first read or layout changed, restart window
+	if (m_changeLast.count() != data.count())
+	{
+		m_changeLast    = data;
+		m_changeCounts  = QVector<quint32>(data.count(), 0);
+		m_changeSamples = 0;
+		return;
+	}
+	for (int i = 0; i < data.count(); i++)
+	{
+		if (data.at(i) != m_changeLast.at(i))
+		{
+			m_changeCounts[i]++;
+		}
+	}
+	m_changeLast = data;
+	m_changeSamples++;
+}
+
 bool QUaModbusDataBlock::isWellConfigured() const
 {
 	if (
@@ -3,6 +3,12 @@
 
 #include <QModbusDataUnit>
 #include <QModbusReply>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QPointer>
+#include <QMap>
+#include <functional>
 
 #ifndef QUA_ACCESS_CONTROL
 #include <QUaBaseObject>
@@ -18,6 +24,7 @@ class QUaModbusDataBlockList;
 class QUaModbusValue;
 
 #include "quamodbusvaluelist.h"
+#include "quamodbusdatablockdiagnostics.h"
 
 typedef QModbusDevice::State QModbusState;
 typedef QModbusDevice::Error QModbusError;
@@ -30,6 +37,7 @@ class QUaModbusDataBlock : public QUaBaseObjectProtected
 {
 	friend class QUaModbusDataBlockList;
 	friend class QUaModbusValue;
+	friend class QUaModbusClient;
 
     Q_OBJECT
 
@@ -38,13 +46,22 @@ class QUaModbusDataBlock : public QUaBaseObjectProtected
 	Q_PROPERTY(QUaProperty * Address      READ address     )
 	Q_PROPERTY(QUaProperty * Size         READ size        )
 	Q_PROPERTY(QUaProperty * SamplingTime READ samplingTime)
+	Q_PROPERTY(QUaProperty * RepairMode   READ repairMode  )
+	Q_PROPERTY(QUaProperty * ScanGroup    READ scanGroup   )
+	Q_PROPERTY(QUaProperty * TriggerValue READ triggerValue)
+	Q_PROPERTY(QUaProperty * TriggerMode  READ triggerMode )
+	Q_PROPERTY(QUaProperty * TriggerOnly  READ triggerOnly )
+	Q_PROPERTY(QUaProperty * ReadBack     READ readBack    )
+	Q_PROPERTY(QUaProperty * Broadcast    READ broadcast   )
 
 	// UA variables
 	Q_PROPERTY(QUaBaseDataVariable * Data      READ data     )
 	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
+	Q_PROPERTY(QUaBaseDataVariable * RepairLayout READ repairLayout)
 
 	// UA objects
 	Q_PROPERTY(QUaModbusValueList * Values READ values)
+	Q_PROPERTY(QUaModbusDataBlockDiagnostics * Diagnostics READ diagnostics)
 
 public:
 	Q_INVOKABLE explicit QUaModbusDataBlock(QUaServer *server);
@@ -62,21 +79,41 @@ public:
 	Q_ENUM(RegisterType)
 	typedef QUaModbusDataBlock::RegisterType QModbusDataBlockType;
 
+	// when a change of the trigger value schedules a read of the block
+	enum TriggerMode
+	{
+		Disabled    = 0,
+		Change      = 1,
+		RisingEdge  = 2,
+		FallingEdge = 3
+	};
+	Q_ENUM(TriggerMode)
+	typedef QUaModbusDataBlock::TriggerMode QModbusTriggerMode;
+
 	// UA properties
 
 	QUaProperty * type        ();
 	QUaProperty * address     ();
 	QUaProperty * size        ();
 	QUaProperty * samplingTime();
+	QUaProperty * repairMode  ();
+	QUaProperty * scanGroup   ();
+	QUaProperty * triggerValue();
+	QUaProperty * triggerMode ();
+	QUaProperty * triggerOnly ();
+	QUaProperty * readBack    ();
+	QUaProperty * broadcast   ();
 
 	// UA variables
 
 	QUaBaseDataVariable * data();
 	QUaBaseDataVariable * lastError();
+	QUaBaseDataVariable * repairLayout();
 
 	// UA objects
 
 	QUaModbusValueList * values();
+	QUaModbusDataBlockDiagnostics * diagnostics();
 
 	// UA methods
 
@@ -96,6 +133,40 @@ public:
 	quint32 getSamplingTime() const;
 	void    setSamplingTime(const quint32 &samplingTime);
 
+	// isolate unmapped registers when device replies Illegal Data Address
+	bool getRepairMode() const;
+	void setRepairMode(const bool &repairMode);
+
+	QString getRepairLayout() const;
+	// register count of each range read per poll while repaired, one request each
+	QVector<int> getRepairRanges() const;
+
+	// read as part of the client scan cycle instead of own polling loop
+	bool getScanGroup() const;
+	void setScanGroup(const bool &scanGroup);
+
+	// value that triggers a read, as "ValueName" (same block) or "BlockName/ValueName"
+	QString getTriggerValue() const;
+	void    setTriggerValue(const QString &strTriggerValue);
+
+	QModbusTriggerMode getTriggerMode() const;
+	void               setTriggerMode(const QModbusTriggerMode &triggerMode);
+
+	// only read when triggered, periodic polling is off while trigger is bound
+	bool getTriggerOnly() const;
+	void setTriggerOnly(const bool &triggerOnly);
+
+	// read block as soon as a write to it succeeds, to confirm device state
+	bool getReadBack() const;
+	void setReadBack(const bool &readBack);
+
+	// write to all devices on the bus (server address 0), block is never read
+	bool getBroadcast() const;
+	void setBroadcast(const bool &broadcast);
+
+	// schedule an immediate read of the block (merged with an ongoing read)
+	void triggerRead();
+
 	QVector<quint16> getData() const;
 	void             setData(const QVector<quint16> &data, const bool &writeModbus = true);
 
@@ -104,21 +175,53 @@ public:
 
 	bool isWellConfigured() const;
 
+	// time (ms) last read reply waited from receipt in worker thread until handled in ua server thread
+	double getQueueDelay() const;
+	double getQueueDelayMax() const;
+
+	// per register change counts of successful reads, collected while enabled (ua server thread)
+	static bool      isChangeStatisticsEnabled();
+	static void      setChangeStatisticsEnabled(const bool &enabled);
+	void             resetChangeStatistics();
+	QVector<quint32> getChangeCounts() const;
+	// reads compared since reset
+	quint32          getChangeSamples() const;
+
 	QUaModbusDataBlockList * list() const;
 
 	QUaModbusClient * client() const;
 
+	// approximate memory owned by this block, excluding its values (call in ua server thread)
+	QUaModbusMemoryUsage memoryUsage() const;
+
 signals:
 	// C++ API
 	void typeChanged        (const QModbusDataBlockType &type        );
 	void addressChanged     (const int                  &address     );
 	void sizeChanged        (const quint32              &size        );
 	void samplingTimeChanged(const quint32              &samplingTime);
+	void repairModeChanged  (const bool                 &repairMode  );
+	void repairLayoutChanged(const QString              &repairLayout);
+	void scanGroupChanged   (const bool                 &scanGroup   );
+	void triggerValueChanged(const QString              &strTriggerValue);
+	void triggerModeChanged (const QModbusTriggerMode   &triggerMode );
+	void triggerOnlyChanged (const bool                 &triggerOnly );
+	void readBackChanged    (const bool                 &readBack    );
+	void broadcastChanged   (const bool                 &broadcast   );
 	void dataChanged        (const QVector<quint16>     &data        );
 	void lastErrorChanged   (const QModbusError         &error       );
 
 	// (internal) to safely update error in ua server thread
 	void updateLastError(const QModbusError &error);
+	// (internal) to safely update repair results in ua server thread
+	void updateRepairLayout(const QString &repairLayout, const QVector<int> &repairRanges);
+	void repairedDataRead(const QVector<quint16> &data, const QVector<int> &badOffsets, const QModbusError &error, const QDateTime &sourceTimestamp);
+	// (internal) to safely publish poll statistics in ua server thread
+	void updateDiagnostics(const QUaModbusDiagnosticsSample &sample);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	// (internal) used by cyclic write loops in thread
+	void cyclicWrite(const quint32 &period);
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 	void aboutToDestroy();
 
 private slots:
@@ -128,37 +231,146 @@ private slots:
 	void on_sizeChanged        (const QVariant     &value, const bool &networkChange);
 	void on_samplingTimeChanged(const QVariant     &value, const bool &networkChange);
 	void on_dataChanged        (const QVariant     &value, const bool &networkChange);
+	void on_repairModeChanged  (const QVariant     &value, const bool &networkChange);
+	void on_scanGroupChanged   (const QVariant     &value, const bool &networkChange);
+	void on_triggerValueChanged(const QVariant     &value, const bool &networkChange);
+	void on_triggerModeChanged (const QVariant     &value, const bool &networkChange);
+	void on_triggerOnlyChanged (const QVariant     &value, const bool &networkChange);
+	void on_readBackChanged    (const QVariant     &value, const bool &networkChange);
+	void on_broadcastChanged   (const QVariant     &value, const bool &networkChange);
+	void on_triggerSourceChanged(const QVariant    &value);
 	void on_updateLastError    (const QModbusError &error);
+	void on_updateRepairLayout (const QString      &repairLayout, const QVector<int> &repairRanges);
+	void on_repairedDataRead   (const QVector<quint16> &data, const QVector<int> &badOffsets, const QModbusError &error, const QDateTime &sourceTimestamp);
+	void on_updateDiagnostics  (const QUaModbusDiagnosticsSample &sample);
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	// write all values due in this period with the fewest requests
+	void on_cyclicWrite        (const quint32 &period);
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
 
 private:
 	int  m_loopHandle;
+	bool m_loopPending;
+	bool m_loopSuspended;
+	quint32 m_loopRequest;
 	bool m_firstSample;
 	QModbusReply  * m_replyRead;
+	// reply receipt, stamped in worker thread when reply finishes
+	struct QUaModbusReceipt
+	{
+		QDateTime     timestamp; // wall clock, used as source timestamp
+		QElapsedTimer elapsed;   // monotonic, measures queueing delay
+		quint64       traceId = 0;
+	};
+	double m_queueDelay;
+	double m_queueDelayMax;
+	static QSharedPointer<QUaModbusReceipt> stampOnFinished(QModbusReply * reply);
+	static void traceOnFinished(QModbusReply * reply, const quint64 &traceId);
+	// call handler in context thread once write reply finishes, then delete reply
+	// NOTE : exec'd in worker thread, tcp broadcasts are never answered so they succeed once sent
+	void onWriteFinished(QModbusReply * reply, const quint8 &serverAddress, QObject * context, const std::function<void(const QModbusError &)> &handler);
 	// NOTE : only modify and access in thread
 	QModbusDataBlockType m_registerType;
 	int                  m_startAddress;
 	quint32              m_valueCount;
+	// block repair (only modify and access in thread)
+	typedef QPair<int, int> QModbusRange; // offset, count
+	bool                 m_repairEnabled;
+	bool                 m_repairing;
+	QList<QModbusRange>  m_repairPending;
+	QList<QModbusRange>  m_validRanges;
+	QList<QModbusRange>  m_badRanges;
+	bool                 m_inScanGroup;
+	bool                 m_isBroadcast;
+	quint8 writeServerAddress() const;
+	// triggered reads (source and last value only accessed in ua server thread)
+	QPointer<QUaModbusValue> m_triggerSource;
+	QVariant             m_triggerLast;
+	bool                 m_triggeredOnly;
+	// read requested while another was ongoing (triggers and read-back)
+	bool                 m_readPending;
+
+	void updateTrigger();
+	QUaModbusValue * findTriggerSource() const;
+
+	// poll statistics (only modify and access in thread)
+	QElapsedTimer             m_diagPollTimer;
+	QElapsedTimer             m_diagPublishTimer;
+	quint32                   m_diagPolls;
+	double                    m_diagIntervalSum;
+	double                    m_diagIntervalSumSq;
+	QUaModbusLatencyHistogram m_diagLatency;
+	QUaModbusDiagnosticsSample m_diagSample;
+	void accountPoll(const bool &newPoll = true);
+	void accountReply(QModbusReply * reply, const qint64 &latency);
+	static quint32 m_diagnosticsPeriod;
+
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	// one loop per cyclic write period in use by values (period, loop handle)
+	QMap<quint32, int> m_cyclicLoops;
+	void updateCyclicWrites();
+	void stopCyclicWrites();
+	void writeCyclicRun(const int &offset, const QVector<quint16> &data, const QList<QPair<QPointer<QUaModbusValue>, QVariant>> &written);
+	static int m_maxWriteRegisters;
+	static int m_maxWriteCoils;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+
+	void startRepair();
+	void repairNext();
+	void clearRepair();
+	void readValidRanges(const int &rangeIndex, QVector<quint16> data, const QDateTime &sourceTimestamp = QDateTime());
+	QVector<int> badOffsets() const;
+	QString repairLayoutToString() const;
+	QVector<int> repairRangeSizes() const;
+	// valid range sizes of current layout (only modify and access in ua server thread)
+	QVector<int> m_repairRanges;
+	static bool isIllegalAddress(QModbusReply * reply);
 
 	void startLoop();
+	void startLoopNow(const quint32 &samplingTime);
+	void readBlock();
+	void stopLoop();
+	void suspendLoop(const QModbusError &error);
+	void resumeLoop();
 	bool loopRunning();
 	void setModbusData(const QVector<quint16>& data);
+	void publishData(const QVector<quint16>& data, const QModbusError &error, const QDateTime &sourceTimestamp = QDateTime());
+	void updateData (const QVector<quint16>& data, const QModbusError &error, const QDateTime &sourceTimestamp = QDateTime());
 
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
 
 	static quint32 m_minSamplingTime;
+
+	// register change statistics (only modify and access in ua server thread)
+	QVector<quint16> m_changeLast;
+	QVector<quint32> m_changeCounts;
+	quint32          m_changeSamples;
+	void accountChanges(const QVector<quint16> &data);
+	static bool m_changeStatistics;
 	static QVector<quint16> variantToInt16Vect(const QVariant &value);
+	static quint32 loopPhase(const int &blockIndex, const quint32 &samplingTime);
 
 	QUaProperty* m_type;
 	QUaProperty* m_address;
 	QUaProperty* m_size;
 	QUaProperty* m_samplingTime;
+	QUaProperty* m_repairMode;
+	QUaProperty* m_scanGroup;
+	QUaProperty* m_triggerValue;
+	QUaProperty* m_triggerMode;
+	QUaProperty* m_triggerOnly;
+	QUaProperty* m_readBack;
+	QUaProperty* m_broadcast;
 	QUaBaseDataVariable* m_data;
 	QUaBaseDataVariable* m_lastError;
+	QUaBaseDataVariable* m_repairLayout;
 	QUaModbusValueList* m_values;
+	QUaModbusDataBlockDiagnostics* m_diagnostics;
 };
 
 typedef QUaModbusDataBlock::RegisterType QModbusDataBlockType;
+typedef QUaModbusDataBlock::TriggerMode  QModbusTriggerMode;
 
 #endif // QUAMODBUSDATABLOCK_H
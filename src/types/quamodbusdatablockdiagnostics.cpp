@@ -0,0 +1,197 @@
+#include "quamodbusdatablockdiagnostics.h"
+#include "quamodbusdatablock.h"
+
+#include <cmath>
+
+QUaModbusLatencyHistogram::QUaModbusLatencyHistogram()
+{
+	m_bins.fill(0, QUaModbusLatencyHistogram::m_binCount);
+	m_count = 0;
+}
+
+void QUaModbusLatencyHistogram::add(const qint64 & nsecs)
+{
+	// bin index is log2 of microseconds times bins per octave
+	double usecs = qMax(nsecs, static_cast<qint64>(0)) / 1000.0;
+	int index = static_cast<int>(std::log2(usecs + 1.0) * QUaModbusLatencyHistogram::m_binsPerOctave);
+	index = qBound(0, index, QUaModbusLatencyHistogram::m_binCount - 1);
+	m_bins[index]++;
+	m_count++;
+}
+
+void QUaModbusLatencyHistogram::reset()
+{
+	m_bins.fill(0);
+	m_count = 0;
+}
+
+quint32 QUaModbusLatencyHistogram::count() const
+{
+	return m_count;
+}
+
+quint64 QUaModbusLatencyHistogram::memoryUsage() const
+{
+	// NOTE : bins are allocated once on construction, so safe to call from any thread
+	return static_cast<quint64>(m_bins.capacity()) * sizeof(quint32);
+}
+
+double QUaModbusLatencyHistogram::percentile(const double & percent) const
+{
+	if (m_count == 0)
+	{
+		return 0.0;
+	}
+	// first bin where cumulative count reaches rank, use bin middle
+	quint32 rank = static_cast<quint32>(std::ceil(percent / 100.0 * m_count));
+	rank = qBound(static_cast<quint32>(1), rank, m_count);
+	quint32 cumulative = 0;
+	int index = 0;
+	for (; index < m_bins.count(); index++)
+	{
+		cumulative += m_bins.at(index);
+		if (cumulative >= rank)
+		{
+			break;
+		}
+	}
+	double usecs = std::exp2((index + 0.5) / QUaModbusLatencyHistogram::m_binsPerOctave) - 1.0;
+	return usecs / 1000.0;
+}
+
+QUaModbusDataBlockDiagnostics::QUaModbusDataBlockDiagnostics(QUaServer *server)
+#ifndef QUA_ACCESS_CONTROL
+	: QUaBaseObject(server)
+#else
+	: QUaBaseObjectProtected(server)
+#endif // !QUA_ACCESS_CONTROL
+{
+	// set defaults
+	m_sample = QUaModbusDiagnosticsSample({ 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0 });
+	m_cycleTime        = nullptr;
+	m_jitter           = nullptr;
+	m_latencyP50       = nullptr;
+	m_latencyP95       = nullptr;
+	m_latencyP99       = nullptr;
+	m_timeouts         = nullptr;
+	m_skippedPolls     = nullptr;
+	m_bytesTransferred = nullptr;
+	cycleTime       ()->setDataType(QMetaType::Double);
+	jitter          ()->setDataType(QMetaType::Double);
+	latencyP50      ()->setDataType(QMetaType::Double);
+	latencyP95      ()->setDataType(QMetaType::Double);
+	latencyP99      ()->setDataType(QMetaType::Double);
+	timeouts        ()->setDataType(QMetaType::UInt);
+	skippedPolls    ()->setDataType(QMetaType::UInt);
+	bytesTransferred()->setDataType(QMetaType::ULongLong);
+	this->setSample(m_sample);
+	// set descriptions
+	/*
+	cycleTime()       ->setDescription(tr("Achieved time between polls in milliseconds, averaged over the last publish period."));
+	jitter()          ->setDescription(tr("Standard deviation of the time between polls in milliseconds."));
+	latencyP50()      ->setDescription(tr("Median response latency in milliseconds."));
+	latencyP95()      ->setDescription(tr("95th percentile of response latency in milliseconds."));
+	latencyP99()      ->setDescription(tr("99th percentile of response latency in milliseconds."));
+	timeouts()        ->setDescription(tr("Number of reads that timed out."));
+	skippedPolls()    ->setDescription(tr("Number of polls skipped because the previous read was still pending."));
+	bytesTransferred()->setDescription(tr("Number of request and response PDU bytes of all reads."));
+	*/
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::cycleTime()
+{
+	if (!m_cycleTime)
+	{
+		m_cycleTime = this->browseChild<QUaBaseDataVariable>("CycleTime");
+	}
+	return m_cycleTime;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::jitter()
+{
+	if (!m_jitter)
+	{
+		m_jitter = this->browseChild<QUaBaseDataVariable>("Jitter");
+	}
+	return m_jitter;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::latencyP50()
+{
+	if (!m_latencyP50)
+	{
+		m_latencyP50 = this->browseChild<QUaBaseDataVariable>("LatencyP50");
+	}
+	return m_latencyP50;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::latencyP95()
+{
+	if (!m_latencyP95)
+	{
+		m_latencyP95 = this->browseChild<QUaBaseDataVariable>("LatencyP95");
+	}
+	return m_latencyP95;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::latencyP99()
+{
+	if (!m_latencyP99)
+	{
+		m_latencyP99 = this->browseChild<QUaBaseDataVariable>("LatencyP99");
+	}
+	return m_latencyP99;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::timeouts()
+{
+	if (!m_timeouts)
+	{
+		m_timeouts = this->browseChild<QUaBaseDataVariable>("Timeouts");
+	}
+	return m_timeouts;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::skippedPolls()
+{
+	if (!m_skippedPolls)
+	{
+		m_skippedPolls = this->browseChild<QUaBaseDataVariable>("SkippedPolls");
+	}
+	return m_skippedPolls;
+}
+
+QUaBaseDataVariable * QUaModbusDataBlockDiagnostics::bytesTransferred()
+{
+	if (!m_bytesTransferred)
+	{
+		m_bytesTransferred = this->browseChild<QUaBaseDataVariable>("BytesTransferred");
+	}
+	return m_bytesTransferred;
+}
+
+QUaModbusDiagnosticsSample QUaModbusDataBlockDiagnostics::getSample() const
+{
+	return m_sample;
+}
+
+QUaModbusDataBlock * QUaModbusDataBlockDiagnostics::block() const
+{
+	return qobject_cast<QUaModbusDataBlock*>(this->parent());
+}
+
+void QUaModbusDataBlockDiagnostics::setSample(const QUaModbusDiagnosticsSample & sample)
+{
+	m_sample = sample;
+	// update
+	this->cycleTime()       ->setValue(sample.cycleTime);
+	this->jitter()          ->setValue(sample.jitter);
+	this->latencyP50()      ->setValue(sample.latencyP50);
+	this->latencyP95()      ->setValue(sample.latencyP95);
+	this->latencyP99()      ->setValue(sample.latencyP99);
+	this->timeouts()        ->setValue(sample.timeouts);
+	this->skippedPolls()    ->setValue(sample.skippedPolls);
+	this->bytesTransferred()->setValue(sample.bytesTransferred);
+	// emit
+	emit this->sampleChanged(sample);
+}
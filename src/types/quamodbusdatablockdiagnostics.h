@@ -0,0 +1,110 @@
+#ifndef QUAMODBUSDATABLOCKDIAGNOSTICS_H
+#define QUAMODBUSDATABLOCKDIAGNOSTICS_H
+
+#include <QVector>
+
+#ifndef QUA_ACCESS_CONTROL
+#include <QUaBaseObject>
+#else
+#include <QUaBaseObjectProtected>
+#endif // !QUA_ACCESS_CONTROL
+
+#include <QUaBaseDataVariable>
+
+class QUaModbusDataBlock;
+
+// online histogram of response latencies, log spaced bins
+class QUaModbusLatencyHistogram
+{
+public:
+	QUaModbusLatencyHistogram();
+
+	void    add(const qint64 &nsecs);
+	void    reset();
+	quint32 count() const;
+	// bytes allocated by bins
+	quint64 memoryUsage() const;
+	// in ms, approximated within bin resolution (about 9%)
+	double  percentile(const double &percent) const;
+
+private:
+	QVector<quint32> m_bins;
+	quint32          m_count;
+
+	static const int m_binsPerOctave = 8;
+	static const int m_binCount      = 8 * 25; // up to 2^25 us (about 33 s)
+};
+
+// block poll statistics, taken in worker thread and published in ua server thread
+struct QUaModbusDiagnosticsSample
+{
+	double  cycleTime;        // ms, mean time between polls
+	double  jitter;           // ms, standard deviation of time between polls
+	double  latencyP50;       // ms, response latency percentiles
+	double  latencyP95;
+	double  latencyP99;
+	quint32 timeouts;         // total
+	quint32 skippedPolls;     // total, polls skipped because previous read still pending
+	quint64 bytesTransferred; // total, request plus response PDU bytes
+};
+Q_DECLARE_METATYPE(QUaModbusDiagnosticsSample)
+
+#ifndef QUA_ACCESS_CONTROL
+class QUaModbusDataBlockDiagnostics : public QUaBaseObject
+#else
+class QUaModbusDataBlockDiagnostics : public QUaBaseObjectProtected
+#endif // !QUA_ACCESS_CONTROL
+{
+	friend class QUaModbusDataBlock;
+
+    Q_OBJECT
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * CycleTime        READ cycleTime       )
+	Q_PROPERTY(QUaBaseDataVariable * Jitter           READ jitter          )
+	Q_PROPERTY(QUaBaseDataVariable * LatencyP50       READ latencyP50      )
+	Q_PROPERTY(QUaBaseDataVariable * LatencyP95       READ latencyP95      )
+	Q_PROPERTY(QUaBaseDataVariable * LatencyP99       READ latencyP99      )
+	Q_PROPERTY(QUaBaseDataVariable * Timeouts         READ timeouts        )
+	Q_PROPERTY(QUaBaseDataVariable * SkippedPolls     READ skippedPolls    )
+	Q_PROPERTY(QUaBaseDataVariable * BytesTransferred READ bytesTransferred)
+
+public:
+	Q_INVOKABLE explicit QUaModbusDataBlockDiagnostics(QUaServer *server);
+
+	// UA variables
+
+	QUaBaseDataVariable * cycleTime();
+	QUaBaseDataVariable * jitter();
+	QUaBaseDataVariable * latencyP50();
+	QUaBaseDataVariable * latencyP95();
+	QUaBaseDataVariable * latencyP99();
+	QUaBaseDataVariable * timeouts();
+	QUaBaseDataVariable * skippedPolls();
+	QUaBaseDataVariable * bytesTransferred();
+
+	// C++ API (all is read only)
+
+	QUaModbusDiagnosticsSample getSample() const;
+
+	QUaModbusDataBlock * block() const;
+
+signals:
+	// C++ API
+	void sampleChanged(const QUaModbusDiagnosticsSample &sample);
+
+private:
+	QUaModbusDiagnosticsSample m_sample;
+	QUaBaseDataVariable* m_cycleTime;
+	QUaBaseDataVariable* m_jitter;
+	QUaBaseDataVariable* m_latencyP50;
+	QUaBaseDataVariable* m_latencyP95;
+	QUaBaseDataVariable* m_latencyP99;
+	QUaBaseDataVariable* m_timeouts;
+	QUaBaseDataVariable* m_skippedPolls;
+	QUaBaseDataVariable* m_bytesTransferred;
+
+	void setSample(const QUaModbusDiagnosticsSample &sample);
+};
+
+#endif // QUAMODBUSDATABLOCKDIAGNOSTICS_H
@@ -62,6 +62,8 @@ QString QUaModbusDataBlockList::addDataBlock(const QUaQualifiedName& blockId)
 	}
 	// start block loop
 	block->startLoop();
+	// keep worker copy of client scan group valid
+	this->client()->updateScanGroup();
 	// return
 	return "Success";
 }
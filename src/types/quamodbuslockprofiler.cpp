@@ -0,0 +1,212 @@
+#include "quamodbuslockprofiler.h"
+
+#include <QObject>
+#include <QMutexLocker>
+#include <QList>
+#include <algorithm>
+
+QBasicAtomicInt QUaModbusLockProfiler::m_enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+namespace
+{
+
+struct QUaModbusLockRegistry
+{
+	QMutex                    mutex;
+	QList<QUaModbusLockSite*> sites;
+};
+
+QUaModbusLockRegistry & lockRegistry()
+{
+	static QUaModbusLockRegistry registry;
+	return registry;
+}
+
+void updateMax(QAtomicInteger<quint64> &max, const quint64 &value)
+{
+	quint64 current = max.load();
+	while (value > current && !max.testAndSetRelaxed(current, value, current))
+	{
+	}
+}
+
+QString escapeLabel(const char * site)
+{
+	QString strSite = QString::fromLatin1(site);
+	strSite.replace("\\", "\\\\");
+	strSite.replace("\"", "\\\"");
+	strSite.replace("\n", "\\n");
+	return strSite;
+}
+
+} // namespace
+
+QUaModbusLockSite::QUaModbusLockSite(const char * site)
+{
+	m_site = site;
+	m_acquisitions.store(0);
+	m_contentions.store(0);
+	m_waitNs.store(0);
+	m_waitMaxNs.store(0);
+	m_holdNs.store(0);
+	m_holdMaxNs.store(0);
+	QUaModbusLockProfiler::registerSite(this);
+}
+
+bool QUaModbusLockProfiler::isEnabled()
+{
+	return m_enabled.load();
+}
+
+void QUaModbusLockProfiler::setEnabled(const bool & enabled)
+{
+	m_enabled.store(enabled ? 1 : 0);
+}
+
+QString QUaModbusLockProfiler::toCsv()
+{
+	QList<QUaModbusLockSite*> sites;
+	{
+		auto &registry = lockRegistry();
+		QMutexLocker locker(&registry.mutex);
+		sites = registry.sites;
+	}
+	std::sort(sites.begin(), sites.end(), [](QUaModbusLockSite * a, QUaModbusLockSite * b) {
+		return a->m_waitNs.load() > b->m_waitNs.load();
+	});
+	QString strCsv = QString("%1, %2, %3, %4, %5, %6, %7\n")
+		.arg(QObject::tr("Site"))
+		.arg(QObject::tr("Acquisitions"))
+		.arg(QObject::tr("Contentions"))
+		.arg(QObject::tr("WaitTotal"))
+		.arg(QObject::tr("WaitMax"))
+		.arg(QObject::tr("HoldTotal"))
+		.arg(QObject::tr("HoldMax"));
+	for (auto site : sites)
+	{
+		if (site->m_acquisitions.load() == 0)
+		{
+			continue;
+		}
+		// quoted, function signatures can contain commas
+		QString strSite = QString::fromLatin1(site->m_site);
+		strSite.replace("\"", "\"\"");
+		strCsv += QString("\"%1\", %2, %3, %4, %5, %6, %7\n")
+			.arg(strSite)
+			.arg(site->m_acquisitions.load())
+			.arg(site->m_contentions.load())
+			.arg(site->m_waitNs.load()    / 1e6, 0, 'f', 3)
+			.arg(site->m_waitMaxNs.load() / 1e6, 0, 'f', 3)
+			.arg(site->m_holdNs.load()    / 1e6, 0, 'f', 3)
+			.arg(site->m_holdMaxNs.load() / 1e6, 0, 'f', 3);
+	}
+	return strCsv;
+}
+
+QByteArray QUaModbusLockProfiler::toPrometheus()
+{
+	QList<QUaModbusLockSite*> sites;
+	{
+		auto &registry = lockRegistry();
+		QMutexLocker locker(&registry.mutex);
+		for (auto site : registry.sites)
+		{
+			if (site->m_acquisitions.load() == 0)
+			{
+				continue;
+			}
+			sites << site;
+		}
+	}
+	QByteArray out;
+	if (sites.isEmpty())
+	{
+		return out;
+	}
+	auto line = [&out](const QString &strLine) {
+		out += strLine.toUtf8();
+		out += '\n';
+	};
+	line("# HELP quamodbus_lock_acquisitions_total Client lock acquisitions while profiling, by call site.");
+	line("# TYPE quamodbus_lock_acquisitions_total counter");
+	for (auto site : sites)
+	{
+		line(QString("quamodbus_lock_acquisitions_total{site=\"%1\"} %2")
+			.arg(escapeLabel(site->m_site))
+			.arg(site->m_acquisitions.load()));
+	}
+	line("# HELP quamodbus_lock_contentions_total Client lock acquisitions that had to wait, by call site.");
+	line("# TYPE quamodbus_lock_contentions_total counter");
+	for (auto site : sites)
+	{
+		line(QString("quamodbus_lock_contentions_total{site=\"%1\"} %2")
+			.arg(escapeLabel(site->m_site))
+			.arg(site->m_contentions.load()));
+	}
+	line("# HELP quamodbus_lock_wait_seconds_total Time spent waiting for client locks, by call site.");
+	line("# TYPE quamodbus_lock_wait_seconds_total counter");
+	for (auto site : sites)
+	{
+		line(QString("quamodbus_lock_wait_seconds_total{site=\"%1\"} %2")
+			.arg(escapeLabel(site->m_site))
+			.arg(site->m_waitNs.load() / 1e9, 0, 'f', 9));
+	}
+	line("# HELP quamodbus_lock_hold_seconds_total Time client locks were held, by call site.");
+	line("# TYPE quamodbus_lock_hold_seconds_total counter");
+	for (auto site : sites)
+	{
+		line(QString("quamodbus_lock_hold_seconds_total{site=\"%1\"} %2")
+			.arg(escapeLabel(site->m_site))
+			.arg(site->m_holdNs.load() / 1e9, 0, 'f', 9));
+	}
+	return out;
+}
+
+void QUaModbusLockProfiler::clear()
+{
+	auto &registry = lockRegistry();
+	QMutexLocker locker(&registry.mutex);
+	for (auto site : registry.sites)
+	{
+		site->m_acquisitions.store(0);
+		site->m_contentions.store(0);
+		site->m_waitNs.store(0);
+		site->m_waitMaxNs.store(0);
+		site->m_holdNs.store(0);
+		site->m_holdMaxNs.store(0);
+	}
+}
+
+void QUaModbusLockProfiler::registerSite(QUaModbusLockSite * site)
+{
+	auto &registry = lockRegistry();
+	QMutexLocker locker(&registry.mutex);
+	registry.sites << site;
+}
+
+void QUaModbusProfiledLocker::lockProfiled(QUaModbusLockSite * site)
+{
+	m_site = site;
+	m_site->m_acquisitions.fetchAndAddRelaxed(1);
+	// uncontended (or recursive) acquisitions do not pay for a clock read while waiting
+	if (m_mutex->tryLock())
+	{
+		m_timer.start();
+		return;
+	}
+	m_timer.start();
+	m_mutex->lock();
+	quint64 waitNs = static_cast<quint64>(m_timer.nsecsElapsed());
+	m_timer.restart();
+	m_site->m_contentions.fetchAndAddRelaxed(1);
+	m_site->m_waitNs.fetchAndAddRelaxed(waitNs);
+	updateMax(m_site->m_waitMaxNs, waitNs);
+}
+
+void QUaModbusProfiledLocker::unlockProfiled()
+{
+	quint64 holdNs = static_cast<quint64>(m_timer.nsecsElapsed());
+	m_mutex->unlock();
+	m_site->m_holdNs.fetchAndAddRelaxed(holdNs);
+	updateMax(m_site->m_holdMaxNs, holdNs);
+}
@@ -0,0 +1,90 @@
+#ifndef QUAMODBUSLOCKPROFILER_H
+#define QUAMODBUSLOCKPROFILER_H
+
+#include <QMutex>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QString>
+
+// counters of one lock call site, registered on first use
+class QUaModbusLockSite
+{
+public:
+	explicit QUaModbusLockSite(const char * site);
+
+	const char * m_site;
+	QAtomicInteger<quint64> m_acquisitions;
+	QAtomicInteger<quint64> m_contentions;
+	QAtomicInteger<quint64> m_waitNs;
+	QAtomicInteger<quint64> m_waitMaxNs;
+	QAtomicInteger<quint64> m_holdNs;
+	QAtomicInteger<quint64> m_holdMaxNs;
+};
+
+// opt-in lock contention profiler, counts acquisitions, wait and hold time per call site
+// NOTE : when disabled, lockers cost a single relaxed load and branch on top of the lock
+class QUaModbusLockProfiler
+{
+public:
+	static bool isEnabled();
+	static void setEnabled(const bool &enabled);
+
+	// one row per call site, sorted by total wait time, times in ms
+	static QString    toCsv();
+	// text exposition format, only sites acquired while enabled
+	static QByteArray toPrometheus();
+	static void       clear();
+
+private:
+	friend class QUaModbusLockSite;
+	friend class QUaModbusProfiledLocker;
+
+	static void registerSite(QUaModbusLockSite * site);
+
+	static QBasicAtomicInt m_enabled;
+};
+
+// drop-in replacement of QMutexLocker that reports to a call site while profiling is enabled
+// NOTE : nested locks of a recursive mutex are counted separately, outer hold time includes inner ones
+class QUaModbusProfiledLocker
+{
+public:
+	inline QUaModbusProfiledLocker(QMutex * mutex, QUaModbusLockSite * site)
+		: m_mutex(mutex), m_site(nullptr)
+	{
+		if (Q_LIKELY(!QUaModbusLockProfiler::m_enabled.load()))
+		{
+			m_mutex->lock();
+			return;
+		}
+		this->lockProfiled(site);
+	}
+
+	inline ~QUaModbusProfiledLocker()
+	{
+		if (Q_UNLIKELY(m_site))
+		{
+			this->unlockProfiled();
+			return;
+		}
+		m_mutex->unlock();
+	}
+
+private:
+	Q_DISABLE_COPY(QUaModbusProfiledLocker)
+
+	void lockProfiled(QUaModbusLockSite * site);
+	void unlockProfiled();
+
+	QMutex            * m_mutex;
+	QUaModbusLockSite * m_site;
+	QElapsedTimer       m_timer;
+};
+
+// declares a locker named locker, reported under the enclosing function name
+#define QUA_MODBUS_LOCKER(mutex) \
+	static QUaModbusLockSite quaModbusLockSite(Q_FUNC_INFO); \
+	QUaModbusProfiledLocker locker(mutex, &quaModbusLockSite)
+
+#endif // QUAMODBUSLOCKPROFILER_H
@@ -0,0 +1,328 @@
+#include "quamodbusloopdiagnostics.h"
+#include "quamodbusmetrics.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QList>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+quint32 QUaModbusLagMonitor::m_beatPeriod     = 50;
+quint32 QUaModbusLagMonitor::m_publishPeriod  = 5000;
+quint32 QUaModbusLagMonitor::m_stallThreshold = 1000;
+
+namespace
+{
+
+struct QUaModbusMonotonicClock
+{
+	QUaModbusMonotonicClock()
+	{
+		timer.start();
+	}
+	QElapsedTimer timer;
+};
+
+// ns, shared by monitored threads and watchdog
+qint64 monotonicNow()
+{
+	static QUaModbusMonotonicClock clock;
+	return clock.timer.nsecsElapsed();
+}
+
+thread_local QUaModbusLagMonitor * t_monitor = nullptr;
+
+const char * const unlabeledTask = "(unlabeled)";
+
+} // namespace
+
+// checks all monitors from its own thread, so it keeps running while a monitored thread is blocked
+// NOTE : plain std::thread because it must not depend on any Qt event loop
+class QUaModbusWatchdog
+{
+public:
+	static QUaModbusWatchdog & instance()
+	{
+		static QUaModbusWatchdog watchdog;
+		return watchdog;
+	}
+
+	~QUaModbusWatchdog()
+	{
+		m_stop = true;
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	void add(QUaModbusLagMonitor * monitor)
+	{
+		QMutexLocker locker(&m_mutex);
+		m_monitors << monitor;
+		if (!m_thread.joinable())
+		{
+			m_thread = std::thread([this]() {
+				while (!m_stop)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(m_checkPeriod)));
+					this->check();
+				}
+			});
+		}
+	}
+
+	void remove(QUaModbusLagMonitor * monitor)
+	{
+		// NOTE : once this returns the watchdog never touches the monitor again
+		QMutexLocker locker(&m_mutex);
+		m_monitors.removeAll(monitor);
+	}
+
+private:
+	QUaModbusWatchdog()
+	{
+		m_stop = false;
+	}
+
+	void check()
+	{
+		QMutexLocker locker(&m_mutex);
+		qint64 now       = monotonicNow();
+		qint64 threshold = static_cast<qint64>(QUaModbusLagMonitor::m_stallThreshold) * 1000000;
+		for (auto monitor : m_monitors)
+		{
+			qint64 lastBeat = monitor->m_lastBeat.load();
+			if (lastBeat == 0)
+			{
+				continue;
+			}
+			qint64 elapsed = now - lastBeat;
+			if (elapsed > threshold)
+			{
+				// new stall, take task label while still running
+				if (!monitor->m_stalled)
+				{
+					monitor->m_stalled   = true;
+					auto task = monitor->m_task.load();
+					monitor->m_stallTask = task ? task : unlabeledTask;
+					monitor->m_stalls.ref();
+					monitor->m_lastStallTask.store(monitor->m_stallTask);
+					QUaModbusMetrics::addStall();
+				}
+				monitor->m_lastStallDuration.store(elapsed / 1000);
+				continue;
+			}
+			if (monitor->m_stalled)
+			{
+				monitor->m_stalled = false;
+			}
+		}
+	}
+
+	QMutex                      m_mutex;
+	QList<QUaModbusLagMonitor*> m_monitors;
+	std::thread                 m_thread;
+	std::atomic<bool>           m_stop;
+
+	static const int m_checkPeriod = 100;
+};
+
+QUaModbusLagMonitor::QUaModbusLagMonitor()
+{
+	m_previousBeat = 0;
+	m_lastPublish  = 0;
+	m_lastLag      = 0;
+	m_maxLag       = 0;
+	m_sample       = QUaModbusLoopSample({ 0.0, 0.0, 0.0, 0, QString(), 0.0 });
+	m_lastBeat.store(0);
+	m_task.store(nullptr);
+	m_stalls.store(0);
+	m_lastStallTask.store(nullptr);
+	m_lastStallDuration.store(0);
+	m_stalled   = false;
+	m_stallTask = nullptr;
+	QUaModbusWatchdog::instance().add(this);
+}
+
+QUaModbusLagMonitor::~QUaModbusLagMonitor()
+{
+	QUaModbusWatchdog::instance().remove(this);
+}
+
+void QUaModbusLagMonitor::attach()
+{
+	t_monitor = this;
+}
+
+bool QUaModbusLagMonitor::beat()
+{
+	qint64 now = monotonicNow();
+	if (m_previousBeat > 0)
+	{
+		qint64 expected = static_cast<qint64>(QUaModbusLagMonitor::m_beatPeriod) * 1000000;
+		m_lastLag = qMax(static_cast<qint64>(0), now - m_previousBeat - expected);
+		m_maxLag  = qMax(m_maxLag, m_lastLag);
+		m_histogram.add(m_lastLag);
+	}
+	else
+	{
+		m_lastPublish = now;
+	}
+	m_previousBeat = now;
+	m_lastBeat.store(now);
+	// publish periodically
+	if (now - m_lastPublish < static_cast<qint64>(QUaModbusLagMonitor::m_publishPeriod) * 1000000)
+	{
+		return false;
+	}
+	m_lastPublish = now;
+	auto lastStallTask = m_lastStallTask.load();
+	m_sample.lagP50            = m_histogram.percentile(50.0);
+	m_sample.lagP99            = m_histogram.percentile(99.0);
+	m_sample.lagMax            = m_maxLag / 1000000.0;
+	m_sample.stalls            = static_cast<quint32>(m_stalls.load());
+	m_sample.strLastStallTask  = lastStallTask ? QString::fromLatin1(lastStallTask) : QString();
+	m_sample.lastStallDuration = m_lastStallDuration.load() / 1000.0;
+	m_histogram.reset();
+	m_maxLag = 0;
+	return true;
+}
+
+QUaModbusLoopSample QUaModbusLagMonitor::sample() const
+{
+	return m_sample;
+}
+
+qint64 QUaModbusLagMonitor::lastLag() const
+{
+	return m_lastLag;
+}
+
+QUaModbusTaskScope::QUaModbusTaskScope(const char * task)
+{
+	m_monitor  = t_monitor;
+	m_previous = nullptr;
+	if (!m_monitor)
+	{
+		return;
+	}
+	m_previous = m_monitor->m_task.load();
+	m_monitor->m_task.store(task);
+}
+
+QUaModbusTaskScope::~QUaModbusTaskScope()
+{
+	if (!m_monitor)
+	{
+		return;
+	}
+	m_monitor->m_task.store(m_previous);
+}
+
+QUaModbusLoopDiagnostics::QUaModbusLoopDiagnostics(QUaServer *server)
+#ifndef QUA_ACCESS_CONTROL
+	: QUaBaseObject(server)
+#else
+	: QUaBaseObjectProtected(server)
+#endif // !QUA_ACCESS_CONTROL
+{
+	// set defaults
+	m_sample = QUaModbusLoopSample({ 0.0, 0.0, 0.0, 0, QString(), 0.0 });
+	m_lagP50            = nullptr;
+	m_lagP99            = nullptr;
+	m_lagMax            = nullptr;
+	m_stalls            = nullptr;
+	m_lastStallTask     = nullptr;
+	m_lastStallDuration = nullptr;
+	lagP50           ()->setDataType(QMetaType::Double);
+	lagP99           ()->setDataType(QMetaType::Double);
+	lagMax           ()->setDataType(QMetaType::Double);
+	stalls           ()->setDataType(QMetaType::UInt);
+	lastStallTask    ()->setDataType(QMetaType::QString);
+	lastStallDuration()->setDataType(QMetaType::Double);
+	this->setSample(m_sample);
+	// set descriptions
+	/*
+	lagP50           ()->setDescription(tr("Median event loop latency in milliseconds over the last publish period."));
+	lagP99           ()->setDescription(tr("99th percentile of event loop latency in milliseconds."));
+	lagMax           ()->setDescription(tr("Maximum event loop latency in milliseconds over the last publish period."));
+	stalls           ()->setDescription(tr("Number of times the event loop was blocked longer than the stall threshold."));
+	lastStallTask    ()->setDescription(tr("Task that was running when the last stall was detected."));
+	lastStallDuration()->setDescription(tr("Duration of the last stall in milliseconds."));
+	*/
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::lagP50()
+{
+	if (!m_lagP50)
+	{
+		m_lagP50 = this->browseChild<QUaBaseDataVariable>("LagP50");
+	}
+	return m_lagP50;
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::lagP99()
+{
+	if (!m_lagP99)
+	{
+		m_lagP99 = this->browseChild<QUaBaseDataVariable>("LagP99");
+	}
+	return m_lagP99;
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::lagMax()
+{
+	if (!m_lagMax)
+	{
+		m_lagMax = this->browseChild<QUaBaseDataVariable>("LagMax");
+	}
+	return m_lagMax;
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::stalls()
+{
+	if (!m_stalls)
+	{
+		m_stalls = this->browseChild<QUaBaseDataVariable>("Stalls");
+	}
+	return m_stalls;
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::lastStallTask()
+{
+	if (!m_lastStallTask)
+	{
+		m_lastStallTask = this->browseChild<QUaBaseDataVariable>("LastStallTask");
+	}
+	return m_lastStallTask;
+}
+
+QUaBaseDataVariable * QUaModbusLoopDiagnostics::lastStallDuration()
+{
+	if (!m_lastStallDuration)
+	{
+		m_lastStallDuration = this->browseChild<QUaBaseDataVariable>("LastStallDuration");
+	}
+	return m_lastStallDuration;
+}
+
+QUaModbusLoopSample QUaModbusLoopDiagnostics::getSample() const
+{
+	return m_sample;
+}
+
+void QUaModbusLoopDiagnostics::setSample(const QUaModbusLoopSample & sample)
+{
+	m_sample = sample;
+	// update
+	this->lagP50()           ->setValue(sample.lagP50);
+	this->lagP99()           ->setValue(sample.lagP99);
+	this->lagMax()           ->setValue(sample.lagMax);
+	this->stalls()           ->setValue(sample.stalls);
+	this->lastStallTask()    ->setValue(sample.strLastStallTask);
+	this->lastStallDuration()->setValue(sample.lastStallDuration);
+	// emit
+	emit this->sampleChanged(sample);
+}
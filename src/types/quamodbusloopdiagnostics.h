@@ -0,0 +1,139 @@
+#ifndef QUAMODBUSLOOPDIAGNOSTICS_H
+#define QUAMODBUSLOOPDIAGNOSTICS_H
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+
+#ifndef QUA_ACCESS_CONTROL
+#include <QUaBaseObject>
+#else
+#include <QUaBaseObjectProtected>
+#endif // !QUA_ACCESS_CONTROL
+
+#include <QUaBaseDataVariable>
+
+#include "quamodbusdatablockdiagnostics.h"
+
+class QUaModbusClient;
+class QUaModbusClientList;
+
+// event loop statistics, taken in monitored thread and published in ua server thread
+struct QUaModbusLoopSample
+{
+	double  lagP50;            // ms, heartbeat lateness percentiles over last publish period
+	double  lagP99;
+	double  lagMax;            // ms, over last publish period
+	quint32 stalls;            // total, heartbeat missing for longer than stall threshold
+	QString strLastStallTask;  // task running when last stall was detected
+	double  lastStallDuration; // ms
+};
+Q_DECLARE_METATYPE(QUaModbusLoopSample)
+
+// measures event loop latency of one thread as lateness of a periodic heartbeat,
+// a watchdog thread detects stalls while the monitored thread is blocked
+class QUaModbusLagMonitor
+{
+public:
+	QUaModbusLagMonitor();
+	~QUaModbusLagMonitor();
+
+	// call in monitored thread, so task scopes in that thread label this monitor
+	void attach();
+	// call every m_beatPeriod ms in monitored thread, returns true when a new sample is ready
+	bool beat();
+	// call in monitored thread
+	QUaModbusLoopSample sample() const;
+	// ns, last heartbeat lateness
+	qint64 lastLag() const;
+
+	static quint32 m_beatPeriod;
+	static quint32 m_publishPeriod;
+	static quint32 m_stallThreshold;
+
+private:
+	friend class QUaModbusTaskScope;
+	friend class QUaModbusWatchdog;
+	// NOTE : only modify and access in monitored thread
+	QUaModbusLatencyHistogram m_histogram;
+	qint64 m_previousBeat;
+	qint64 m_lastPublish;
+	qint64 m_lastLag;
+	qint64 m_maxLag;
+	QUaModbusLoopSample m_sample;
+	// NOTE : shared with watchdog thread
+	QAtomicInteger<qint64>     m_lastBeat;
+	QAtomicPointer<const char> m_task;
+	QAtomicInt                 m_stalls;
+	QAtomicPointer<const char> m_lastStallTask;
+	QAtomicInteger<qint64>     m_lastStallDuration;
+	// NOTE : only modify and access in watchdog thread
+	bool m_stalled;
+	const char * m_stallTask;
+};
+
+// labels the task run by the calling thread while in scope, reported on stalls
+// NOTE : task must be a string literal, costs a thread local read if thread is not monitored
+class QUaModbusTaskScope
+{
+public:
+	explicit QUaModbusTaskScope(const char * task);
+	~QUaModbusTaskScope();
+
+private:
+	QUaModbusLagMonitor * m_monitor;
+	const char          * m_previous;
+};
+
+#ifndef QUA_ACCESS_CONTROL
+class QUaModbusLoopDiagnostics : public QUaBaseObject
+#else
+class QUaModbusLoopDiagnostics : public QUaBaseObjectProtected
+#endif // !QUA_ACCESS_CONTROL
+{
+	friend class QUaModbusClient;
+	friend class QUaModbusClientList;
+
+    Q_OBJECT
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * LagP50            READ lagP50           )
+	Q_PROPERTY(QUaBaseDataVariable * LagP99            READ lagP99           )
+	Q_PROPERTY(QUaBaseDataVariable * LagMax            READ lagMax           )
+	Q_PROPERTY(QUaBaseDataVariable * Stalls            READ stalls           )
+	Q_PROPERTY(QUaBaseDataVariable * LastStallTask     READ lastStallTask    )
+	Q_PROPERTY(QUaBaseDataVariable * LastStallDuration READ lastStallDuration)
+
+public:
+	Q_INVOKABLE explicit QUaModbusLoopDiagnostics(QUaServer *server);
+
+	// UA variables
+
+	QUaBaseDataVariable * lagP50();
+	QUaBaseDataVariable * lagP99();
+	QUaBaseDataVariable * lagMax();
+	QUaBaseDataVariable * stalls();
+	QUaBaseDataVariable * lastStallTask();
+	QUaBaseDataVariable * lastStallDuration();
+
+	// C++ API (all is read only)
+
+	QUaModbusLoopSample getSample() const;
+
+signals:
+	// C++ API
+	void sampleChanged(const QUaModbusLoopSample &sample);
+
+private:
+	QUaModbusLoopSample m_sample;
+	QUaBaseDataVariable* m_lagP50;
+	QUaBaseDataVariable* m_lagP99;
+	QUaBaseDataVariable* m_lagMax;
+	QUaBaseDataVariable* m_stalls;
+	QUaBaseDataVariable* m_lastStallTask;
+	QUaBaseDataVariable* m_lastStallDuration;
+
+	void setSample(const QUaModbusLoopSample &sample);
+};
+
+#endif // QUAMODBUSLOOPDIAGNOSTICS_H
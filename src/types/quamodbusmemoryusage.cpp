@@ -0,0 +1,106 @@
+#include "quamodbusmemoryusage.h"
+#include "quamodbusclient.h"
+#include "quamodbusdatablock.h"
+#include "quamodbusvalue.h"
+
+#include <QSequentialIterable>
+#include <QUaBaseVariable>
+
+// open62541 node with its references plus QObject and QUaNode private data
+quint32 QUaModbusMemoryUsage::m_nodeBytes   = 1024;
+// QLambdaThreadWorker thread (committed stack and event dispatcher) plus QModbusClient private data
+quint32 QUaModbusMemoryUsage::m_workerBytes = 64 * 1024;
+
+namespace
+{
+// shared data header of implicitly shared Qt containers (QArrayData)
+const quint64 containerHeader = 24;
+}
+
+QUaModbusMemoryUsage::QUaModbusMemoryUsage()
+{
+	nodeCount = 0;
+	nodes     = 0;
+	buffers   = 0;
+	variants  = 0;
+	objects   = 0;
+}
+
+quint64 QUaModbusMemoryUsage::total() const
+{
+	return nodes + buffers + variants + objects;
+}
+
+QUaModbusMemoryUsage & QUaModbusMemoryUsage::operator+=(const QUaModbusMemoryUsage & other)
+{
+	nodeCount += other.nodeCount;
+	nodes     += other.nodes;
+	buffers   += other.buffers;
+	variants  += other.variants;
+	objects   += other.objects;
+	return *this;
+}
+
+void QUaModbusMemoryUsage::addNodes(QUaNode * node)
+{
+	nodeCount++;
+	nodes += QUaModbusMemoryUsage::m_nodeBytes;
+	auto variable = qobject_cast<QUaBaseVariable*>(node);
+	if (variable)
+	{
+		variants += QUaModbusMemoryUsage::variantBytes(variable->value());
+	}
+	auto children = node->browseChildren<QUaNode>();
+	for (auto child : children)
+	{
+		if (qobject_cast<QUaModbusClient*>(child) ||
+			qobject_cast<QUaModbusDataBlock*>(child) ||
+			qobject_cast<QUaModbusValue*>(child))
+		{
+			continue;
+		}
+		this->addNodes(child);
+	}
+}
+
+quint64 QUaModbusMemoryUsage::variantBytes(const QVariant & value)
+{
+	int type = value.userType();
+	switch (type)
+	{
+	case QMetaType::UnknownType:
+		return 0;
+	case QMetaType::QString:
+		return containerHeader + static_cast<quint64>(value.toString().capacity()) * sizeof(QChar);
+	case QMetaType::QByteArray:
+		return containerHeader + static_cast<quint64>(value.toByteArray().capacity());
+	case QMetaType::QVariantList:
+	{
+		// QList<QVariant> stores each variant in its own heap node
+		auto list = value.toList();
+		quint64 bytes = containerHeader + static_cast<quint64>(list.count()) * (sizeof(void*) + sizeof(QVariant));
+		for (auto &item : list)
+		{
+			bytes += QUaModbusMemoryUsage::variantBytes(item);
+		}
+		return bytes;
+	}
+	default:
+		break;
+	}
+	// registered sequential containers (e.g. QVector<quint16>)
+	if (value.canConvert<QSequentialIterable>())
+	{
+		auto iterable = value.value<QSequentialIterable>();
+		quint64 bytes = containerHeader;
+		for (const QVariant &item : iterable)
+		{
+			bytes += static_cast<quint64>(QMetaType::sizeOf(item.userType()));
+			bytes += QUaModbusMemoryUsage::variantBytes(item);
+		}
+		return bytes;
+	}
+	// QVariant stores types larger than its inline storage on the heap
+	auto size = QMetaType::sizeOf(type);
+	return size > static_cast<int>(sizeof(double)) ? static_cast<quint64>(size) : 0;
+}
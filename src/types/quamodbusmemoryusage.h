@@ -0,0 +1,35 @@
+#ifndef QUAMODBUSMEMORYUSAGE_H
+#define QUAMODBUSMEMORYUSAGE_H
+
+#include <QVariant>
+
+class QUaNode;
+
+// approximate memory owned by a gateway object in bytes, for capacity planning and leak hunting
+// NOTE : only collect in ua server thread, worker thread scratch buffers are not included
+struct QUaModbusMemoryUsage
+{
+	QUaModbusMemoryUsage();
+
+	quint32 nodeCount; // ua nodes owned (object itself, properties, variables, folders)
+	quint64 nodes;     // ua nodes, estimated server side node plus qt object overhead
+	quint64 buffers;   // container payloads (histograms, request log rings, snapshots)
+	quint64 variants;  // variant payloads (ua variable values and cached values)
+	quint64 objects;   // gateway c++ objects, worker threads and modbus devices
+
+	quint64 total() const;
+
+	QUaModbusMemoryUsage & operator+=(const QUaModbusMemoryUsage &other);
+
+	// adds node and its children, stops at clients, blocks and values (they account for themselves)
+	void addNodes(QUaNode * node);
+
+	// heap payload of a variant, 0 if stored inline
+	static quint64 variantBytes(const QVariant &value);
+
+	// estimates, tune for the target platform
+	static quint32 m_nodeBytes;
+	static quint32 m_workerBytes;
+};
+
+#endif // QUAMODBUSMEMORYUSAGE_H
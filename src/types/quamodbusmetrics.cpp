@@ -0,0 +1,262 @@
+#include "quamodbusmetrics.h"
+#include "quamodbuslockprofiler.h"
+
+#include <QTcpSocket>
+#include <QSaveFile>
+#include <QMetaEnum>
+#include <QHostAddress>
+
+QAtomicInteger<quint64> QUaModbusMetrics::m_requests[2];
+QAtomicInteger<quint64> QUaModbusMetrics::m_errors[QUaModbusMetrics::m_errorCount];
+QAtomicInteger<quint64> QUaModbusMetrics::m_latencyBuckets[QUaModbusMetrics::m_bucketCount + 1];
+QAtomicInteger<quint64> QUaModbusMetrics::m_latencySumUs;
+QAtomicInteger<qint64>  QUaModbusMetrics::m_queueDepth;
+QAtomicInteger<quint64> QUaModbusMetrics::m_connects;
+QAtomicInteger<quint64> QUaModbusMetrics::m_reconnects;
+QAtomicInteger<quint64> QUaModbusMetrics::m_valueUpdates;
+QAtomicInteger<qint64>  QUaModbusMetrics::m_eventLoopLagUs;
+QAtomicInteger<qint64>  QUaModbusMetrics::m_eventLoopLagMaxUs;
+QAtomicInteger<quint64> QUaModbusMetrics::m_stalls;
+
+const double QUaModbusMetrics::m_bucketBounds[QUaModbusMetrics::m_bucketCount] = {
+	1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+quint32 QUaModbusMetricsExporter::m_filePeriod    = 5000;
+qint64  QUaModbusMetricsExporter::m_maxHeaderSize = 8192;
+int     QUaModbusMetricsExporter::m_idleTimeout   = 5000;
+
+void QUaModbusMetrics::addRequest(const bool & isWrite, const bool & expectsReply)
+{
+	m_requests[isWrite ? 1 : 0].fetchAndAddRelaxed(1);
+	if (expectsReply)
+	{
+		m_queueDepth.fetchAndAddRelaxed(1);
+	}
+}
+
+void QUaModbusMetrics::addReply(const QModbusDevice::Error & error, const qint64 & nsecs)
+{
+	m_queueDepth.fetchAndAddRelaxed(-1);
+	int index = error >= 0 && error < m_errorCount ? error : QModbusDevice::UnknownError;
+	m_errors[index].fetchAndAddRelaxed(1);
+	// only replies actually received count for latency
+	if (error == QModbusDevice::TimeoutError || error == QModbusDevice::ReplyAbortedError)
+	{
+		return;
+	}
+	double ms = static_cast<double>(nsecs) / 1e6;
+	int bucket = 0;
+	while (bucket < m_bucketCount && ms > m_bucketBounds[bucket])
+	{
+		bucket++;
+	}
+	m_latencyBuckets[bucket].fetchAndAddRelaxed(1);
+	m_latencySumUs.fetchAndAddRelaxed(static_cast<quint64>(nsecs / 1000));
+}
+
+void QUaModbusMetrics::addConnect()
+{
+	m_connects.fetchAndAddRelaxed(1);
+}
+
+void QUaModbusMetrics::addReconnect()
+{
+	m_reconnects.fetchAndAddRelaxed(1);
+}
+
+void QUaModbusMetrics::addValueUpdate()
+{
+	m_valueUpdates.fetchAndAddRelaxed(1);
+}
+
+void QUaModbusMetrics::setEventLoopLag(const qint64 & nsecs)
+{
+	qint64 us = nsecs / 1000;
+	m_eventLoopLagUs.store(us);
+	qint64 max = m_eventLoopLagMaxUs.load();
+	while (us > max && !m_eventLoopLagMaxUs.testAndSetRelaxed(max, us, max))
+	{
+	}
+}
+
+void QUaModbusMetrics::addStall()
+{
+	m_stalls.fetchAndAddRelaxed(1);
+}
+
+QByteArray QUaModbusMetrics::toPrometheus()
+{
+	QByteArray out;
+	auto line = [&out](const QString &strLine) {
+		out += strLine.toUtf8();
+		out += '\n';
+	};
+	// requests
+	line("# HELP quamodbus_requests_total Modbus requests sent.");
+	line("# TYPE quamodbus_requests_total counter");
+	line(QString("quamodbus_requests_total{type=\"read\"} %1") .arg(m_requests[0].load()));
+	line(QString("quamodbus_requests_total{type=\"write\"} %1").arg(m_requests[1].load()));
+	// replies by error
+	auto metaError = QMetaEnum::fromType<QModbusDevice::Error>();
+	line("# HELP quamodbus_replies_total Modbus replies finished, by QModbusDevice::Error.");
+	line("# TYPE quamodbus_replies_total counter");
+	for (int i = 0; i < m_errorCount; i++)
+	{
+		line(QString("quamodbus_replies_total{error=\"%1\"} %2")
+			.arg(metaError.valueToKey(i))
+			.arg(m_errors[i].load()));
+	}
+	// latency
+	line("# HELP quamodbus_request_latency_seconds Time from request sent to reply received.");
+	line("# TYPE quamodbus_request_latency_seconds histogram");
+	quint64 cumulative = 0;
+	for (int i = 0; i <= m_bucketCount; i++)
+	{
+		cumulative += m_latencyBuckets[i].load();
+		QString strBound = i < m_bucketCount ? QString::number(m_bucketBounds[i] / 1000.0) : QString("+Inf");
+		line(QString("quamodbus_request_latency_seconds_bucket{le=\"%1\"} %2").arg(strBound).arg(cumulative));
+	}
+	line(QString("quamodbus_request_latency_seconds_sum %1")
+		.arg(static_cast<double>(m_latencySumUs.load()) / 1e6, 0, 'f', 6));
+	line(QString("quamodbus_request_latency_seconds_count %1").arg(cumulative));
+	// queue
+	line("# HELP quamodbus_queue_depth Requests sent and not yet replied.");
+	line("# TYPE quamodbus_queue_depth gauge");
+	line(QString("quamodbus_queue_depth %1").arg(qMax(Q_INT64_C(0), m_queueDepth.load())));
+	// connections
+	line("# HELP quamodbus_connects_total Successful connections to Modbus servers.");
+	line("# TYPE quamodbus_connects_total counter");
+	line(QString("quamodbus_connects_total %1").arg(m_connects.load()));
+	line("# HELP quamodbus_reconnects_total Connections lost without being requested.");
+	line("# TYPE quamodbus_reconnects_total counter");
+	line(QString("quamodbus_reconnects_total %1").arg(m_reconnects.load()));
+	// values
+	line("# HELP quamodbus_value_updates_total Value changes published to OPC UA.");
+	line("# TYPE quamodbus_value_updates_total counter");
+	line(QString("quamodbus_value_updates_total %1").arg(m_valueUpdates.load()));
+	// event loop, max is kept since start so concurrent exports do not reset each other
+	line("# HELP quamodbus_event_loop_lag_seconds OPC UA server thread event loop lag.");
+	line("# TYPE quamodbus_event_loop_lag_seconds gauge");
+	line(QString("quamodbus_event_loop_lag_seconds %1")
+		.arg(static_cast<double>(m_eventLoopLagUs.load()) / 1e6, 0, 'f', 6));
+	line("# HELP quamodbus_event_loop_lag_max_seconds Max OPC UA server thread event loop lag since start.");
+	line("# TYPE quamodbus_event_loop_lag_max_seconds gauge");
+	line(QString("quamodbus_event_loop_lag_max_seconds %1")
+		.arg(static_cast<double>(m_eventLoopLagMaxUs.load()) / 1e6, 0, 'f', 6));
+	line("# HELP quamodbus_event_loop_stalls_total Times an OPC UA or worker thread event loop was blocked above the stall threshold.");
+	line("# TYPE quamodbus_event_loop_stalls_total counter");
+	line(QString("quamodbus_event_loop_stalls_total %1").arg(m_stalls.load()));
+	// client locks, only if profiled
+	out += QUaModbusLockProfiler::toPrometheus();
+	return out;
+}
+
+QUaModbusMetricsExporter::QUaModbusMetricsExporter(QObject * parent)
+	: QObject(parent)
+{
+	QObject::connect(&m_server   , &QTcpServer::newConnection, this, &QUaModbusMetricsExporter::on_newConnection);
+	QObject::connect(&m_fileTimer, &QTimer::timeout          , this, &QUaModbusMetricsExporter::on_fileTimeout);
+	m_fileTimer.setInterval(QUaModbusMetricsExporter::m_filePeriod);
+}
+
+quint16 QUaModbusMetricsExporter::getPort() const
+{
+	return m_server.isListening() ? m_server.serverPort() : 0;
+}
+
+bool QUaModbusMetricsExporter::setPort(const quint16 & port)
+{
+	m_strError.clear();
+	if (m_server.isListening())
+	{
+		m_server.close();
+	}
+	if (port == 0)
+	{
+		return true;
+	}
+	// only local scrapers, use a reverse proxy to expose
+	if (!m_server.listen(QHostAddress::LocalHost, port))
+	{
+		m_strError = m_server.errorString();
+		return false;
+	}
+	return true;
+}
+
+QString QUaModbusMetricsExporter::getFilePath() const
+{
+	return m_strFilePath;
+}
+
+void QUaModbusMetricsExporter::setFilePath(const QString & strFilePath)
+{
+	m_strFilePath = strFilePath;
+	if (m_strFilePath.isEmpty())
+	{
+		m_fileTimer.stop();
+		return;
+	}
+	m_fileTimer.start();
+}
+
+QString QUaModbusMetricsExporter::errorString() const
+{
+	return m_strError;
+}
+
+void QUaModbusMetricsExporter::on_newConnection()
+{
+	while (m_server.hasPendingConnections())
+	{
+		QTcpSocket * socket = m_server.nextPendingConnection();
+		QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		// drop clients that stall, so they cannot hold sockets open forever
+		auto idleTimer = new QTimer(socket);
+		idleTimer->setSingleShot(true);
+		QObject::connect(idleTimer, &QTimer::timeout, socket, [socket]() {
+			socket->abort();
+			socket->deleteLater();
+		});
+		idleTimer->start(QUaModbusMetricsExporter::m_idleTimeout);
+		QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, idleTimer]() {
+			idleTimer->start(QUaModbusMetricsExporter::m_idleTimeout);
+			// wait for complete request header, any path is served
+			if (!socket->peek(socket->bytesAvailable()).contains("\r\n\r\n"))
+			{
+				// drop clients that never end the header, so it is not buffered without bound
+				if (socket->bytesAvailable() > QUaModbusMetricsExporter::m_maxHeaderSize)
+				{
+					socket->abort();
+					socket->deleteLater();
+				}
+				return;
+			}
+			socket->readAll();
+			QByteArray body = QUaModbusMetrics::toPrometheus();
+			QByteArray head = "HTTP/1.1 200 OK\r\n"
+				"Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+				"Connection: close\r\n"
+				"Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+			socket->write(head + body);
+			socket->disconnectFromHost();
+		});
+	}
+}
+
+void QUaModbusMetricsExporter::on_fileTimeout()
+{
+	// NOTE : QSaveFile writes to temporary and renames on commit, so scrapers never see partial files
+	QSaveFile file(m_strFilePath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		m_strError = file.errorString();
+		return;
+	}
+	file.write(QUaModbusMetrics::toPrometheus());
+	if (!file.commit())
+	{
+		m_strError = file.errorString();
+	}
+}
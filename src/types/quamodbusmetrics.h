@@ -0,0 +1,85 @@
+#ifndef QUAMODBUSMETRICS_H
+#define QUAMODBUSMETRICS_H
+
+#include <QObject>
+#include <QAtomicInteger>
+#include <QTcpServer>
+#include <QTimer>
+#include <QModbusDevice>
+
+// gateway wide metrics, hot paths only touch relaxed atomics (no locks)
+class QUaModbusMetrics
+{
+public:
+	// requests sent (read or write), broadcasts expect no reply, call in worker thread
+	static void addRequest(const bool &isWrite, const bool &expectsReply);
+	// reply finished, call in worker thread
+	static void addReply(const QModbusDevice::Error &error, const qint64 &nsecs);
+	// connection lifecycle, call in ua server thread
+	static void addConnect();
+	static void addReconnect();
+	// value changed, call in ua server thread
+	static void addValueUpdate();
+	// ua server event loop lag, call in ua server thread
+	static void setEventLoopLag(const qint64 &nsecs);
+	// any monitored event loop blocked above stall threshold, call in watchdog thread
+	static void addStall();
+
+	// text exposition format version 0.0.4
+	static QByteArray toPrometheus();
+
+	static const int m_errorCount = QModbusDevice::UnknownError + 1;
+	static const int m_bucketCount = 12;
+
+private:
+	static QAtomicInteger<quint64> m_requests[2];
+	static QAtomicInteger<quint64> m_errors[m_errorCount];
+	static QAtomicInteger<quint64> m_latencyBuckets[m_bucketCount + 1];
+	static QAtomicInteger<quint64> m_latencySumUs;
+	static QAtomicInteger<qint64>  m_queueDepth;
+	static QAtomicInteger<quint64> m_connects;
+	static QAtomicInteger<quint64> m_reconnects;
+	static QAtomicInteger<quint64> m_valueUpdates;
+	static QAtomicInteger<qint64>  m_eventLoopLagUs;
+	static QAtomicInteger<qint64>  m_eventLoopLagMaxUs;
+	static QAtomicInteger<quint64> m_stalls;
+
+	// upper bounds in ms, last bucket is +Inf
+	static const double m_bucketBounds[m_bucketCount];
+};
+
+// serves metrics over http on a local port and/or writes them atomically to a file
+class QUaModbusMetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+	explicit QUaModbusMetricsExporter(QObject *parent = nullptr);
+
+	// 0 is disabled
+	quint16 getPort() const;
+	bool    setPort(const quint16 &port);
+
+	// empty is disabled
+	QString getFilePath() const;
+	void    setFilePath(const QString &strFilePath);
+
+	QString errorString() const;
+
+private slots:
+	void on_newConnection();
+	void on_fileTimeout();
+
+private:
+	QTcpServer    m_server;
+	QString       m_strFilePath;
+	QString       m_strError;
+	QTimer        m_fileTimer;
+
+	static quint32 m_filePeriod;
+	// requests with a larger header or idle for longer (ms) are dropped
+	static qint64  m_maxHeaderSize;
+	static int     m_idleTimeout;
+};
+
+#endif // QUAMODBUSMETRICS_H
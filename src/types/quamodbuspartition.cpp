@@ -0,0 +1,204 @@
+#include "quamodbuspartition.h"
+#include "quamodbusclient.h"
+#include "quamodbusbusload.h"
+
+#include <QStringList>
+#include <algorithm>
+
+double  QUaModbusPartitionAdvisor::m_changeThreshold = 0.05;
+quint32 QUaModbusPartitionAdvisor::m_minSamples      = 20;
+quint32 QUaModbusPartitionAdvisor::m_maxSlowFactor   = 20;
+double  QUaModbusPartitionAdvisor::m_minSaving       = 0.2;
+
+namespace
+{
+
+// registers used by a value, relative to block start
+struct QUaModbusValueSpan
+{
+	QUaModbusValue * value;
+	int              start;
+	int              end;
+	bool             fast;
+};
+
+// values csv only carries name, type and address offset, anything else would be lost on import
+bool hasDefaultSettings(QUaModbusValue * value)
+{
+	bool isDefault = value->getCount() == 1 &&
+		!value->getOptimisticWrite() &&
+		value->getAbsoluteDeadband() == 0.0 &&
+		value->getPercentDeadband()  == 0.0 &&
+		value->getRangeLow()  == 0.0 &&
+		value->getRangeHigh() == 0.0;
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	isDefault = isDefault &&
+		value->getCyclicWritePeriod() == 0 &&
+		value->getCyclicWriteMode() == QUaModbusValue::CyclicWriteMode::Current;
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+	return isDefault;
+}
+
+// new block id unique in client and within 40 characters
+QString uniqueBlockId(QUaModbusDataBlock * source, const QString &strSuffix, QStringList &listTaken)
+{
+	auto blocks = source->client()->dataBlocks();
+	QString strBase = source->browseName().name().left(40 - strSuffix.count() - 2) + strSuffix;
+	QString strBlockId = strBase;
+	int index = 2;
+	while (listTaken.contains(strBlockId) || blocks->hasChild(strBlockId))
+	{
+		strBlockId = QString("%1%2").arg(strBase).arg(index++);
+	}
+	listTaken << strBlockId;
+	return strBlockId;
+}
+
+QUaModbusBlockPartition makePart(QUaModbusDataBlock * source, const QList<QUaModbusValueSpan> &spans, const quint32 &samplingTime, const QString &strBlockId)
+{
+	int start = spans.first().start;
+	int end   = spans.first().end;
+	for (auto &span : spans)
+	{
+		start = qMin(start, span.start);
+		end   = qMax(end  , span.end  );
+	}
+	QUaModbusBlockPartition part;
+	part.strClientId  = source->client()->browseName().name();
+	part.strBlockId   = strBlockId;
+	part.type         = source->getType();
+	part.address      = source->getAddress() + start;
+	part.size         = static_cast<quint32>(end - start);
+	part.samplingTime = samplingTime;
+	part.source       = source;
+	for (auto &span : spans)
+	{
+		part.values << QPair<QUaModbusValue*, int>(span.value, span.start - start);
+	}
+	return part;
+}
+
+} // namespace
+
+QUaModbusPartition QUaModbusPartitionAdvisor::propose(QUaModbusDataBlock * block)
+{
+	QUaModbusPartition partition;
+	partition.source        = block;
+	partition.busTimeBefore = 0.0;
+	partition.busTimeAfter  = 0.0;
+	auto client = block->client();
+	// only periodic reads with enough statistics
+	if (block->getBroadcast() || block->getTriggerOnly() || (block->getScanGroup() && client->getScanCycleTime() > 0))
+	{
+		return partition;
+	}
+	auto    counts  = block->getChangeCounts();
+	quint32 samples = block->getChangeSamples();
+	quint32 period  = block->getSamplingTime();
+	if (samples < QUaModbusPartitionAdvisor::m_minSamples || counts.isEmpty() || period == 0)
+	{
+		return partition;
+	}
+	// classify values by their most changing register
+	QList<QUaModbusValueSpan> spans;
+	double maxSlow = 0.0;
+	auto values = block->values()->values();
+	for (auto value : values)
+	{
+		QUaModbusValueSpan span;
+		span.value = value;
+		span.start = value->getAddressOffset();
+		span.end   = span.start + value->getRegistersUsed();
+		if (span.start < 0 || span.end <= span.start || span.end > counts.count() || !hasDefaultSettings(value))
+		{
+			// misconfigured or customized value, cannot move it safely
+			return partition;
+		}
+		double changes = 0.0;
+		for (int i = span.start; i < span.end; i++)
+		{
+			changes = qMax(changes, static_cast<double>(counts.at(i)) / samples);
+		}
+		span.fast = changes >= QUaModbusPartitionAdvisor::m_changeThreshold;
+		if (!span.fast)
+		{
+			maxSlow = qMax(maxSlow, changes);
+		}
+		spans << span;
+	}
+	if (spans.isEmpty())
+	{
+		return partition;
+	}
+	std::sort(spans.begin(), spans.end(), [](const QUaModbusValueSpan &a, const QUaModbusValueSpan &b) {
+		return a.start < b.start;
+	});
+	// changes per read grow with the period, keep slow registers below threshold
+	quint32 factor = QUaModbusPartitionAdvisor::m_maxSlowFactor;
+	if (maxSlow > 0.0)
+	{
+		factor = qMin(factor, static_cast<quint32>(QUaModbusPartitionAdvisor::m_changeThreshold / maxSlow));
+	}
+	if (factor < 2)
+	{
+		return partition;
+	}
+	quint32 slowPeriod = period * factor;
+	// fast part spans all fast values, including slow values overlapping it
+	int fastStart = -1;
+	int fastEnd   = -1;
+	for (auto &span : spans)
+	{
+		if (!span.fast)
+		{
+			continue;
+		}
+		fastStart = fastStart < 0 ? span.start : qMin(fastStart, span.start);
+		fastEnd   = qMax(fastEnd, span.end);
+	}
+	QList<QUaModbusValueSpan> spansBefore;
+	QList<QUaModbusValueSpan> spansFast;
+	QList<QUaModbusValueSpan> spansAfter;
+	for (auto &span : spans)
+	{
+		if (fastStart < 0 || span.end <= fastStart)
+		{
+			spansBefore << span;
+		}
+		else if (span.start >= fastEnd)
+		{
+			spansAfter << span;
+		}
+		else
+		{
+			spansFast << span;
+			fastEnd = qMax(fastEnd, span.end);
+		}
+	}
+	// all parts are new blocks, source block is left untouched
+	QStringList listTaken;
+	if (!spansFast.isEmpty())
+	{
+		partition.blocks << makePart(block, spansFast, period, uniqueBlockId(block, "_Fast", listTaken));
+	}
+	if (!spansBefore.isEmpty())
+	{
+		partition.blocks << makePart(block, spansBefore, slowPeriod, uniqueBlockId(block, "_Slow", listTaken));
+	}
+	if (!spansAfter.isEmpty())
+	{
+		partition.blocks << makePart(block, spansAfter, slowPeriod, uniqueBlockId(block, "_Slow", listTaken));
+	}
+	// compare link time, measured latency is kept for smaller parts (conservative for rtu)
+	double latency = block->diagnostics()->getSample().latencyP50;
+	partition.busTimeBefore = 1000.0 * QUaModbusBusLoad::readTime(client, block->getType(), block->getSize(), latency) / period;
+	for (auto &part : partition.blocks)
+	{
+		partition.busTimeAfter += 1000.0 * QUaModbusBusLoad::readTime(client, part.type, part.size, latency) / part.samplingTime;
+	}
+	if (partition.busTimeAfter > partition.busTimeBefore * (1.0 - QUaModbusPartitionAdvisor::m_minSaving))
+	{
+		partition.blocks.clear();
+	}
+	return partition;
+}
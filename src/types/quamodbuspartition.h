@@ -0,0 +1,55 @@
+#ifndef QUAMODBUSPARTITION_H
+#define QUAMODBUSPARTITION_H
+
+#include <QString>
+#include <QList>
+
+#include "quamodbusdatablock.h"
+#include "quamodbusvalue.h"
+
+// one new block of a proposed layout, values keep their original names and types
+struct QUaModbusBlockPartition
+{
+	QString              strClientId;
+	QString              strBlockId;
+	QModbusDataBlockType type;
+	int                  address;
+	quint32              size;
+	quint32              samplingTime;
+	QUaModbusDataBlock * source;
+	QList<QPair<QUaModbusValue*, int>> values; // value, address offset in this block
+};
+
+// proposed split of one block into fast and slow blocks
+struct QUaModbusPartition
+{
+	QUaModbusDataBlock * source;
+	double busTimeBefore; // ms of link time per second
+	double busTimeAfter;
+	QList<QUaModbusBlockPartition> blocks;
+};
+
+// proposes splitting blocks into fast and slow parts from observed register change statistics
+// registers that changed in at least m_changeThreshold of the reads keep the block sampling time,
+// the rest are read up to m_maxSlowFactor times slower, the factor is chosen so that each slow
+// register is expected to change in at most m_changeThreshold of the slower reads
+// NOTE : every part gets a new block id so the source block keeps working until it is removed,
+//        blocks with values using settings the values csv cannot carry are not split
+// NOTE : only call in ua server thread
+class QUaModbusPartitionAdvisor
+{
+public:
+	// empty blocks list if block should not be split
+	static QUaModbusPartition propose(QUaModbusDataBlock * block);
+
+	// fraction of reads in which a register changed to be considered fast
+	static double  m_changeThreshold;
+	// minimum compared reads before proposing
+	static quint32 m_minSamples;
+	// slow blocks are read at most this many times slower
+	static quint32 m_maxSlowFactor;
+	// minimum fraction of link time saved to propose a split
+	static double  m_minSaving;
+};
+
+#endif // QUAMODBUSPARTITION_H
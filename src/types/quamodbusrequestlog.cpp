@@ -0,0 +1,314 @@
+#include "quamodbusrequestlog.h"
+
+#include <QDateTime>
+#include <QDataStream>
+#include <QHostAddress>
+#include <QMutexLocker>
+#include <algorithm>
+
+int QUaModbusRequestLog::m_capacity = 2048;
+
+namespace
+{
+
+const quint32 pcapLinkRaw   = 101; // LINKTYPE_RAW, ipv4 without link layer
+const quint32 pcapLinkUser0 = 147; // LINKTYPE_USER0, decode as mbrtu in wireshark
+const quint16 gatewayPort   = 49152;
+
+QByteArray pcapHeader(const quint32 &linkType)
+{
+	QByteArray bytes;
+	QDataStream out(&bytes, QIODevice::WriteOnly);
+	out.setByteOrder(QDataStream::LittleEndian);
+	out << quint32(0xa1b2c3d4) << quint16(2) << quint16(4) << qint32(0) << quint32(0) << quint32(65535) << linkType;
+	return bytes;
+}
+
+void pcapRecord(QByteArray &bytes, const qint64 &timestamp, const QByteArray &packet)
+{
+	QDataStream out(&bytes, QIODevice::Append);
+	out.setByteOrder(QDataStream::LittleEndian);
+	out << quint32(timestamp / 1000000) << quint32(timestamp % 1000000)
+		<< quint32(packet.size()) << quint32(packet.size());
+	out.writeRawData(packet.constData(), packet.size());
+}
+
+quint32 onesSum(const QByteArray &bytes, quint32 sum = 0)
+{
+	for (int i = 0; i + 1 < bytes.size(); i += 2)
+	{
+		sum += (static_cast<quint8>(bytes.at(i)) << 8) | static_cast<quint8>(bytes.at(i + 1));
+	}
+	if (bytes.size() % 2)
+	{
+		sum += static_cast<quint8>(bytes.at(bytes.size() - 1)) << 8;
+	}
+	return sum;
+}
+
+quint16 onesComplement(quint32 sum)
+{
+	while (sum >> 16)
+	{
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+	return static_cast<quint16>(~sum);
+}
+
+void appendBigEndian16(QByteArray &bytes, const quint16 &value)
+{
+	bytes.append(static_cast<char>(value >> 8));
+	bytes.append(static_cast<char>(value & 0xFF));
+}
+
+void appendBigEndian32(QByteArray &bytes, const quint32 &value)
+{
+	appendBigEndian16(bytes, static_cast<quint16>(value >> 16));
+	appendBigEndian16(bytes, static_cast<quint16>(value & 0xFFFF));
+}
+
+QByteArray ipv4Packet(const quint32 &src, const quint32 &dst, const quint16 &srcPort, const quint16 &dstPort,
+	                  const quint32 &seq, const quint32 &ack, const quint16 &ipId, const QByteArray &payload)
+{
+	// tcp header, psh + ack
+	QByteArray tcp;
+	appendBigEndian16(tcp, srcPort);
+	appendBigEndian16(tcp, dstPort);
+	appendBigEndian32(tcp, seq);
+	appendBigEndian32(tcp, ack);
+	tcp.append(static_cast<char>(5 << 4));
+	tcp.append(static_cast<char>(0x18));
+	appendBigEndian16(tcp, 65535);
+	appendBigEndian16(tcp, 0); // checksum, set below
+	appendBigEndian16(tcp, 0);
+	tcp += payload;
+	QByteArray pseudo;
+	appendBigEndian32(pseudo, src);
+	appendBigEndian32(pseudo, dst);
+	appendBigEndian16(pseudo, 6);
+	appendBigEndian16(pseudo, static_cast<quint16>(tcp.size()));
+	quint16 tcpChecksum = onesComplement(onesSum(tcp, onesSum(pseudo)));
+	tcp[16] = static_cast<char>(tcpChecksum >> 8);
+	tcp[17] = static_cast<char>(tcpChecksum & 0xFF);
+	// ipv4 header, no options, dont fragment
+	QByteArray ip;
+	ip.append(static_cast<char>(0x45));
+	ip.append(static_cast<char>(0));
+	appendBigEndian16(ip, static_cast<quint16>(20 + tcp.size()));
+	appendBigEndian16(ip, ipId);
+	appendBigEndian16(ip, 0x4000);
+	ip.append(static_cast<char>(64));
+	ip.append(static_cast<char>(6));
+	appendBigEndian16(ip, 0); // checksum, set below
+	appendBigEndian32(ip, src);
+	appendBigEndian32(ip, dst);
+	quint16 ipChecksum = onesComplement(onesSum(ip));
+	ip[10] = static_cast<char>(ipChecksum >> 8);
+	ip[11] = static_cast<char>(ipChecksum & 0xFF);
+	return ip + tcp;
+}
+
+} // namespace
+
+QUaModbusRequestLog::QUaModbusRequestLog()
+{
+	m_next          = 0;
+	m_transactionId = 0;
+	m_enabled       = false;
+}
+
+bool QUaModbusRequestLog::isEnabled() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_enabled;
+}
+
+void QUaModbusRequestLog::setEnabled(const bool & enabled)
+{
+	QMutexLocker locker(&m_mutex);
+	if (enabled && m_ring.isEmpty())
+	{
+		m_ring.resize(QUaModbusRequestLog::m_capacity);
+	}
+	m_enabled = enabled;
+}
+
+void QUaModbusRequestLog::clear()
+{
+	QMutexLocker locker(&m_mutex);
+	m_next = 0;
+}
+
+quint64 QUaModbusRequestLog::memoryUsage() const
+{
+	QMutexLocker locker(&m_mutex);
+	return static_cast<quint64>(m_ring.capacity()) * sizeof(QUaModbusLogRecord);
+}
+
+QUaModbusLogRecord & QUaModbusRequestLog::nextFrame()
+{
+	// NOTE : call with mutex locked and ring allocated
+	auto & frame = m_ring[static_cast<int>(m_next % static_cast<quint32>(m_ring.count()))];
+	m_next++;
+	frame.timestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+	return frame;
+}
+
+quint16 QUaModbusRequestLog::addRequest(const QModbusDataUnit & unit, const bool & isWrite, const quint8 & unitId)
+{
+	QMutexLocker locker(&m_mutex);
+	if (!m_enabled)
+	{
+		return 0;
+	}
+	auto & frame = this->nextFrame();
+	// NOTE : 0 is reserved for not logged
+	m_transactionId = m_transactionId == 0xFFFF ? 1 : m_transactionId + 1;
+	frame.transactionId = m_transactionId;
+	frame.unitId        = unitId;
+	frame.isResponse    = false;
+	// rebuild request pdu the same way QModbusClient encodes it
+	auto   type  = unit.registerType();
+	int    count = static_cast<int>(unit.valueCount());
+	bool   bits  = type == QModbusDataUnit::Coils || type == QModbusDataUnit::DiscreteInputs;
+	quint8 code  = 0;
+	if (!isWrite)
+	{
+		code = type == QModbusDataUnit::Coils            ? 0x01 :
+		       type == QModbusDataUnit::DiscreteInputs   ? 0x02 :
+		       type == QModbusDataUnit::HoldingRegisters ? 0x03 : 0x04;
+	}
+	else
+	{
+		code = bits ? (count == 1 ? 0x05 : 0x0F) : (count == 1 ? 0x06 : 0x10);
+	}
+	quint8 * pdu = frame.pdu;
+	int len = 0;
+	pdu[len++] = code;
+	pdu[len++] = static_cast<quint8>(unit.startAddress() >> 8);
+	pdu[len++] = static_cast<quint8>(unit.startAddress() & 0xFF);
+	if (!isWrite || count > 1)
+	{
+		pdu[len++] = static_cast<quint8>(count >> 8);
+		pdu[len++] = static_cast<quint8>(count & 0xFF);
+	}
+	if (isWrite && count == 1)
+	{
+		quint16 value = bits ? (unit.value(0) ? 0xFF00 : 0x0000) : unit.value(0);
+		pdu[len++] = static_cast<quint8>(value >> 8);
+		pdu[len++] = static_cast<quint8>(value & 0xFF);
+	}
+	else if (isWrite)
+	{
+		int byteCount = qMin(bits ? (count + 7) / 8 : 2 * count, 246);
+		pdu[len++] = static_cast<quint8>(byteCount);
+		std::fill(pdu + len, pdu + len + byteCount, 0);
+		for (int i = 0; i < count && (bits ? i / 8 : 2 * i + 1) < byteCount; i++)
+		{
+			if (bits)
+			{
+				pdu[len + i / 8] |= static_cast<quint8>((unit.value(i) ? 1 : 0) << (i % 8));
+				continue;
+			}
+			pdu[len + 2 * i    ] = static_cast<quint8>(unit.value(i) >> 8);
+			pdu[len + 2 * i + 1] = static_cast<quint8>(unit.value(i) & 0xFF);
+		}
+		len += byteCount;
+	}
+	frame.length = static_cast<quint16>(len);
+	return frame.transactionId;
+}
+
+void QUaModbusRequestLog::addResponse(const QModbusResponse & response, const quint16 & transactionId, const quint8 & unitId)
+{
+	QMutexLocker locker(&m_mutex);
+	if (!m_enabled || !response.isValid())
+	{
+		return;
+	}
+	auto & frame = this->nextFrame();
+	frame.transactionId = transactionId;
+	frame.unitId        = unitId;
+	frame.isResponse    = true;
+	auto data = response.data();
+	int  len  = qMin(data.size(), 252);
+	frame.pdu[0] = static_cast<quint8>(response.functionCode() | (response.isException() ? 0x80 : 0x00));
+	std::copy(data.constData(), data.constData() + len, reinterpret_cast<char*>(frame.pdu + 1));
+	frame.length = static_cast<quint16>(1 + len);
+}
+
+QVector<QUaModbusLogRecord> QUaModbusRequestLog::records() const
+{
+	QMutexLocker locker(&m_mutex);
+	QVector<QUaModbusLogRecord> frames;
+	if (m_ring.isEmpty())
+	{
+		return frames;
+	}
+	quint32 capacity = static_cast<quint32>(m_ring.count());
+	quint32 count    = qMin(m_next, capacity);
+	frames.reserve(static_cast<int>(count));
+	for (quint32 i = m_next - count; i != m_next; i++)
+	{
+		frames << m_ring.at(static_cast<int>(i % capacity));
+	}
+	return frames;
+}
+
+QByteArray QUaModbusRequestLog::toPcapTcp(const QVector<QUaModbusLogRecord>& frames, const QString & strDeviceAddress, const quint16 & devicePort)
+{
+	// NOTE : transaction ids are the log's own, QModbusTcpClient does not expose its own
+	QHostAddress device(strDeviceAddress);
+	quint32 deviceIp  = device.protocol() == QAbstractSocket::IPv4Protocol ? device.toIPv4Address() : 0x7F000002;
+	quint32 gatewayIp = 0x7F000001;
+	quint32 gatewaySeq = 1;
+	quint32 deviceSeq  = 1;
+	quint16 ipId = 0;
+	QByteArray bytes = pcapHeader(pcapLinkRaw);
+	for (auto &frame : frames)
+	{
+		QByteArray adu;
+		appendBigEndian16(adu, frame.transactionId);
+		appendBigEndian16(adu, 0);
+		appendBigEndian16(adu, static_cast<quint16>(frame.length + 1));
+		adu.append(static_cast<char>(frame.unitId));
+		adu.append(reinterpret_cast<const char*>(frame.pdu), frame.length);
+		QByteArray packet = frame.isResponse ?
+			ipv4Packet(deviceIp, gatewayIp, devicePort, gatewayPort, deviceSeq, gatewaySeq, ++ipId, adu) :
+			ipv4Packet(gatewayIp, deviceIp, gatewayPort, devicePort, gatewaySeq, deviceSeq, ++ipId, adu);
+		(frame.isResponse ? deviceSeq : gatewaySeq) += static_cast<quint32>(adu.size());
+		pcapRecord(bytes, frame.timestamp, packet);
+	}
+	return bytes;
+}
+
+QByteArray QUaModbusRequestLog::toPcapRtu(const QVector<QUaModbusLogRecord>& frames)
+{
+	QByteArray bytes = pcapHeader(pcapLinkUser0);
+	for (auto &frame : frames)
+	{
+		QByteArray adu;
+		adu.append(static_cast<char>(frame.unitId));
+		adu.append(reinterpret_cast<const char*>(frame.pdu), frame.length);
+		quint16 crc = QUaModbusRequestLog::crc16(reinterpret_cast<const quint8*>(adu.constData()), adu.size());
+		// NOTE : rtu crc is sent low byte first
+		adu.append(static_cast<char>(crc & 0xFF));
+		adu.append(static_cast<char>(crc >> 8));
+		pcapRecord(bytes, frame.timestamp, adu);
+	}
+	return bytes;
+}
+
+quint16 QUaModbusRequestLog::crc16(const quint8 * data, const int & length)
+{
+	quint16 crc = 0xFFFF;
+	for (int i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x0001) ? static_cast<quint16>((crc >> 1) ^ 0xA001) : static_cast<quint16>(crc >> 1);
+		}
+	}
+	return crc;
+}
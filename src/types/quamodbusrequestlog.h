@@ -0,0 +1,65 @@
+#ifndef QUAMODBUSREQUESTLOG_H
+#define QUAMODBUSREQUESTLOG_H
+
+#include <QVector>
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+#include <QModbusDataUnit>
+#include <QModbusPdu>
+
+// one logged request or response, fixed size so the ring never allocates while recording
+// NOTE : pdu is rebuilt from QModbusDataUnit/QModbusResponse, not taken off the wire,
+//        so bad crcs, malformed frames and the device's transaction ids are not visible
+struct QUaModbusLogRecord
+{
+	qint64  timestamp;     // us since epoch
+	quint16 transactionId; // assigned by log, pairs request with response
+	quint8  unitId;
+	bool    isResponse;
+	quint16 length;        // pdu bytes used
+	quint8  pdu[253];      // max modbus pdu size
+};
+
+// preallocated ring of logged requests and responses for one client
+// NOTE : record in worker thread, export from any thread
+class QUaModbusRequestLog
+{
+public:
+	QUaModbusRequestLog();
+
+	bool isEnabled() const;
+	// allocates ring on first enable, disabling keeps logged records
+	void setEnabled(const bool &enabled);
+	void clear();
+
+	// returns transaction id to pair the response with
+	quint16 addRequest (const QModbusDataUnit &unit, const bool &isWrite, const quint8 &unitId);
+	void    addResponse(const QModbusResponse &response, const quint16 &transactionId, const quint8 &unitId);
+
+	// oldest first
+	QVector<QUaModbusLogRecord> records() const;
+
+	// bytes allocated by ring
+	quint64 memoryUsage() const;
+
+	// modbus/tcp inside synthetic ipv4/tcp packets (DLT_RAW)
+	static QByteArray toPcapTcp(const QVector<QUaModbusLogRecord> &frames, const QString &strDeviceAddress, const quint16 &devicePort);
+	// modbus rtu adu with recomputed crc (DLT_USER0)
+	static QByteArray toPcapRtu(const QVector<QUaModbusLogRecord> &frames);
+
+	static quint16 crc16(const quint8 *data, const int &length);
+
+	static int m_capacity;
+
+private:
+	mutable QMutex          m_mutex;
+	QVector<QUaModbusLogRecord> m_ring;
+	quint32                 m_next;
+	quint16                 m_transactionId;
+	bool                    m_enabled;
+
+	QUaModbusLogRecord & nextFrame();
+};
+
+#endif // QUAMODBUSREQUESTLOG_H
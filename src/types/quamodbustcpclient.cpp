@@ -1,9 +1,14 @@
 #include "quamodbustcpclient.h"
 
+#include <QTimer>
+#include <QRegularExpression>
+
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #endif // QUA_ACCESS_CONTROL
 
+quint32 QUaModbusTcpClient::m_standbyRetryPeriod = 2000;
+
 QUaModbusTcpClient::QUaModbusTcpClient(QUaServer *server)
 	: QUaModbusClient(server)
 {
@@ -13,75 +18,413 @@ QUaModbusTcpClient::QUaModbusTcpClient(QUaServer *server)
 	networkAddress()->setValue("127.0.0.1");
 	networkPort   ()->setDataType(QMetaType::UShort);
 	networkPort   ()->setValue(502);
+	backupEndpoints ()->setValue("");
+	warmStandby     ()->setValue(false);
+	failoverTimeouts()->setDataType(QMetaType::UInt);
+	failoverTimeouts()->setValue(2);
 	// set initial conditions
 	networkAddress()->setWriteAccess(true);
 	networkPort   ()->setWriteAccess(true);
+	backupEndpoints ()->setWriteAccess(true);
+	warmStandby     ()->setWriteAccess(true);
+	failoverTimeouts()->setWriteAccess(true);
+	m_activeIndex    = 0;
+	m_standbyEnabled = false;
+	m_standbyIndex   = 0;
+	m_lastState      = QModbusDevice::UnconnectedState;
+	m_standbyReady   = false;
+	// to safely update active endpoint in ua server thread
+	QObject::connect(this, &QUaModbusTcpClient::updateActiveEndpoint, this, &QUaModbusTcpClient::on_updateActiveEndpoint);
+	QObject::connect(this, &QUaModbusTcpClient::updateStandbyReady  , this, &QUaModbusTcpClient::on_updateStandbyReady  );
 	// instantiate client
 	this->resetModbusClient();
+	this->updateEndpoints();
 	// handle changes
 	QObject::connect(networkAddress(), &QUaBaseVariable::valueChanged, this, &QUaModbusTcpClient::on_networkAddressChanged, Qt::QueuedConnection);
 	QObject::connect(networkPort()   , &QUaBaseVariable::valueChanged, this, &QUaModbusTcpClient::on_networkPortChanged   , Qt::QueuedConnection);
+	QObject::connect(backupEndpoints() , &QUaBaseVariable::valueChanged, this, &QUaModbusTcpClient::on_backupEndpointsChanged , Qt::QueuedConnection);
+	QObject::connect(warmStandby()     , &QUaBaseVariable::valueChanged, this, &QUaModbusTcpClient::on_warmStandbyChanged     , Qt::QueuedConnection);
+	QObject::connect(failoverTimeouts(), &QUaBaseVariable::valueChanged, this, &QUaModbusTcpClient::on_failoverTimeoutsChanged, Qt::QueuedConnection);
 	// set descriptions
 	/*
 	networkAddress()->setDescription(tr("Network address (IP address or domain name) of the Modbus server."));
 	networkPort()   ->setDescription(tr("Network port (TCP port) of the Modbus server."));
+	backupEndpoints() ->setDescription(tr("Redundant endpoints (address:port) of the same Modbus server, separated by commas."));
+	warmStandby()     ->setDescription(tr("Whether to keep a connection open to the next endpoint for fast failover."));
+	failoverTimeouts()->setDescription(tr("Consecutive timeouts that trigger a failover to the next endpoint (0 disables failover)."));
+	activeEndpoint()  ->setDescription(tr("Endpoint currently used to communicate with the Modbus server."));
 	*/
 }
 
 QUaProperty * QUaModbusTcpClient::networkAddress() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
 	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaProperty>("NetworkAddress");
 }
 
 QUaProperty * QUaModbusTcpClient::networkPort() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
 	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaProperty>("NetworkPort");
 }
 
+QUaProperty * QUaModbusTcpClient::backupEndpoints() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaProperty>("BackupEndpoints");
+}
+
+QUaProperty * QUaModbusTcpClient::warmStandby() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaProperty>("WarmStandby");
+}
+
+QUaProperty * QUaModbusTcpClient::failoverTimeouts() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaProperty>("FailoverTimeouts");
+}
+
+QUaBaseDataVariable * QUaModbusTcpClient::activeEndpoint() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return const_cast<QUaModbusTcpClient*>(this)->browseChild<QUaBaseDataVariable>("ActiveEndpoint");
+}
+
 QString QUaModbusTcpClient::getNetworkAddress() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
 	return this->networkAddress()->value().toString();
 }
 
 void QUaModbusTcpClient::setNetworkAddress(const QString & strNetworkAddress)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->networkAddress()->setValue(strNetworkAddress);
 	this->on_networkAddressChanged(strNetworkAddress);
 }
 
 quint16 QUaModbusTcpClient::getNetworkPort() const
 {
-	QMutexLocker locker(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
 	return this->networkPort()->value().value<quint16>();
 }
 
 void QUaModbusTcpClient::setNetworkPort(const quint16 & networkPort)
 {
-	QMutexLocker locker(&m_mutex);
+	QUA_MODBUS_LOCKER(&m_mutex);
 	this->networkPort()->setValue(networkPort);
 	this->on_networkPortChanged(networkPort);
 }
 
+QString QUaModbusTcpClient::getBackupEndpoints() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return this->backupEndpoints()->value().toString();
+}
+
+void QUaModbusTcpClient::setBackupEndpoints(const QString & strBackupEndpoints)
+{
+	QUA_MODBUS_LOCKER(&m_mutex);
+	this->backupEndpoints()->setValue(strBackupEndpoints);
+	this->on_backupEndpointsChanged(strBackupEndpoints);
+}
+
+bool QUaModbusTcpClient::getWarmStandby() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return this->warmStandby()->value().toBool();
+}
+
+void QUaModbusTcpClient::setWarmStandby(const bool & warmStandby)
+{
+	QUA_MODBUS_LOCKER(&m_mutex);
+	this->warmStandby()->setValue(warmStandby);
+	this->on_warmStandbyChanged(warmStandby);
+}
+
+quint32 QUaModbusTcpClient::getFailoverTimeouts() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return this->failoverTimeouts()->value().value<quint32>();
+}
+
+void QUaModbusTcpClient::setFailoverTimeouts(const quint32 & failoverTimeouts)
+{
+	QUA_MODBUS_LOCKER(&m_mutex);
+	this->failoverTimeouts()->setValue(failoverTimeouts);
+	this->on_failoverTimeoutsChanged(failoverTimeouts);
+}
+
+QString QUaModbusTcpClient::getActiveEndpoint() const
+{
+	QUA_MODBUS_LOCKER(&(const_cast<QUaModbusTcpClient*>(this)->m_mutex));
+	return this->activeEndpoint()->value().toString();
+}
+
+QList<QModbusEndpoint> QUaModbusTcpClient::endpoints() const
+{
+	// primary endpoint always first
+	QList<QModbusEndpoint> listEndpoints;
+	listEndpoints << QModbusEndpoint(this->getNetworkAddress(), this->getNetworkPort());
+	listEndpoints << QUaModbusTcpClient::parseEndpoints(this->getBackupEndpoints(), this->getNetworkPort());
+	return listEndpoints;
+}
+
+QList<QModbusEndpoint> QUaModbusTcpClient::parseEndpoints(const QString & strEndpoints, const quint16 & defaultPort)
+{
+	QList<QModbusEndpoint> listEndpoints;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+	auto listStrEndpoints = strEndpoints.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+#else
+	auto listStrEndpoints = strEndpoints.split(QRegularExpression("[,;\\s]+"), QString::SkipEmptyParts);
+#endif
+	for (auto strEndpoint : listStrEndpoints)
+	{
+		auto listParts = strEndpoint.split(":");
+		auto strAddress = listParts.at(0).trimmed();
+		if (strAddress.isEmpty())
+		{
+			continue;
+		}
+		bool bOK = false;
+		quint16 port = listParts.count() > 1 ? listParts.at(1).trimmed().toUShort(&bOK) : 0;
+		listEndpoints << QModbusEndpoint(strAddress, bOK ? port : defaultPort);
+	}
+	return listEndpoints;
+}
+
 void QUaModbusTcpClient::resetModbusClient()
 {
     m_workerThread.execInThread([this]() {
+		// close standby connection, if any (e.g. requested disconnection)
+		this->closeStandby();
 		// instantiate in thread so it runs on the thread
 		m_modbusClient.reset(new QModbusTcpClient(nullptr), [](QObject* client) {
 			client->deleteLater();
 		});
-		// defaults
+		// defaults (always start with primary endpoint)
+		m_activeIndex = 0;
+		m_lastState   = QModbusDevice::UnconnectedState;
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, this->getNetworkAddress());
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkPortParameter   , this->getNetworkPort   ());
+		emit this->updateActiveEndpoint(QString("%1:%2").arg(this->getNetworkAddress()).arg(this->getNetworkPort()));
 		// setup client (call base class method)
         this->QUaModbusClient::resetModbusClient();
 		QObject::connect(m_modbusClient.data(), &QModbusClient::stateChanged, this, &QUaModbusTcpClient::on_stateChanged, Qt::QueuedConnection);
+		// handle redundant endpoints in thread
+		this->watchEndpoint();
 	});
 }
 
+bool QUaModbusTcpClient::failover(const quint32 & consecutiveTimeouts)
+{
+	auto failoverTimeouts = this->getFailoverTimeouts();
+	auto endpointCount    = static_cast<quint32>(this->endpoints().count());
+	if (failoverTimeouts == 0 || endpointCount < 2)
+	{
+		return false;
+	}
+	// nothing to try without an open standby connection or a reconnection to rotate endpoints
+	auto keepConnecting = this->getKeepConnecting();
+	if (!m_standbyReady && !keepConnecting)
+	{
+		return false;
+	}
+	// try each endpoint once before giving up
+	if (consecutiveTimeouts >= failoverTimeouts * endpointCount)
+	{
+		return false;
+	}
+	if (consecutiveTimeouts % failoverTimeouts != 0)
+	{
+		return true;
+	}
+	m_workerThread.execInThread([this, keepConnecting]() {
+		// fast path, switch to already open standby connection
+		if (this->switchToStandby())
+		{
+			return;
+		}
+		// slow path, reconnect to next endpoint (rotated when closed)
+		if (!keepConnecting)
+		{
+			return;
+		}
+		m_modbusClient->disconnectDevice();
+	});
+	return true;
+}
+
+void QUaModbusTcpClient::updateEndpoints()
+{
+	auto listEndpoints  = this->endpoints();
+	auto standbyEnabled = this->getWarmStandby();
+	m_workerThread.execInThread([this, listEndpoints, standbyEnabled]() {
+		m_endpoints      = listEndpoints;
+		m_standbyEnabled = standbyEnabled;
+		if (m_activeIndex >= m_endpoints.count())
+		{
+			m_activeIndex = 0;
+		}
+		auto endpoint = m_endpoints.at(m_activeIndex);
+		emit this->updateActiveEndpoint(QString("%1:%2").arg(endpoint.first).arg(endpoint.second));
+		// re-evaluate standby with new endpoints
+		if (m_modbusClient->state() == QModbusDevice::ConnectedState)
+		{
+			this->openStandby();
+		}
+		else
+		{
+			this->closeStandby();
+		}
+	});
+}
+
+void QUaModbusTcpClient::watchEndpoint()
+{
+	// NOTE : exec'd in worker thread
+	auto client = m_modbusClient.data();
+	QObject::connect(client, &QModbusClient::stateChanged, client,
+	[this, client](QModbusDevice::State state) {
+		// ignore connections replaced by failover
+		if (client != m_modbusClient.data())
+		{
+			return;
+		}
+		auto lastState = m_lastState;
+		m_lastState = state;
+		if (state == QModbusDevice::ConnectedState)
+		{
+			this->openStandby();
+			return;
+		}
+		if (state != QModbusDevice::UnconnectedState)
+		{
+			return;
+		}
+		this->closeStandby();
+		// next connection attempt goes to next endpoint
+		if (m_disconnectRequested.load() || lastState == QModbusDevice::UnconnectedState || m_endpoints.count() < 2)
+		{
+			return;
+		}
+		this->applyEndpoint((m_activeIndex + 1) % m_endpoints.count());
+	});
+}
+
+void QUaModbusTcpClient::applyEndpoint(const int & index)
+{
+	// NOTE : exec'd in worker thread
+	if (index < 0 || index >= m_endpoints.count())
+	{
+		return;
+	}
+	m_activeIndex = index;
+	auto endpoint = m_endpoints.at(index);
+	m_modbusClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, endpoint.first );
+	m_modbusClient->setConnectionParameter(QModbusDevice::NetworkPortParameter   , endpoint.second);
+	emit this->updateActiveEndpoint(QString("%1:%2").arg(endpoint.first).arg(endpoint.second));
+}
+
+void QUaModbusTcpClient::openStandby()
+{
+	// NOTE : exec'd in worker thread
+	this->closeStandby();
+	if (!m_standbyEnabled || m_endpoints.count() < 2)
+	{
+		return;
+	}
+	m_standbyIndex = (m_activeIndex + 1) % m_endpoints.count();
+	auto endpoint  = m_endpoints.at(m_standbyIndex);
+	m_standbyClient.reset(new QModbusTcpClient(nullptr), [](QObject* client) {
+		client->deleteLater();
+	});
+	m_standbyClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, endpoint.first );
+	m_standbyClient->setConnectionParameter(QModbusDevice::NetworkPortParameter   , endpoint.second);
+	// keep standby connection open while it is the standby
+	auto standby = m_standbyClient.data();
+	QObject::connect(standby, &QModbusClient::stateChanged, standby,
+	[this, standby](QModbusDevice::State state) {
+		if (standby != m_standbyClient.data())
+		{
+			return;
+		}
+		if (state == QModbusDevice::ConnectedState)
+		{
+			emit this->updateStandbyReady(true);
+			return;
+		}
+		if (state != QModbusDevice::UnconnectedState)
+		{
+			return;
+		}
+		emit this->updateStandbyReady(false);
+		QTimer::singleShot(QUaModbusTcpClient::m_standbyRetryPeriod, standby,
+		[this, standby]() {
+			if (standby != m_standbyClient.data())
+			{
+				return;
+			}
+			standby->connectDevice();
+		});
+	});
+	standby->connectDevice();
+}
+
+void QUaModbusTcpClient::closeStandby()
+{
+	// NOTE : exec'd in worker thread
+	if (!m_standbyClient)
+	{
+		return;
+	}
+	// NOTE : reset before disconnecting, so retry logic ignores it
+	auto standby = m_standbyClient;
+	m_standbyClient.reset();
+	standby->disconnectDevice();
+	emit this->updateStandbyReady(false);
+}
+
+bool QUaModbusTcpClient::switchToStandby()
+{
+	// NOTE : exec'd in worker thread
+	if (!m_standbyClient || m_standbyClient->state() != QModbusDevice::ConnectedState)
+	{
+		return false;
+	}
+	auto oldClient = m_modbusClient;
+	// stop listening to old connection, else its closing would reach client state
+	QObject::disconnect(oldClient.data(), nullptr, this, nullptr);
+	QObject::disconnect(oldClient.data(), nullptr, oldClient.data(), nullptr);
+	// promote standby, client state remains connected
+	m_modbusClient = m_standbyClient;
+	m_standbyClient.reset();
+	emit this->updateStandbyReady(false);
+	QObject::disconnect(m_modbusClient.data(), nullptr, m_modbusClient.data(), nullptr);
+	m_activeIndex = m_standbyIndex;
+	m_lastState   = QModbusDevice::ConnectedState;
+	auto endpoint = m_endpoints.at(m_activeIndex);
+	emit this->updateActiveEndpoint(QString("%1:%2").arg(endpoint.first).arg(endpoint.second));
+	// subscribe to new connection
+	this->QUaModbusClient::resetModbusClient();
+	QObject::connect(m_modbusClient.data(), &QModbusClient::stateChanged, this, &QUaModbusTcpClient::on_stateChanged, Qt::QueuedConnection);
+	this->watchEndpoint();
+	// close old connection and pre-open standby to next endpoint
+	oldClient->disconnectDevice();
+	this->openStandby();
+	return true;
+}
+
+QByteArray QUaModbusTcpClient::recordsToPcap(const QVector<QUaModbusLogRecord>& frames) const
+{
+	// frames are attributed to the endpoint in use at export time
+	auto endpoints = QUaModbusTcpClient::parseEndpoints(this->getActiveEndpoint(), this->getNetworkPort());
+	auto endpoint  = endpoints.isEmpty() ? QModbusEndpoint(this->getNetworkAddress(), this->getNetworkPort()) : endpoints.first();
+	return QUaModbusRequestLog::toPcapTcp(frames, endpoint.first, endpoint.second);
+}
+
 QDomElement QUaModbusTcpClient::toDomElement(QDomDocument & domDoc) const
 {
 	// add client element
@@ -99,6 +442,10 @@ QDomElement QUaModbusTcpClient::toDomElement(QDomDocument & domDoc) const
 	elemTcpClient.setAttribute("KeepConnecting", getKeepConnecting());
 	elemTcpClient.setAttribute("NetworkAddress", getNetworkAddress());
 	elemTcpClient.setAttribute("NetworkPort"   , getNetworkPort   ());
+	elemTcpClient.setAttribute("BackupEndpoints" , getBackupEndpoints ());
+	elemTcpClient.setAttribute("WarmStandby"     , getWarmStandby     ());
+	elemTcpClient.setAttribute("FailoverTimeouts", getFailoverTimeouts());
+	this->toDomElementCommon(elemTcpClient);
 	// add block list element
 	auto elemBlockList = const_cast<QUaModbusTcpClient*>(this)->dataBlocks()->toDomElement(domDoc);
 	elemTcpClient.appendChild(elemBlockList);
@@ -155,6 +502,8 @@ void QUaModbusTcpClient::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 			QUaLogCategory::Serialization
 		);
 	}
+	// common attributes
+	this->fromDomElementCommon(domElem, errorLogs);
 	// NetworkAddress
 	auto networkAddress = domElem.attribute("NetworkAddress");
 	if (!networkAddress.isEmpty())
@@ -183,6 +532,45 @@ void QUaModbusTcpClient::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& e
 			QUaLogCategory::Serialization
 		);
 	}
+	// BackupEndpoints (optional)
+	if (domElem.hasAttribute("BackupEndpoints"))
+	{
+		this->setBackupEndpoints(domElem.attribute("BackupEndpoints"));
+	}
+	// WarmStandby (optional)
+	if (domElem.hasAttribute("WarmStandby"))
+	{
+		auto warmStandby = (bool)domElem.attribute("WarmStandby").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setWarmStandby(warmStandby);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid WarmStandby attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("WarmStandby")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// FailoverTimeouts (optional)
+	if (domElem.hasAttribute("FailoverTimeouts"))
+	{
+		auto failoverTimeouts = domElem.attribute("FailoverTimeouts").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setFailoverTimeouts(failoverTimeouts);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid FailoverTimeouts attribute '%1' in Modbus client %2. Default value set.").arg(domElem.attribute("FailoverTimeouts")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 	// get block list
 	QDomElement elemBlockList = domElem.firstChildElement(QUaModbusDataBlockList::staticMetaObject.className());
 	if (!elemBlockList.isNull())
@@ -221,8 +609,10 @@ void QUaModbusTcpClient::on_networkAddressChanged(const QVariant & value)
 	QString strNetworkAddress = value.toString();
 	// set in thread, for thread-safety
 	m_workerThread.execInThread([this, strNetworkAddress]() {
+		m_activeIndex = 0;
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkAddressParameter, strNetworkAddress);
 	});
+	this->updateEndpoints();
 	// emit
 	emit this->networkAddressChanged(strNetworkAddress);
 }
@@ -234,8 +624,48 @@ void QUaModbusTcpClient::on_networkPortChanged(const QVariant & value)
 	quint16 uiPort = value.value<quint16>();
 	// set in thread, for thread-safety
 	m_workerThread.execInThread([this, uiPort]() {
+		m_activeIndex = 0;
 		m_modbusClient->setConnectionParameter(QModbusDevice::NetworkPortParameter, uiPort);
 	});
+	this->updateEndpoints();
 	// emit
 	emit this->networkPortChanged(uiPort);
 }
+
+void QUaModbusTcpClient::on_backupEndpointsChanged(const QVariant & value)
+{
+	// NOTE : applied at once, standby connection is re-opened if needed
+	this->updateEndpoints();
+	// emit
+	emit this->backupEndpointsChanged(value.toString());
+}
+
+void QUaModbusTcpClient::on_warmStandbyChanged(const QVariant & value)
+{
+	this->updateEndpoints();
+	// emit
+	emit this->warmStandbyChanged(value.toBool());
+}
+
+void QUaModbusTcpClient::on_failoverTimeoutsChanged(const QVariant & value)
+{
+	// NOTE : read on every timeout, nothing to update in thread
+	emit this->failoverTimeoutsChanged(value.value<quint32>());
+}
+
+void QUaModbusTcpClient::on_updateActiveEndpoint(const QString & strActiveEndpoint)
+{
+	// avoid update or emit if no change
+	if (this->getActiveEndpoint() == strActiveEndpoint)
+	{
+		return;
+	}
+	this->activeEndpoint()->setValue(strActiveEndpoint);
+	// emit
+	emit this->activeEndpointChanged(strActiveEndpoint);
+}
+
+void QUaModbusTcpClient::on_updateStandbyReady(const bool & standbyReady)
+{
+	m_standbyReady = standbyReady;
+}
@@ -5,6 +5,8 @@
 
 class QUaModbusClientList;
 
+typedef QPair<QString, quint16> QModbusEndpoint;
+
 class QUaModbusTcpClient : public QUaModbusClient
 {
 	friend class QUaModbusClientList;
@@ -12,8 +14,14 @@ class QUaModbusTcpClient : public QUaModbusClient
     Q_OBJECT
 
 	// UA properties
-	Q_PROPERTY(QUaProperty * NetworkAddress  READ networkAddress)
-	Q_PROPERTY(QUaProperty * NetworkPort     READ networkPort   )
+	Q_PROPERTY(QUaProperty * NetworkAddress   READ networkAddress  )
+	Q_PROPERTY(QUaProperty * NetworkPort      READ networkPort     )
+	Q_PROPERTY(QUaProperty * BackupEndpoints  READ backupEndpoints )
+	Q_PROPERTY(QUaProperty * WarmStandby      READ warmStandby     )
+	Q_PROPERTY(QUaProperty * FailoverTimeouts READ failoverTimeouts)
+
+	// UA variables
+	Q_PROPERTY(QUaBaseDataVariable * ActiveEndpoint READ activeEndpoint)
 
 public:
 	Q_INVOKABLE explicit QUaModbusTcpClient(QUaServer *server);
@@ -22,6 +30,13 @@ public:
 
 	QUaProperty * networkAddress() const;
 	QUaProperty * networkPort() const;
+	QUaProperty * backupEndpoints() const;
+	QUaProperty * warmStandby() const;
+	QUaProperty * failoverTimeouts() const;
+
+	// UA variables
+
+	QUaBaseDataVariable * activeEndpoint() const;
 
 	// C++ API (all is read/write)
 
@@ -31,23 +46,72 @@ public:
 	quint16  getNetworkPort() const;
 	void     setNetworkPort(const quint16 &networkPort);
 
+	// list of "address:port" separated by commas, port defaults to NetworkPort
+	QString  getBackupEndpoints() const;
+	void     setBackupEndpoints(const QString &strBackupEndpoints);
+
+	bool     getWarmStandby() const;
+	void     setWarmStandby(const bool &warmStandby);
+
+	quint32  getFailoverTimeouts() const;
+	void     setFailoverTimeouts(const quint32 &failoverTimeouts);
+
+	QString  getActiveEndpoint() const;
+
+	QList<QModbusEndpoint> endpoints() const;
+
+	static QList<QModbusEndpoint> parseEndpoints(const QString &strEndpoints, const quint16 &defaultPort);
+
 signals:
 	// C++ API
 	void networkAddressChanged(const QString &strNetworkAddress);
 	void networkPortChanged(const quint16 &networkPort);
+	void backupEndpointsChanged(const QString &strBackupEndpoints);
+	void warmStandbyChanged(const bool &warmStandby);
+	void failoverTimeoutsChanged(const quint32 &failoverTimeouts);
+	void activeEndpointChanged(const QString &strActiveEndpoint);
+	// (internal) to safely update active endpoint in ua server thread
+	void updateActiveEndpoint(const QString &strActiveEndpoint);
+	// (internal) to safely let ua server thread know if standby connection is open
+	void updateStandbyReady(const bool &standbyReady);
 
 protected:
 	void resetModbusClient() override;
+	bool failover(const quint32 &consecutiveTimeouts) override;
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const override;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs) override;
+	QByteArray  recordsToPcap(const QVector<QUaModbusLogRecord> &frames) const override;
 
 private slots:
-	void on_stateChanged         (const QModbusDevice::State &state);
-	void on_networkAddressChanged(const QVariant &value);
-	void on_networkPortChanged   (const QVariant &value);
-
+	void on_stateChanged          (const QModbusDevice::State &state);
+	void on_networkAddressChanged (const QVariant &value);
+	void on_networkPortChanged    (const QVariant &value);
+	void on_backupEndpointsChanged(const QVariant &value);
+	void on_warmStandbyChanged    (const QVariant &value);
+	void on_failoverTimeoutsChanged(const QVariant &value);
+	void on_updateActiveEndpoint  (const QString &strActiveEndpoint);
+	void on_updateStandbyReady    (const bool &standbyReady);
+
+private:
+	// only access in ua server thread
+	bool m_standbyReady;
+	// NOTE : only modify and access in thread
+	QList<QModbusEndpoint> m_endpoints;
+	int m_activeIndex;
+	bool m_standbyEnabled;
+	int m_standbyIndex;
+	QSharedPointer<QModbusClient> m_standbyClient;
+	QModbusDevice::State m_lastState;
+
+	void updateEndpoints();
+	void watchEndpoint();
+	void applyEndpoint(const int &index);
+	void openStandby();
+	void closeStandby();
+	bool switchToStandby();
+
+	static quint32 m_standbyRetryPeriod;
 };
 
 #endif // QUAMODBUSTCPCLIENT_H
-
@@ -0,0 +1,269 @@
+#include "quamodbustracer.h"
+
+#include <QVector>
+#include <QList>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace
+{
+
+struct QUaModbusTraceRecord
+{
+	qint64  timestamp; // ns since tracer clock start
+	quint64 id;
+	quint8  event;
+};
+
+// single writer (owner thread), read only when dumping
+struct QUaModbusTraceRing
+{
+	QVector<QUaModbusTraceRecord> records;
+	QAtomicInteger<quint32>       next;
+	int                           index;
+	QString                       strName;
+};
+
+struct QUaModbusTraceRegistry
+{
+	QMutex                                  mutex;
+	QList<QSharedPointer<QUaModbusTraceRing>> rings;
+	QElapsedTimer                           clock;
+};
+
+QUaModbusTraceRegistry & registry()
+{
+	static QUaModbusTraceRegistry reg;
+	return reg;
+}
+
+// NOTE : registry keeps rings alive after thread exits, so they can still be dumped
+thread_local QUaModbusTraceRing * t_ring    = nullptr;
+thread_local quint64              t_current = 0;
+
+QUaModbusTraceRing * threadRing()
+{
+	if (t_ring)
+	{
+		return t_ring;
+	}
+	// only locks the first time each thread records
+	auto & reg = registry();
+	QMutexLocker locker(&reg.mutex);
+	auto ring = QSharedPointer<QUaModbusTraceRing>::create();
+	ring->records.resize(QUaModbusTracer::m_ringCapacity);
+	ring->next.store(0);
+	ring->index = reg.rings.count();
+	QThread * thread = QThread::currentThread();
+	ring->strName = thread && !thread->objectName().isEmpty() ?
+		thread->objectName() :
+		QString("Thread %1").arg(ring->index);
+	reg.rings << ring;
+	t_ring = ring.data();
+	return t_ring;
+}
+
+const char * spanName(const quint8 &event)
+{
+	switch (event)
+	{
+	case QUaModbusTracer::Enqueue:
+		return "queue";
+	case QUaModbusTracer::Send:
+		return "wire";
+	case QUaModbusTracer::Reply:
+		return "hop";
+	case QUaModbusTracer::Dispatch:
+		return "dispatch";
+	case QUaModbusTracer::Decode:
+		return "decode";
+	case QUaModbusTracer::Publish:
+		return "publish";
+	default:
+		return "done";
+	}
+}
+
+// escape string to be placed within json quotes
+QString jsonEscape(const QString &strValue)
+{
+	QString strEscaped;
+	strEscaped.reserve(strValue.count());
+	for (auto ch : strValue)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			strEscaped += '\\';
+			strEscaped += ch;
+		}
+		else if (ch.unicode() < 0x20)
+		{
+			strEscaped += QString("\\u%1").arg(ch.unicode(), 4, 16, QChar('0'));
+		}
+		else
+		{
+			strEscaped += ch;
+		}
+	}
+	return strEscaped;
+}
+
+} // namespace
+
+QBasicAtomicInt         QUaModbusTracer::m_enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+QAtomicInteger<quint64> QUaModbusTracer::m_nextId;
+
+bool QUaModbusTracer::isEnabled()
+{
+	return m_enabled.load() != 0;
+}
+
+void QUaModbusTracer::setEnabled(const bool & enabled)
+{
+	auto & reg = registry();
+	{
+		QMutexLocker locker(&reg.mutex);
+		if (!reg.clock.isValid())
+		{
+			reg.clock.start();
+		}
+	}
+	m_enabled.store(enabled ? 1 : 0);
+}
+
+quint64 QUaModbusTracer::newId()
+{
+	if (Q_LIKELY(!m_enabled.load()))
+	{
+		return 0;
+	}
+	return m_nextId.fetchAndAddRelaxed(1) + 1;
+}
+
+quint64 QUaModbusTracer::current()
+{
+	return t_current;
+}
+
+void QUaModbusTracer::setCurrent(const quint64 & id)
+{
+	t_current = id;
+}
+
+void QUaModbusTracer::record(const Event & event, const quint64 & id)
+{
+	if (id == 0)
+	{
+		return;
+	}
+	auto ring = threadRing();
+	quint32 next = ring->next.load();
+	auto & rec = ring->records[static_cast<int>(next % QUaModbusTracer::m_ringCapacity)];
+	rec.timestamp = registry().clock.nsecsElapsed();
+	rec.id        = id;
+	rec.event     = event;
+	// NOTE : publish record after it is written
+	ring->next.storeRelease(next + 1);
+}
+
+QByteArray QUaModbusTracer::toChromeTrace()
+{
+	struct Entry
+	{
+		QUaModbusTraceRecord record;
+		int tid;
+	};
+	QVector<Entry> entries;
+	QByteArray out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	auto append = [&out, &first](const QByteArray &event) {
+		out += first ? "\n" : ",\n";
+		out += event;
+		first = false;
+	};
+	// copy rings, thread names as metadata
+	auto & reg = registry();
+	{
+		QMutexLocker locker(&reg.mutex);
+		for (auto ring : reg.rings)
+		{
+			quint32 next  = ring->next.loadAcquire();
+			quint32 count = qMin(next, static_cast<quint32>(QUaModbusTracer::m_ringCapacity));
+			for (quint32 i = next - count; i != next; i++)
+			{
+				entries << Entry{ ring->records.at(static_cast<int>(i % QUaModbusTracer::m_ringCapacity)), ring->index };
+			}
+			append(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+				.arg(ring->index)
+				.arg(jsonEscape(ring->strName))
+				.toUtf8());
+		}
+	}
+	// group by request, then in time order
+	std::stable_sort(entries.begin(), entries.end(),
+	[](const Entry &a, const Entry &b) {
+		return a.record.id != b.record.id ?
+			a.record.id < b.record.id :
+			a.record.timestamp < b.record.timestamp;
+	});
+	// each event opens an async span closed by the next event of same request
+	auto ts = [](const qint64 &ns) {
+		return QString::number(static_cast<double>(ns) / 1000.0, 'f', 3);
+	};
+	for (int i = 0; i + 1 < entries.count(); i++)
+	{
+		auto &curr = entries.at(i);
+		auto &next = entries.at(i + 1);
+		if (curr.record.id != next.record.id || curr.record.event == QUaModbusTracer::Done)
+		{
+			continue;
+		}
+		QString strName = spanName(curr.record.event);
+		append(QString("{\"name\":\"%1\",\"cat\":\"modbus\",\"ph\":\"b\",\"id\":%2,\"pid\":1,\"tid\":%3,\"ts\":%4}")
+			.arg(strName).arg(curr.record.id).arg(curr.tid).arg(ts(curr.record.timestamp))
+			.toUtf8());
+		append(QString("{\"name\":\"%1\",\"cat\":\"modbus\",\"ph\":\"e\",\"id\":%2,\"pid\":1,\"tid\":%3,\"ts\":%4}")
+			.arg(strName).arg(curr.record.id).arg(next.tid).arg(ts(next.record.timestamp))
+			.toUtf8());
+	}
+	out += "\n]}\n";
+	return out;
+}
+
+bool QUaModbusTracer::dumpChromeTrace(const QString & strFilePath)
+{
+	QSaveFile file(strFilePath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+	file.write(QUaModbusTracer::toChromeTrace());
+	return file.commit();
+}
+
+void QUaModbusTracer::clear()
+{
+	// NOTE : only safe while disabled, writers do not lock
+	auto & reg = registry();
+	QMutexLocker locker(&reg.mutex);
+	for (auto ring : reg.rings)
+	{
+		ring->next.store(0);
+	}
+}
+
+QUaModbusTraceScope::QUaModbusTraceScope(const quint64 & id)
+{
+	m_previous = QUaModbusTracer::current();
+	QUaModbusTracer::setCurrent(id);
+}
+
+QUaModbusTraceScope::~QUaModbusTraceScope()
+{
+	QUaModbusTracer::setCurrent(m_previous);
+}
@@ -0,0 +1,78 @@
+#ifndef QUAMODBUSTRACER_H
+#define QUAMODBUSTRACER_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QString>
+
+// opt-in request tracer, each thread records to its own ring buffer
+// NOTE : when disabled, trace calls cost a single relaxed load and branch
+class QUaModbusTracer
+{
+public:
+	// request lifecycle, a span goes from each event to the next one with the same id
+	enum Event : quint8
+	{
+		Enqueue  = 0, // request decided (worker thread loop or ua server thread write)
+		Send     = 1, // request handed to QModbusClient (worker thread)
+		Reply    = 2, // QModbusReply finished (worker thread)
+		Dispatch = 3, // reply handler starts (ua server thread)
+		Decode   = 4, // value decode starts (ua server thread)
+		Publish  = 5, // value publish to ua node starts (ua server thread)
+		Done     = 6  // request handled
+	};
+
+	static bool isEnabled();
+	static void setEnabled(const bool &enabled);
+
+	// returns 0 if disabled, traces with id 0 are ignored
+	static quint64 newId();
+
+	static inline void trace(const Event &event, const quint64 &id)
+	{
+		if (Q_LIKELY(!m_enabled.load()))
+		{
+			return;
+		}
+		QUaModbusTracer::record(event, id);
+	}
+
+	// id of the request being handled by the calling thread, for code deep in the call stack
+	static inline void traceCurrent(const Event &event)
+	{
+		if (Q_LIKELY(!m_enabled.load()))
+		{
+			return;
+		}
+		QUaModbusTracer::record(event, QUaModbusTracer::current());
+	}
+	static quint64 current();
+	static void    setCurrent(const quint64 &id);
+
+	// chrome://tracing or ui.perfetto.dev json, disable first for a consistent snapshot
+	static QByteArray toChromeTrace();
+	static bool       dumpChromeTrace(const QString &strFilePath);
+	static void       clear();
+
+	// events per thread ring buffer, older are overwritten
+	static const int m_ringCapacity = 1 << 16;
+
+private:
+	static void record(const Event &event, const quint64 &id);
+
+	static QBasicAtomicInt         m_enabled;
+	static QAtomicInteger<quint64> m_nextId;
+};
+
+// sets the calling thread's current trace id for the scope lifetime
+class QUaModbusTraceScope
+{
+public:
+	explicit QUaModbusTraceScope(const quint64 &id);
+	~QUaModbusTraceScope();
+
+private:
+	quint64 m_previous;
+};
+
+#endif // QUAMODBUSTRACER_H
@@ -2,10 +2,14 @@
 #include "quamodbusvalue.h"
 #include "quamodbusvaluelist.h"
 #include "quamodbusdatablock.h"
+#include "quamodbusmetrics.h"
+#include "quamodbustracer.h"
 
 #include <QUaProperty>
 #include <QUaBaseDataVariable>
 
+#include <QtEndian>
+
 #ifdef QUA_ACCESS_CONTROL
 #include <QUaPermissions>
 #endif // QUA_ACCESS_CONTROL
@@ -18,43 +22,93 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 #endif // !QUA_ACCESS_CONTROL
 {
 	// set defaults
-	m_loopId = 0;
 	m_type = nullptr;
 	m_registersUsed = nullptr;
 	m_addressOffset = nullptr;
+	m_count = nullptr;
+	m_optimisticWrite = nullptr;
+	m_absoluteDeadband = nullptr;
+	m_percentDeadband = nullptr;
+	m_rangeLow = nullptr;
+	m_rangeHigh = nullptr;
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	m_cyclicWritePeriod = nullptr;
 	m_cyclicWriteMode = nullptr;
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 	m_value = nullptr;
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	m_lastError = nullptr;
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 	m_typeCache = QModbusValueType::Invalid;
 	m_addressOffsetCache = -1; 
+	m_countCache = 1;
 	m_lastErrorCache = QModbusError::ConfigurationError;
+	m_writeId = 0;
+	m_writePending = false;
+	m_absoluteDeadbandCache = 0.0;
+	m_percentDeadbandCache = 0.0;
+	m_rangeLowCache = 0.0;
+	m_rangeHighCache = 0.0;
+	m_deadband = 0.0;
+	m_deadbandSuppressed = 0;
 	type             ()->setDataTypeEnum(QMetaEnum::fromType<QModbusValueType>());
 	type             ()->setValue(m_typeCache);
 	registersUsed    ()->setDataType(QMetaType::UShort);
 	registersUsed    ()->setValue(0);
 	addressOffset    ()->setDataType(QMetaType::Int);
 	addressOffset    ()->setValue(m_addressOffsetCache);
+	count            ()->setDataType(QMetaType::UShort);
+	count            ()->setValue(m_countCache);
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	lastError        ()->setDataTypeEnum(QMetaEnum::fromType<QModbusError>());
 	lastError        ()->setValue(m_lastErrorCache);
+#else
+	value            ()->setStatusCode(QUaModbusValue::errorToStatus(m_lastErrorCache));
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
+	optimisticWrite  ()->setValue(false);
+	absoluteDeadband ()->setDataType(QMetaType::Double);
+	absoluteDeadband ()->setValue(m_absoluteDeadbandCache);
+	percentDeadband  ()->setDataType(QMetaType::Double);
+	percentDeadband  ()->setValue(m_percentDeadbandCache);
+	rangeLow         ()->setDataType(QMetaType::Double);
+	rangeLow         ()->setValue(m_rangeLowCache);
+	rangeHigh        ()->setDataType(QMetaType::Double);
+	rangeHigh        ()->setValue(m_rangeHighCache);
 	// set initial conditions
 	type             ()->setWriteAccess(true);
 	addressOffset    ()->setWriteAccess(true);
+	count            ()->setWriteAccess(true);
+	optimisticWrite  ()->setWriteAccess(true);
+	absoluteDeadband ()->setWriteAccess(true);
+	percentDeadband  ()->setWriteAccess(true);
+	rangeLow         ()->setWriteAccess(true);
+	rangeHigh        ()->setWriteAccess(true);
 	value            ()->setWriteAccess(false); // set to true, when type != ValueType::Invalid
 	// handle state changes
 	QObject::connect(type()             , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_typeChanged             , Qt::QueuedConnection);
 	QObject::connect(addressOffset()    , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_addressOffsetChanged    , Qt::QueuedConnection);
+	QObject::connect(count()            , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_countChanged            , Qt::QueuedConnection);
 	QObject::connect(value()            , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_valueChanged            , Qt::QueuedConnection);
+	QObject::connect(optimisticWrite()  , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_optimisticWriteChanged  , Qt::QueuedConnection);
+	QObject::connect(absoluteDeadband() , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_absoluteDeadbandChanged , Qt::QueuedConnection);
+	QObject::connect(percentDeadband()  , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_percentDeadbandChanged  , Qt::QueuedConnection);
+	QObject::connect(rangeLow()         , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_rangeLowChanged         , Qt::QueuedConnection);
+	QObject::connect(rangeHigh()        , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_rangeHighChanged        , Qt::QueuedConnection);
 	// to safely update error in ua server thread
 	QObject::connect(this, &QUaModbusValue::updateLastError, this, &QUaModbusValue::on_updateLastError);
+	QObject::connect(this, &QUaModbusValue::updateWriteResult, this, &QUaModbusValue::on_updateWriteResult);
 
 	// set descriptions
 	/*
 	type()         ->setDescription(tr("Data type used to convert the registers to the value."));
 	registersUsed()->setDescription(tr("Number of registeres used by the selected data type"));
 	addressOffset()->setDescription(tr("Offset with respect to the data block."));
+	count()        ->setDescription(tr("Number of consecutive elements of the selected data type. Value is an array if greater than one."));
+	optimisticWrite()->setDescription(tr("Whether to publish written values at once as uncertain, rolling them back if the write fails."));
+	absoluteDeadband()->setDescription(tr("Read values that differ less than this from the last published value are not published."));
+	percentDeadband()->setDescription(tr("Same as AbsoluteDeadband but in percent of the range given by RangeLow and RangeHigh."));
+	rangeLow()     ->setDescription(tr("Lower limit of the value range, used by PercentDeadband."));
+	rangeHigh()    ->setDescription(tr("Upper limit of the value range, used by PercentDeadband."));
 	value()        ->setDescription(tr("The value obtained by converting the registers to the selected type."));
 	lastError()    ->setDescription(tr("Last error obtained while converting registers to value."));
 	*/
@@ -66,7 +120,6 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 	cyclicWriteMode()->setValue(QModbusCyclicWriteMode::Current);
 	QObject::connect(cyclicWritePeriod(), &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWritePeriodChanged, Qt::QueuedConnection);
 	QObject::connect(cyclicWriteMode()  , &QUaBaseVariable::valueChanged, this, &QUaModbusValue::on_cyclicWriteModeChanged  , Qt::QueuedConnection);
-	QObject::connect(this, &QUaModbusValue::cyclicWrite    , this, &QUaModbusValue::on_cyclicWrite    );
 	cyclicWritePeriod()->setWriteAccess(true);
 	cyclicWriteMode()->setWriteAccess(true);
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
@@ -75,11 +128,6 @@ QUaModbusValue::QUaModbusValue(QUaServer *server)
 QUaModbusValue::~QUaModbusValue()
 {
 	emit this->aboutToDestroy();
-	// stop loop
-	if (m_loopId > 0)
-	{
-		this->client()->m_workerThread.stopLoopInThread(m_loopId);
-	}
 }
 
 QUaProperty * QUaModbusValue::type()
@@ -109,6 +157,60 @@ QUaProperty * QUaModbusValue::addressOffset()
 	return m_addressOffset;
 }
 
+QUaProperty * QUaModbusValue::count()
+{
+	if (!m_count)
+	{
+		m_count = this->browseChild<QUaProperty>("Count");
+	}
+	return m_count;
+}
+
+QUaProperty * QUaModbusValue::optimisticWrite()
+{
+	if (!m_optimisticWrite)
+	{
+		m_optimisticWrite = this->browseChild<QUaProperty>("OptimisticWrite");
+	}
+	return m_optimisticWrite;
+}
+
+QUaProperty * QUaModbusValue::absoluteDeadband()
+{
+	if (!m_absoluteDeadband)
+	{
+		m_absoluteDeadband = this->browseChild<QUaProperty>("AbsoluteDeadband");
+	}
+	return m_absoluteDeadband;
+}
+
+QUaProperty * QUaModbusValue::percentDeadband()
+{
+	if (!m_percentDeadband)
+	{
+		m_percentDeadband = this->browseChild<QUaProperty>("PercentDeadband");
+	}
+	return m_percentDeadband;
+}
+
+QUaProperty * QUaModbusValue::rangeLow()
+{
+	if (!m_rangeLow)
+	{
+		m_rangeLow = this->browseChild<QUaProperty>("RangeLow");
+	}
+	return m_rangeLow;
+}
+
+QUaProperty * QUaModbusValue::rangeHigh()
+{
+	if (!m_rangeHigh)
+	{
+		m_rangeHigh = this->browseChild<QUaProperty>("RangeHigh");
+	}
+	return m_rangeHigh;
+}
+
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 QUaProperty* QUaModbusValue::cyclicWritePeriod()
 {
@@ -156,33 +258,11 @@ void QUaModbusValue::on_cyclicWritePeriodChanged(const QVariant& value, const bo
 	{
 		return;
 	}
-	// stop previous loop
-	if (m_loopId > 0)
-	{
-		this->client()->m_workerThread.stopLoopInThread(m_loopId);
-	}
 	quint32 cyclePeriod = value.value<quint32>();
+	// block aggregates cyclic writes of all its values with same period
+	this->block()->updateCyclicWrites();
 	// emit
 	emit this->cyclicWritePeriodChanged(cyclePeriod);
-	// exit if no need to start another loop
-	if (cyclePeriod == 0)
-	{
-		return;
-	}
-	m_loopId = this->client()->m_workerThread.startLoopInThread(
-	[this]() {
-		if (m_loopId <= 0)
-		{
-			return;
-		}
-		auto state = this->client()->getState();
-		if (state != QModbusState::ConnectedState)
-		{
-			return;
-		}
-		emit this->cyclicWrite();
-	}, 
-	cyclePeriod);
 }
 
 void QUaModbusValue::on_cyclicWriteModeChanged(const QVariant& value, const bool& networkChange)
@@ -194,11 +274,26 @@ void QUaModbusValue::on_cyclicWriteModeChanged(const QVariant& value, const bool
 	emit this->cyclicWriteModeChanged(value.value<QModbusCyclicWriteMode>());
 }
 
-void QUaModbusValue::on_cyclicWrite()
+QVariant QUaModbusValue::cyclicWriteValue() const
 {
-	auto value = this->getValue();
-	// cyclic write logic
 	auto mode = this->getCyclicWriteMode();
+	// arrays apply mode to each element
+	if (m_countCache > 1 && !QUaModbusValue::typeIsString(m_typeCache))
+	{
+		auto list = this->getValue().toList();
+		for (int i = 0; i < list.count(); i++)
+		{
+			list[i] = QUaModbusValue::cyclicWriteValue(list.at(i), mode);
+		}
+		return list;
+	}
+	return QUaModbusValue::cyclicWriteValue(this->getValue(), mode);
+}
+
+QVariant QUaModbusValue::cyclicWriteValue(const QVariant & current, const QModbusCyclicWriteMode & mode)
+{
+	auto value = current;
+	// cyclic write logic
 	switch (mode)
 	{
 	case QModbusCyclicWriteMode::Current:
@@ -221,11 +316,10 @@ void QUaModbusValue::on_cyclicWrite()
 			value.setValue(--val);
 		}
 		break;
-	default:
+	default:
 		break;
 	}
-	// actually write
-	this->on_valueChanged(value, true);
+	return value;
 }
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
@@ -238,6 +332,7 @@ QUaBaseDataVariable * QUaModbusValue::value()
 	return m_value;
 }
 
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 QUaBaseDataVariable * QUaModbusValue::lastError()
 {
 	if (!m_lastError)
@@ -246,6 +341,7 @@ QUaBaseDataVariable * QUaModbusValue::lastError()
 	}
 	return m_lastError;
 }
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 
 void QUaModbusValue::remove()
 {
@@ -263,14 +359,14 @@ void QUaModbusValue::on_typeChanged(const QVariant &value, const bool& networkCh
 		return;
 	}
 	// convert to metatype to set as UA type
-	auto metaType = QUaModbusValue::typeToMeta(type);
-	this->value()->setDataType(metaType);
+	this->updateValueDataType();
 	// update value is possible
+	m_deadbandReference = QVariant();
 	auto blockError   = this->block()->getLastError();
 	auto blockData    = this->block()->getData();
 	this->setValue(blockData, blockError);
 	// update number of registers used
-	auto registersUsed = QUaModbusValue::typeBlockSize(type);
+	auto registersUsed = this->blockSize();
 	this->registersUsed()->setValue(registersUsed);
 	// emit
 	emit this->typeChanged(type);
@@ -308,6 +404,22 @@ void QUaModbusValue::setAddressOffset(const int & addressOffset)
 	this->on_addressOffsetChanged(addressOffset, true);
 }
 
+quint16 QUaModbusValue::getCount() const
+{
+	return m_countCache;
+}
+
+void QUaModbusValue::setCount(const quint16 & count)
+{
+	this->count()->setValue(count);
+	this->on_countChanged(count, true);
+}
+
+int QUaModbusValue::blockSize() const
+{
+	return QUaModbusValue::typeBlockSize(m_typeCache) * m_countCache;
+}
+
 QVariant QUaModbusValue::getValue() const
 {
 	return const_cast<QUaModbusValue*>(this)->value()->value();
@@ -320,6 +432,66 @@ void QUaModbusValue::setValue(const QVariant & value)
 	this->on_valueChanged(value, true);
 }
 
+bool QUaModbusValue::getOptimisticWrite() const
+{
+	return const_cast<QUaModbusValue*>(this)->optimisticWrite()->value().toBool();
+}
+
+void QUaModbusValue::setOptimisticWrite(const bool & optimisticWrite)
+{
+	this->optimisticWrite()->setValue(optimisticWrite);
+	this->on_optimisticWriteChanged(optimisticWrite, true);
+}
+
+double QUaModbusValue::getAbsoluteDeadband() const
+{
+	return m_absoluteDeadbandCache;
+}
+
+void QUaModbusValue::setAbsoluteDeadband(const double & absoluteDeadband)
+{
+	this->absoluteDeadband()->setValue(absoluteDeadband);
+	this->on_absoluteDeadbandChanged(absoluteDeadband, true);
+}
+
+double QUaModbusValue::getPercentDeadband() const
+{
+	return m_percentDeadbandCache;
+}
+
+void QUaModbusValue::setPercentDeadband(const double & percentDeadband)
+{
+	this->percentDeadband()->setValue(percentDeadband);
+	this->on_percentDeadbandChanged(percentDeadband, true);
+}
+
+double QUaModbusValue::getRangeLow() const
+{
+	return m_rangeLowCache;
+}
+
+void QUaModbusValue::setRangeLow(const double & rangeLow)
+{
+	this->rangeLow()->setValue(rangeLow);
+	this->on_rangeLowChanged(rangeLow, true);
+}
+
+double QUaModbusValue::getRangeHigh() const
+{
+	return m_rangeHighCache;
+}
+
+void QUaModbusValue::setRangeHigh(const double & rangeHigh)
+{
+	this->rangeHigh()->setValue(rangeHigh);
+	this->on_rangeHighChanged(rangeHigh, true);
+}
+
+quint64 QUaModbusValue::getDeadbandSuppressed() const
+{
+	return m_deadbandSuppressed;
+}
+
 QModbusError QUaModbusValue::getLastError() const
 {
 	return m_lastErrorCache;
@@ -355,6 +527,7 @@ void QUaModbusValue::on_addressOffsetChanged(const QVariant & value, const bool&
 		return;
 	}
 	// update value is possible
+	m_deadbandReference = QVariant();
 	auto blockError   = this->block()->getLastError();
 	auto blockData    = this->block()->getData();
 	this->setValue(blockData, blockError);
@@ -362,6 +535,30 @@ void QUaModbusValue::on_addressOffsetChanged(const QVariant & value, const bool&
 	emit this->addressOffsetChanged(offset);
 }
 
+void QUaModbusValue::on_countChanged(const QVariant & value, const bool & networkChange)
+{
+	// at least one element
+	auto count = qMax(value.value<quint16>(), static_cast<quint16>(1));
+	m_countCache = count;
+	if (!networkChange)
+	{
+		return;
+	}
+	// scalar or array UA type
+	this->updateValueDataType();
+	// update value is possible
+	m_deadbandReference = QVariant();
+	auto blockError   = this->block()->getLastError();
+	auto blockData    = this->block()->getData();
+	this->setValue(blockData, blockError);
+	// update number of registers used
+	auto registersUsed = this->blockSize();
+	this->registersUsed()->setValue(registersUsed);
+	// emit
+	emit this->countChanged(count);
+	emit this->registersUsedChanged(registersUsed);
+}
+
 // OPC UA network change
 void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& networkChange)
 {
@@ -369,9 +566,13 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 	{
 		return;
 	}
+	// next read must be published to overwrite the written value
+	m_deadbandReference = QVariant();
 	// get block representation of value
-	auto type = this->getType();
-	auto data = QUaModbusValue::valueToBlock(value, type);
+	auto type  = this->getType();
+	auto count = this->getCount();
+	bool bOK;
+	auto data  = QUaModbusValue::valueToBlock(value, type, count, &bOK);
 	// get current block
 	auto blockError   = this->block()->getLastError();
 	auto blockSize    = this->block()->getSize();
@@ -396,7 +597,7 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 		emit this->valueChanged(QVariant());
 		return;
 	}
-	int typeBlockSize = QUaModbusValue::typeBlockSize(type);
+	int typeBlockSize = this->blockSize();
 	if (addressOffset + typeBlockSize > static_cast<int>(blockSize))
 	{
 		this->value()->setWriteAccess(false);
@@ -406,12 +607,50 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 		emit this->valueChanged(QVariant());
 		return;
 	}
+	// arrays must be written whole, roll back to last value known from device
+	if (count > 1 && !QUaModbusValue::typeIsString(type) && value.toList().count() != count)
+	{
+		// NOTE : set value before emitting to avoid recursion
+		m_deadbandReference = m_confirmedValue;
+		this->value()->setValue(m_confirmedValue);
+		this->setLastError(QModbusError::ConfigurationError);
+		// emit
+		emit this->valueChanged(m_confirmedValue);
+		return;
+	}
+	// value cannot be represented in registers, roll back to last value known from device
+	if (!bOK)
+	{
+		// NOTE : set value before emitting to avoid recursion
+		m_deadbandReference = m_confirmedValue;
+		this->value()->setValue(m_confirmedValue);
+		this->setLastError(QModbusError::ConfigurationError);
+		// emit
+		emit this->valueChanged(m_confirmedValue);
+		return;
+	}
+	// publish at once, confirmed or rolled back when write finishes
+	quint32 writeId = ++m_writeId;
+	bool optimistic = this->getOptimisticWrite();
+	if (optimistic)
+	{
+		m_writePending = true;
+		m_pendingValue = value;
+		// NOTE : set value before emitting to avoid recursion
+		this->value()->setValue(value);
+		this->value()->setStatusCode(QUaStatus::UncertainLastUsableValue);
+		// emit
+		emit this->valueChanged(value);
+	}
 	// just write
 	auto client = this->client();
 	auto block  = this->block();
+	quint64 traceId = QUaModbusTracer::newId();
+	QUaModbusTracer::trace(QUaModbusTracer::Enqueue, traceId);
 	// exec write request in client thread
 	this->client()->m_workerThread.execInThread(
-	[this, data, client, block, addressOffset, typeBlockSize, value]() {
+	[this, data, client, block, addressOffset, typeBlockSize, value, writeId, optimistic, traceId]() {
+		QUaModbusTaskScope taskScope("QUaModbusValue::setValue");
 		// copy from block
 		auto registerType = block->m_registerType;
 		auto startAddress = block->m_startAddress + addressOffset;
@@ -420,16 +659,19 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 		if (registerType != QModbusDataBlockType::Coils &&
 			registerType != QModbusDataBlockType::HoldingRegisters)
 		{
+			emit this->updateWriteResult(writeId, QModbusError::ConfigurationError);
 			return;
 		}
 		if (startAddress < 0)
 		{
 			emit this->updateLastError(QModbusError::ConfigurationError);
+			emit this->updateWriteResult(writeId, QModbusError::ConfigurationError);
 			return;
 		}
 		if (valueCount == 0)
 		{
 			emit this->updateLastError(QModbusError::ConfigurationError);
+			emit this->updateWriteResult(writeId, QModbusError::ConfigurationError);
 			return;
 		}
 		// check if connected
@@ -438,6 +680,7 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 		{
 			auto clientError = client->getLastError();
 			emit this->updateLastError(clientError);
+			emit this->updateWriteResult(writeId, QModbusError::ConnectionError);
 			return;
 		}
 		// create data target 
@@ -447,42 +690,129 @@ void QUaModbusValue::on_valueChanged(const QVariant & value, const bool& network
 			data
 		);
 		// create and send request
-		auto serverAddress = client->getServerAddress();
-		QModbusReply* p_reply = client->m_modbusClient->sendWriteRequest(dataToWrite, serverAddress);
+		auto serverAddress = block->writeServerAddress();
+		QUaModbusTracer::trace(QUaModbusTracer::Send, traceId);
+		QModbusReply* p_reply = client->sendWriteRequest(dataToWrite, serverAddress);
 		if (!p_reply)
 		{
 			emit this->updateLastError(QModbusError::ReplyAbortedError);
+			emit this->updateWriteResult(writeId, QModbusError::ReplyAbortedError);
 			return;
 		}
+		QUaModbusDataBlock::traceOnFinished(p_reply, traceId);
 		// subscribe to finished
-		QObject::connect(p_reply, &QModbusReply::finished, this,
-		[this, p_reply, value]() mutable {
+		block->onWriteFinished(p_reply, serverAddress, this,
+		[this, value, writeId, optimistic, traceId](QModbusError error) {
 			// NOTE : exec'd in ua server thread (not in worker thread)
+			QUaModbusTracer::trace(QUaModbusTracer::Dispatch, traceId);
+			QUaModbusTaskScope taskScope("QUaModbusValue::setValue reply");
 			if (this->client()->m_disconnectRequested || this->client()->getState() != QModbusState::ConnectedState)
 			{
-				auto error = QModbusError::ReplyAbortedError;
-				this->setLastError(error);
-				return;
-			}
-			// check if reply still valid
-			if (!p_reply)
-			{
-				auto error = QModbusError::ReplyAbortedError;
+				error = QModbusError::ReplyAbortedError;
 				this->setLastError(error);
+				this->on_updateWriteResult(writeId, error);
 				return;
 			}
 			// handle error
-			auto error = p_reply->error();
 			this->setLastError(error);
-			// delete reply on next event loop exec
-			p_reply->deleteLater();
-			p_reply = nullptr;
-			// emit
-			emit this->valueChanged(value);
-		}, Qt::QueuedConnection);
+			// emit (already done if optimistic)
+			if (!optimistic)
+			{
+				emit this->valueChanged(value);
+			}
+			this->on_updateWriteResult(writeId, error);
+			QUaModbusTracer::trace(QUaModbusTracer::Done, traceId);
+			// confirm device state without waiting for next poll
+			auto block = this->block();
+			if (error == QModbusError::NoError && block->getReadBack())
+			{
+				block->triggerRead();
+			}
+		});
 	});
 }
 
+void QUaModbusValue::on_optimisticWriteChanged(const QVariant & value, const bool & networkChange)
+{
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->optimisticWriteChanged(value.toBool());
+}
+
+void QUaModbusValue::on_absoluteDeadbandChanged(const QVariant & value, const bool & networkChange)
+{
+	m_absoluteDeadbandCache = value.toDouble();
+	this->updateDeadband();
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->absoluteDeadbandChanged(m_absoluteDeadbandCache);
+}
+
+void QUaModbusValue::on_percentDeadbandChanged(const QVariant & value, const bool & networkChange)
+{
+	m_percentDeadbandCache = value.toDouble();
+	this->updateDeadband();
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->percentDeadbandChanged(m_percentDeadbandCache);
+}
+
+void QUaModbusValue::on_rangeLowChanged(const QVariant & value, const bool & networkChange)
+{
+	m_rangeLowCache = value.toDouble();
+	this->updateDeadband();
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->rangeLowChanged(m_rangeLowCache);
+}
+
+void QUaModbusValue::on_rangeHighChanged(const QVariant & value, const bool & networkChange)
+{
+	m_rangeHighCache = value.toDouble();
+	this->updateDeadband();
+	if (!networkChange)
+	{
+		return;
+	}
+	// emit
+	emit this->rangeHighChanged(m_rangeHighCache);
+}
+
+void QUaModbusValue::on_updateWriteResult(const quint32 & writeId, const QModbusError & error)
+{
+	// only the latest optimistic write decides the published value
+	if (!m_writePending || writeId != m_writeId)
+	{
+		return;
+	}
+	m_writePending = false;
+	if (error == QModbusError::NoError)
+	{
+		m_confirmedValue = m_pendingValue;
+		this->updateStatusCode();
+		return;
+	}
+	// roll back to last value known from device
+	// NOTE : set value before emitting to avoid recursion
+	m_deadbandReference = m_confirmedValue;
+	this->value()->setValue(m_confirmedValue);
+	this->updateStatusCode();
+	// emit
+	emit this->valueChanged(m_confirmedValue);
+}
+
 void QUaModbusValue::on_updateLastError(const QModbusError & error)
 {
 	// avoid update or emit if no change, improves performance	
@@ -492,16 +822,37 @@ void QUaModbusValue::on_updateLastError(const QModbusError & error)
 	}
 	m_lastErrorCache = error;
 	// update
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	this->lastError()->setValue(error);
+#else
+	// quality in same notification as value
+	this->updateStatusCode();
+	this->value()->setSourceTimestamp(QDateTime::currentDateTimeUtc());
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 	// emit
 	emit this->lastErrorChanged(error);
 }
 
+void QUaModbusValue::updateStatusCode()
+{
+	if (m_writePending)
+	{
+		this->value()->setStatusCode(QUaStatus::UncertainLastUsableValue);
+		return;
+	}
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
+	this->value()->setStatusCode(QUaStatus::Good);
+#else
+	this->value()->setStatusCode(QUaModbusValue::errorToStatus(m_lastErrorCache));
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
+}
+
 // programmatic change from block upstream (modbus response to read request)
 void QUaModbusValue::setValue(
 	const QVector<quint16>& block, 
 	const QModbusError &blockError,
-	const bool forceIfSame /*= false*/
+	const bool forceIfSame /*= false*/,
+	const QDateTime &sourceTimestamp /*= QDateTime()*/
 )
 {
 	// check configuration
@@ -512,7 +863,7 @@ void QUaModbusValue::setValue(
 	// check if fits in block
 	auto type = this->getType();
 	int addressOffset = this->getAddressOffset();
-	int typeBlockSize = QUaModbusValue::typeBlockSize(type);
+	int typeBlockSize = this->blockSize();
 	if (addressOffset + typeBlockSize > block.count())
 	{
 		auto newError = blockError != QModbusError::NoError ? blockError : QModbusError::ConfigurationError;
@@ -524,20 +875,53 @@ void QUaModbusValue::setValue(
 	{
 		return;
 	}
+	// convert to value
+	QUaModbusTracer::traceCurrent(QUaModbusTracer::Decode);
+	bool bOK;
+	auto value = QUaModbusValue::blockToValue(block.mid(addressOffset, typeBlockSize), type, m_countCache, &bOK);
+	// registers do not hold a value of this type (e.g. bad BCD digit)
+	if (!bOK)
+	{
+		this->setLastError(QModbusError::ConfigurationError);
+		return;
+	}
 	if (this->getLastError() != QModbusError::NoError || forceIfSame)
 	{
 		this->setLastError(QModbusError::NoError);
 	}
-	// convert to value
-	auto value = QUaModbusValue::blockToValue(block.mid(addressOffset, typeBlockSize), type);
+	m_confirmedValue = value;
+	// pending optimistic write, only confirmed once read from device (older reads are ignored)
+	if (m_writePending)
+	{
+		if (value != m_pendingValue)
+		{
+			return;
+		}
+		m_writePending = false;
+		this->updateStatusCode();
+		return;
+	}
+	// avoid update or emit if within deadband, reduces notifications
+	if (!forceIfSame && this->isWithinDeadband(value))
+	{
+		m_deadbandSuppressed++;
+		return;
+	}
 	// avoid update or emit if no change, improves performance
 	auto oldValue = this->getValue();
 	if (oldValue == value && !forceIfSame)
 	{
 		return;
 	}
+	m_deadbandReference = value;
+	QUaModbusTracer::traceCurrent(QUaModbusTracer::Publish);
 	// NOTE : set value before emitting to avoid recursion
 	this->value()->setValue(value);
+	if (sourceTimestamp.isValid())
+	{
+		this->value()->setSourceTimestamp(sourceTimestamp);
+	}
+	QUaModbusMetrics::addValueUpdate();
 	// emit
 	emit this->valueChanged(value);
 }
@@ -564,6 +948,45 @@ void QUaModbusValue::updateWellConfigured(const QModbusValueType& type, const in
 	}
 }
 
+void QUaModbusValue::updateDeadband()
+{
+	// use the largest of both deadbands
+	double span = m_rangeHighCache - m_rangeLowCache;
+	double percent = span > 0.0 ? qMax(m_percentDeadbandCache, 0.0) * span / 100.0 : 0.0;
+	m_deadband = qMax(qMax(m_absoluteDeadbandCache, 0.0), percent);
+}
+
+bool QUaModbusValue::isWithinDeadband(const QVariant & value) const
+{
+	// only for numeric types and once something was published
+	if (m_deadband <= 0.0 ||
+		m_typeCache < QModbusValueType::Decimal ||
+		QUaModbusValue::typeIsString(m_typeCache) ||
+		!m_deadbandReference.isValid())
+	{
+		return false;
+	}
+	// arrays are within deadband only if all elements are
+	if (m_countCache > 1)
+	{
+		auto list = value.toList();
+		auto refs = m_deadbandReference.toList();
+		if (list.count() != refs.count())
+		{
+			return false;
+		}
+		for (int i = 0; i < list.count(); i++)
+		{
+			if (qAbs(list.at(i).toDouble() - refs.at(i).toDouble()) > m_deadband)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	return qAbs(value.toDouble() - m_deadbandReference.toDouble()) <= m_deadband;
+}
+
 QDomElement QUaModbusValue::toDomElement(QDomDocument & domDoc) const
 {
 	// add value element
@@ -579,6 +1002,12 @@ QDomElement QUaModbusValue::toDomElement(QDomDocument & domDoc) const
 	elemValue.setAttribute("BrowseName"   , this->browseName().name());
 	elemValue.setAttribute("Type"         , QMetaEnum::fromType<QModbusValueType>().valueToKey(this->getType()));
 	elemValue.setAttribute("AddressOffset", this->getAddressOffset());
+	elemValue.setAttribute("Count"        , this->getCount());
+	elemValue.setAttribute("OptimisticWrite", this->getOptimisticWrite());
+	elemValue.setAttribute("AbsoluteDeadband", this->getAbsoluteDeadband());
+	elemValue.setAttribute("PercentDeadband" , this->getPercentDeadband());
+	elemValue.setAttribute("RangeLow"        , this->getRangeLow());
+	elemValue.setAttribute("RangeHigh"       , this->getRangeHigh());
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	elemValue.setAttribute("CyclicWriteMode"  , QMetaEnum::fromType<QModbusCyclicWriteMode>().valueToKey(this->getCyclicWriteMode()));
 	elemValue.setAttribute("CyclicWritePeriod", this->getCyclicWritePeriod());
@@ -636,6 +1065,108 @@ void QUaModbusValue::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& error
 			QUaLogCategory::Serialization
 		);
 	}
+	// Count (optional)
+	if (domElem.hasAttribute("Count"))
+	{
+		auto count = domElem.attribute("Count").toUInt(&bOK);
+		if (bOK && count > 0 && count <= 0xFFFF)
+		{
+			this->setCount(count);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid Count attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("Count")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// OptimisticWrite (optional)
+	if (domElem.hasAttribute("OptimisticWrite"))
+	{
+		auto optimisticWrite = (bool)domElem.attribute("OptimisticWrite").toUInt(&bOK);
+		if (bOK)
+		{
+			this->setOptimisticWrite(optimisticWrite);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid OptimisticWrite attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("OptimisticWrite")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// AbsoluteDeadband (optional)
+	if (domElem.hasAttribute("AbsoluteDeadband"))
+	{
+		auto absoluteDeadband = domElem.attribute("AbsoluteDeadband").toDouble(&bOK);
+		if (bOK)
+		{
+			this->setAbsoluteDeadband(absoluteDeadband);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid AbsoluteDeadband attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("AbsoluteDeadband")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// PercentDeadband (optional)
+	if (domElem.hasAttribute("PercentDeadband"))
+	{
+		auto percentDeadband = domElem.attribute("PercentDeadband").toDouble(&bOK);
+		if (bOK)
+		{
+			this->setPercentDeadband(percentDeadband);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid PercentDeadband attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("PercentDeadband")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// RangeLow (optional)
+	if (domElem.hasAttribute("RangeLow"))
+	{
+		auto rangeLow = domElem.attribute("RangeLow").toDouble(&bOK);
+		if (bOK)
+		{
+			this->setRangeLow(rangeLow);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid RangeLow attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("RangeLow")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
+	// RangeHigh (optional)
+	if (domElem.hasAttribute("RangeHigh"))
+	{
+		auto rangeHigh = domElem.attribute("RangeHigh").toDouble(&bOK);
+		if (bOK)
+		{
+			this->setRangeHigh(rangeHigh);
+		}
+		else
+		{
+			errorLogs << QUaLog(
+				tr("Invalid RangeHigh attribute '%1' in Value %2. Default value set.").arg(domElem.attribute("RangeHigh")).arg(strBrowseName),
+				QUaLogLevel::Warning,
+				QUaLogCategory::Serialization
+			);
+		}
+	}
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	// CyclicWriteMode
 	auto mode = (QModbusCyclicWriteMode)QMetaEnum::fromType<QModbusCyclicWriteMode>().keysToValue(domElem.attribute("CyclicWriteMode").toUtf8(), &bOK);
@@ -668,418 +1199,396 @@ void QUaModbusValue::fromDomElement(QDomElement & domElem, QQueue<QUaLog>& error
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 }
 
-int QUaModbusValue::typeBlockSize(const QModbusValueType & type)
+namespace {
+
+// raw bits of N registers, word and byte order given at compile time
+template<int N, bool MostFirst, bool ByteSwap>
+inline quint64 registersToBits(const quint16 * regs)
 {
-	int iSize = 0;
-	switch (type)
-	{
-		case Binary0:
-		case Binary1:
-		case Binary2:
-		case Binary3:
-		case Binary4:
-		case Binary5:
-		case Binary6:
-		case Binary7:
-		case Binary8:
-		case Binary9:
-		case Binary10:
-		case Binary11:
-		case Binary12:
-		case Binary13:
-		case Binary14:
-		case Binary15:
-		case Decimal:
-		{
-			iSize = 1;
-			break;
-		}
-		case Int:
-		case IntSwapped:
-		case Float:
-		case FloatSwapped:
-		{
-			iSize = 2;
-			break;
-		}
-		case Int64:
-		case Int64Swapped:
-		case Float64:
-		case Float64Swapped:
-		{
-			iSize = 4;
-			break;
-		}
-		default /*Invalid*/:
+	quint64 bits = 0;
+	for (int i = 0; i < N; i++)
+	{
+		quint16 reg = regs[MostFirst ? i : N - 1 - i];
+		bits = (bits << 16) | (ByteSwap ? qbswap(reg) : reg);
+	}
+	return bits;
+}
+
+template<int N, bool MostFirst, bool ByteSwap>
+inline void bitsToRegisters(quint64 bits, quint16 * regs)
+{
+	for (int i = N - 1; i >= 0; i--)
+	{
+		quint16 reg = static_cast<quint16>(bits & 0xFFFFuLL);
+		regs[MostFirst ? i : N - 1 - i] = ByteSwap ? qbswap(reg) : reg;
+		bits >>= 16;
+	}
+}
+
+template<typename T>
+inline T variantTo(const QVariant & value)
+{
+	return static_cast<T>(value.toLongLong());
+}
+
+template<>
+inline quint64 variantTo<quint64>(const QVariant & value)
+{
+	return value.toULongLong();
+}
+
+template<>
+inline float variantTo<float>(const QVariant & value)
+{
+	return value.toFloat();
+}
+
+template<>
+inline double variantTo<double>(const QVariant & value)
+{
+	return value.toDouble();
+}
+
+// numbers of 16, 32 or 64 bits
+template<typename T, bool MostFirst, bool ByteSwap>
+QVariant decodeNumber(const quint16 * regs)
+{
+	typedef typename QIntegerForSizeof<T>::Unsigned Raw;
+	Raw raw = static_cast<Raw>(registersToBits<sizeof(T) / 2, MostFirst, ByteSwap>(regs));
+	T res;
+	memcpy(&res, &raw, sizeof(T));
+	return QVariant::fromValue(res);
+}
+
+template<typename T, bool MostFirst, bool ByteSwap>
+bool encodeNumber(const QVariant & value, quint16 * regs)
+{
+	typedef typename QIntegerForSizeof<T>::Unsigned Raw;
+	T val = variantTo<T>(value);
+	Raw raw;
+	memcpy(&raw, &val, sizeof(T));
+	bitsToRegisters<sizeof(T) / 2, MostFirst, ByteSwap>(raw, regs);
+	return true;
+}
+
+// single bit of a register
+template<int Bit>
+QVariant decodeBit(const quint16 * regs)
+{
+	return QVariant::fromValue(((regs[0] >> Bit) & 0x0001) == 1);
+}
+
+// NOTE : any non zero register is true, coils are read as 0 or 1
+template<>
+QVariant decodeBit<0>(const quint16 * regs)
+{
+	return QVariant::fromValue(regs[0] > 0);
+}
+
+template<int Bit>
+bool encodeBit(const QVariant & value, quint16 * regs)
+{
+	regs[0] = value.toBool() ? static_cast<quint16>(0x0001 << Bit) : 0;
+	return true;
+}
+
+// binary coded decimal, N registers Most Significant Register First
+// NOTE : invalid variant if a digit is above 9
+template<int N>
+QVariant decodeBcd(const quint16 * regs)
+{
+	quint64 bits = registersToBits<N, true, false>(regs);
+	quint32 res  = 0;
+	for (int i = N * 4 - 1; i >= 0; i--)
+	{
+		quint32 digit = (bits >> (i * 4)) & 0x0F;
+		if (digit > 9)
 		{
-			break;
+			return QVariant();
 		}
+		res = res * 10 + digit;
+	}
+	return N == 1 ? QVariant::fromValue(static_cast<quint16>(res)) : QVariant::fromValue(res);
+}
+
+// NOTE : fails for negative values or more digits than fit
+template<int N>
+bool encodeBcd(const QVariant & value, quint16 * regs)
+{
+	bool bOK;
+	qlonglong num = value.toLongLong(&bOK);
+	qlonglong max = N == 1 ? 9999LL : 99999999LL;
+	if (!bOK || num < 0 || num > max)
+	{
+		return false;
+	}
+	quint32 val  = static_cast<quint32>(num);
+	quint64 bits = 0;
+	for (int i = 0; i < N * 4; i++)
+	{
+		bits |= static_cast<quint64>(val % 10) << (i * 4);
+		val /= 10;
 	}
-	return iSize;
+	bitsToRegisters<N, true, false>(bits, regs);
+	return true;
+}
+
+// two characters per register, first character in high byte unless swapped
+template<bool ByteSwap>
+QString decodeString(const quint16 * regs, const int & count)
+{
+	QByteArray bytes;
+	bytes.reserve(count * 2);
+	for (int i = 0; i < count; i++)
+	{
+		quint16 reg = ByteSwap ? qbswap(regs[i]) : regs[i];
+		bytes.append(static_cast<char>(reg >> 8));
+		bytes.append(static_cast<char>(reg & 0xFF));
+	}
+	// fixed length, padded with nulls
+	int end = bytes.indexOf('\0');
+	return QString::fromLatin1(end < 0 ? bytes : bytes.left(end));
+}
+
+template<bool ByteSwap>
+void encodeString(const QString & value, quint16 * regs, const int & count)
+{
+	QByteArray bytes = value.toLatin1().leftJustified(count * 2, '\0', true);
+	for (int i = 0; i < count; i++)
+	{
+		quint16 reg = (static_cast<quint8>(bytes.at(i * 2)) << 8) | static_cast<quint8>(bytes.at(i * 2 + 1));
+		regs[i] = ByteSwap ? qbswap(reg) : reg;
+	}
+}
+
+template<bool ByteSwap>
+QVariant decodeString(const quint16 * regs)
+{
+	return decodeString<ByteSwap>(regs, 1);
+}
+
+template<bool ByteSwap>
+bool encodeString(const QVariant & value, quint16 * regs)
+{
+	encodeString<ByteSwap>(value.toString(), regs, 1);
+	return true;
+}
+
+struct QUaModbusCodec
+{
+	int             size; // registers per element
+	QMetaType::Type meta;
+	QVariant (*decode)(const quint16 * regs);
+	bool     (*encode)(const QVariant & value, quint16 * regs);
+};
+
+// NOTE : indexed by QModbusValueType, keep in same order
+const QUaModbusCodec codecTable[] = {
+	{ 1, QMetaType::Bool     , &decodeBit<0 >, &encodeBit<0 > }, // Binary0
+	{ 1, QMetaType::Bool     , &decodeBit<1 >, &encodeBit<1 > }, // Binary1
+	{ 1, QMetaType::Bool     , &decodeBit<2 >, &encodeBit<2 > }, // Binary2
+	{ 1, QMetaType::Bool     , &decodeBit<3 >, &encodeBit<3 > }, // Binary3
+	{ 1, QMetaType::Bool     , &decodeBit<4 >, &encodeBit<4 > }, // Binary4
+	{ 1, QMetaType::Bool     , &decodeBit<5 >, &encodeBit<5 > }, // Binary5
+	{ 1, QMetaType::Bool     , &decodeBit<6 >, &encodeBit<6 > }, // Binary6
+	{ 1, QMetaType::Bool     , &decodeBit<7 >, &encodeBit<7 > }, // Binary7
+	{ 1, QMetaType::Bool     , &decodeBit<8 >, &encodeBit<8 > }, // Binary8
+	{ 1, QMetaType::Bool     , &decodeBit<9 >, &encodeBit<9 > }, // Binary9
+	{ 1, QMetaType::Bool     , &decodeBit<10>, &encodeBit<10> }, // Binary10
+	{ 1, QMetaType::Bool     , &decodeBit<11>, &encodeBit<11> }, // Binary11
+	{ 1, QMetaType::Bool     , &decodeBit<12>, &encodeBit<12> }, // Binary12
+	{ 1, QMetaType::Bool     , &decodeBit<13>, &encodeBit<13> }, // Binary13
+	{ 1, QMetaType::Bool     , &decodeBit<14>, &encodeBit<14> }, // Binary14
+	{ 1, QMetaType::Bool     , &decodeBit<15>, &encodeBit<15> }, // Binary15
+	{ 1, QMetaType::Short    , &decodeNumber<quint16, true , false>, &encodeNumber<quint16, true , false> }, // Decimal
+	{ 2, QMetaType::Int      , &decodeNumber<qint32 , false, false>, &encodeNumber<qint32 , false, false> }, // Int
+	{ 2, QMetaType::Int      , &decodeNumber<qint32 , true , false>, &encodeNumber<qint32 , true , false> }, // IntSwapped
+	{ 2, QMetaType::Float    , &decodeNumber<float  , false, false>, &encodeNumber<float  , false, false> }, // Float
+	{ 2, QMetaType::Float    , &decodeNumber<float  , true , false>, &encodeNumber<float  , true , false> }, // FloatSwapped
+	{ 4, QMetaType::LongLong , &decodeNumber<qint64 , false, false>, &encodeNumber<qint64 , false, false> }, // Int64
+	{ 4, QMetaType::LongLong , &decodeNumber<qint64 , true , false>, &encodeNumber<qint64 , true , false> }, // Int64Swapped
+	{ 4, QMetaType::Double   , &decodeNumber<double , false, false>, &encodeNumber<double , false, false> }, // Float64
+	{ 4, QMetaType::Double   , &decodeNumber<double , true , false>, &encodeNumber<double , true , false> }, // Float64Swapped
+	{ 1, QMetaType::Short    , &decodeNumber<qint16 , true , false>, &encodeNumber<qint16 , true , false> }, // Int16
+	{ 2, QMetaType::UInt     , &decodeNumber<quint32, false, false>, &encodeNumber<quint32, false, false> }, // UInt
+	{ 2, QMetaType::UInt     , &decodeNumber<quint32, true , false>, &encodeNumber<quint32, true , false> }, // UIntSwapped
+	{ 4, QMetaType::ULongLong, &decodeNumber<quint64, false, false>, &encodeNumber<quint64, false, false> }, // UInt64
+	{ 4, QMetaType::ULongLong, &decodeNumber<quint64, true , false>, &encodeNumber<quint64, true , false> }, // UInt64Swapped
+	{ 2, QMetaType::Int      , &decodeNumber<qint32 , true , true >, &encodeNumber<qint32 , true , true > }, // IntBADC
+	{ 2, QMetaType::Int      , &decodeNumber<qint32 , false, true >, &encodeNumber<qint32 , false, true > }, // IntDCBA
+	{ 2, QMetaType::UInt     , &decodeNumber<quint32, true , true >, &encodeNumber<quint32, true , true > }, // UIntBADC
+	{ 2, QMetaType::UInt     , &decodeNumber<quint32, false, true >, &encodeNumber<quint32, false, true > }, // UIntDCBA
+	{ 2, QMetaType::Float    , &decodeNumber<float  , true , true >, &encodeNumber<float  , true , true > }, // FloatBADC
+	{ 2, QMetaType::Float    , &decodeNumber<float  , false, true >, &encodeNumber<float  , false, true > }, // FloatDCBA
+	{ 4, QMetaType::LongLong , &decodeNumber<qint64 , true , true >, &encodeNumber<qint64 , true , true > }, // Int64BADC
+	{ 4, QMetaType::LongLong , &decodeNumber<qint64 , false, true >, &encodeNumber<qint64 , false, true > }, // Int64DCBA
+	{ 4, QMetaType::ULongLong, &decodeNumber<quint64, true , true >, &encodeNumber<quint64, true , true > }, // UInt64BADC
+	{ 4, QMetaType::ULongLong, &decodeNumber<quint64, false, true >, &encodeNumber<quint64, false, true > }, // UInt64DCBA
+	{ 4, QMetaType::Double   , &decodeNumber<double , true , true >, &encodeNumber<double , true , true > }, // Float64BADC
+	{ 4, QMetaType::Double   , &decodeNumber<double , false, true >, &encodeNumber<double , false, true > }, // Float64DCBA
+	{ 1, QMetaType::UShort   , &decodeBcd<1>, &encodeBcd<1> }, // Bcd16
+	{ 2, QMetaType::UInt     , &decodeBcd<2>, &encodeBcd<2> }, // Bcd32
+	{ 1, QMetaType::QString  , &decodeString<false>, &encodeString<false> }, // String
+	{ 1, QMetaType::QString  , &decodeString<true >, &encodeString<true > }, // StringByteSwapped
+};
+Q_STATIC_ASSERT(sizeof(codecTable) / sizeof(codecTable[0]) == QUaModbusValue::StringByteSwapped + 1);
+
+inline const QUaModbusCodec * codec(const QModbusValueType & type)
+{
+	if (type < QModbusValueType::Binary0 || type > QModbusValueType::StringByteSwapped)
+	{
+		return nullptr;
+	}
+	return &codecTable[type];
+}
+
+} // namespace
+
+int QUaModbusValue::typeBlockSize(const QModbusValueType & type)
+{
+	auto typeCodec = codec(type);
+	return typeCodec ? typeCodec->size : 0;
+}
+
+void QUaModbusValue::updateValueDataType()
+{
+	// strings span registers but are a single element
+	bool isArray = m_countCache > 1 && !QUaModbusValue::typeIsString(m_typeCache);
+	this->value()->setDataType(QUaModbusValue::typeToMeta(m_typeCache));
+	this->value()->setValueRank(isArray ? 1 : -1);
+	this->value()->setArrayDimensions(isArray ? QVector<quint32>({ m_countCache }) : QVector<quint32>());
 }
 
 QMetaType::Type QUaModbusValue::typeToMeta(const QModbusValueType & type)
 {
-	QMetaType::Type metaType = QMetaType::UnknownType;
-	switch (type)
-	{
-		case Binary0:
-		case Binary1:
-		case Binary2:
-		case Binary3:
-		case Binary4:
-		case Binary5:
-		case Binary6:
-		case Binary7:
-		case Binary8:
-		case Binary9:
-		case Binary10:
-		case Binary11:
-		case Binary12:
-		case Binary13:
-		case Binary14:
-		case Binary15:
-		{
-			metaType = QMetaType::Bool;
-			break;
-		}
-		case Decimal:
-		{
-			metaType = QMetaType::Short;
-			break;
-		}
-		case Int:
-		case IntSwapped:
-		{
-			metaType = QMetaType::Int;
-			break;
-		}
-		case Float:
-		case FloatSwapped:
-		{
-			metaType = QMetaType::Float;
-			break;
-		}
-		case Int64:
-		case Int64Swapped:
-		{
-			metaType = QMetaType::LongLong;
-			break;
-		}
-		case Float64:
-		case Float64Swapped:
-		{
-			metaType = QMetaType::Double;
-			break;
-		}
-		default /*Invalid*/:
-		{
-			break;
-		}
+	auto typeCodec = codec(type);
+	return typeCodec ? typeCodec->meta : QMetaType::UnknownType;
+}
+
+bool QUaModbusValue::typeIsString(const QModbusValueType & type)
+{
+	return type == QModbusValueType::String || type == QModbusValueType::StringByteSwapped;
+}
+
+QUaStatus QUaModbusValue::errorToStatus(const QModbusError & error)
+{
+	switch (error)
+	{
+	case QModbusError::NoError:
+		return QUaStatus::Good;
+	case QModbusError::ConnectionError:
+		return QUaStatus::BadNotConnected;
+	case QModbusError::TimeoutError:
+		return QUaStatus::BadTimeout;
+	case QModbusError::ReadError:
+		return QUaStatus::BadCommunicationError;
+	case QModbusError::ConfigurationError:
+		return QUaStatus::BadConfigurationError;
+	case QModbusError::ProtocolError:
+		// modbus exception from device
+		return QUaStatus::BadDeviceFailure;
+	case QModbusError::WriteError:
+	case QModbusError::ReplyAbortedError:
+		// value still the last one read
+		return QUaStatus::UncertainLastUsableValue;
+	default:
+		return QUaStatus::BadUnexpectedError;
 	}
-	return metaType;
 }
 
-QVariant QUaModbusValue::blockToValue(const QVector<quint16>& block, const QModbusValueType & type)
+QVariant QUaModbusValue::blockToValue(const QVector<quint16>& block, const QModbusValueType & type, const quint16 &count/* = 1*/, bool * ok/* = nullptr*/)
 {
-	QVariant retVar;
-	switch(type)
+	if (ok)
 	{
-		case Binary0        :
-		{
-			Q_ASSERT(block.count() >= 1);
-			if (block.first() > 0)
-			{
-				retVar = QVariant::fromValue(true);
-			}
-			else
-			{
-				retVar = QVariant::fromValue(false);
-			}
-			break;
-		}
-		case Binary1        :
-		case Binary2        :
-		case Binary3        :
-		case Binary4        :
-		case Binary5        :
-		case Binary6        :
-		case Binary7        :
-		case Binary8        :
-		case Binary9        :
-		case Binary10       :
-		case Binary11       :
-		case Binary12       :
-		case Binary13       :
-		case Binary14       :
-		case Binary15       :
+		*ok = true;
+	}
+	auto typeCodec = codec(type);
+	if (!typeCodec)
+	{
+		return QVariant();
+	}
+	// strings use all registers as characters
+	if (QUaModbusValue::typeIsString(type))
+	{
+		int size = qMin(static_cast<int>(count), block.count());
+		return type == QModbusValueType::String ?
+			decodeString<false>(block.constData(), size) :
+			decodeString<true >(block.constData(), size);
+	}
+	// array, decode each element
+	if (count > 1)
+	{
+		int size = typeCodec->size;
+		QVariantList listRes;
+		listRes.reserve(count);
+		for (int i = 0; i < count && (i + 1) * size <= block.count(); i++)
 		{
-			Q_ASSERT(block.count() >= 1);
-			// shift uiValue bits to right 'type' times
-			quint16 iTmp = block.first() >> type;
-			iTmp &= 0x0001;
-			if (iTmp == 1)
+			auto element = typeCodec->decode(block.constData() + i * size);
+			if (!element.isValid() && ok)
 			{
-				retVar = QVariant::fromValue(true);
+				*ok = false;
 			}
-			else
-			{
-				retVar = QVariant::fromValue(false);
-			}
-			break;
-		}
-		case Decimal        :
-		{
-			Q_ASSERT(block.count() >= 1);
-			retVar = QVariant::fromValue(block.first());
-			break;
-		}
-		case Int            :
-		{
-			Q_ASSERT(block.count() >= 2);
-			// i32 Least Significant Register First
-			int iRes = (int)(((quint32)block.at(1) << 16) | ((quint32)block.at(0)));
-			retVar = QVariant::fromValue(iRes);
-			break;
-		}
-		case IntSwapped     :
-		{
-			Q_ASSERT(block.count() >= 2);
-			int iRes = (int)(((quint32)block.at(0) << 16) | ((quint32)block.at(1)));
-			retVar = QVariant::fromValue(iRes);
-			break;
-		}
-		case Float          :
-		{
-			Q_ASSERT(block.count() >= 2);
-			float fRes = 0;
-			// f32 Least Significant Register First
-			quint32 iTmp  = (((quint32)block.at(1) << 16) | ((quint32)block.at(0)));
-			memcpy(&fRes, &iTmp, sizeof(quint32));
-			retVar = QVariant::fromValue(fRes);
-			break;
-		}
-		case FloatSwapped   :
-		{
-			Q_ASSERT(block.count() >= 2);
-			float fRes = 0;
-			// f32 Most Significant Register First
-			quint32 iTmp = (((quint32)block.at(0) << 16) | ((quint32)block.at(1)));
-			memcpy(&fRes, &iTmp, sizeof(quint32));
-			retVar = QVariant::fromValue(fRes);
-			break;
-		}
-		case Int64          :
-		{
-			Q_ASSERT(block.count() >= 4);
-			qint64 iRes = 0;
-			// i64 Least Significant Register First
-			quint64 iTmp = (((quint64)block.at(3) << 48) | 
-				            ((quint64)block.at(2) << 32) | 
-				            ((quint64)block.at(1) << 16) | 
-				            ((quint64)block.at(0)));
-			memcpy(&iRes, &iTmp, sizeof(quint64));
-			retVar = QVariant::fromValue(iRes);
-			break;
-		}
-		case Int64Swapped   :
-		{
-			Q_ASSERT(block.count() >= 4);
-			qint64 iRes = 0;
-			// i64 Most Significant Register First
-			quint64 iTmp = (((quint64)block.at(0) << 48) | 
-				            ((quint64)block.at(1) << 32) | 
-				            ((quint64)block.at(2) << 16) | 
-				            ((quint64)block.at(3)));
-			memcpy(&iRes, &iTmp, sizeof(quint64));
-			retVar = QVariant::fromValue(iRes);
-			break;
-		}
-		case Float64        :
-		{
-			Q_ASSERT(block.count() >= 4);
-			double dRes = 0;
-			// f64 Least Significant Register First
-			quint64 iTmp = (((quint64)block.at(3) << 48) | 
-				            ((quint64)block.at(2) << 32) | 
-				            ((quint64)block.at(1) << 16) | 
-				            ((quint64)block.at(0)));
-			memcpy(&dRes, &iTmp, sizeof(quint64));
-			retVar = QVariant::fromValue(dRes);
-			break;
-		}
-		case Float64Swapped :
-		{
-			Q_ASSERT(block.count() >= 4);
-			double dRes = 0;
-			// f64 Most Significant Register First
-			quint64 iTmp = (((quint64)block.at(0) << 48) | 
-				            ((quint64)block.at(1) << 32) | 
-				            ((quint64)block.at(2) << 16) | 
-				            ((quint64)block.at(3)));
-			memcpy(&dRes, &iTmp, sizeof(quint64));
-			retVar = QVariant::fromValue(dRes);
-			break;
-		}
-		default : // Invalid
-		{
-			break;
+			listRes << element;
 		}
+		return listRes;
 	}
-	return retVar;
+	Q_ASSERT(block.count() >= typeCodec->size);
+	if (block.count() < typeCodec->size)
+	{
+		return QVariant();
+	}
+	auto value = typeCodec->decode(block.constData());
+	if (!value.isValid() && ok)
+	{
+		*ok = false;
+	}
+	return value;
 }
 
-QVector<quint16> QUaModbusValue::valueToBlock(const QVariant & value, const QModbusValueType & type)
+QVector<quint16> QUaModbusValue::valueToBlock(const QVariant & value, const QModbusValueType & type, const quint16 &count/* = 1*/, bool * ok/* = nullptr*/)
 {
-	QVector<quint16> block;
-	switch(type)
+	if (ok)
 	{
-		case Binary0        :
-		{
-			block.resize(1);
-			bool bValue = value.toBool();		
-			if (bValue)
-			{
-				block[0] = 1;
-			}
-			else
-			{
-				block[0] = 0;
-			}
-			break;
-		}
-		case Binary1        :
-		case Binary2        :
-		case Binary3        :
-		case Binary4        :
-		case Binary5        :
-		case Binary6        :
-		case Binary7        :
-		case Binary8        :
-		case Binary9        :
-		case Binary10       :
-		case Binary11       :
-		case Binary12       :
-		case Binary13       :
-		case Binary14       :
-		case Binary15       :
-		{
-			block.resize(1);
-			bool bValue = value.toBool();
-			if (bValue)
-			{
-				// shift iTmp bits to left [type] times
-				quint16 iTmp = 0x0001;
-				block[0] = iTmp << type;
-			}
-			else
-			{
-				block[0] = 0;
-			}
-			break;
-		}
-		case Decimal        :
-		{
-			block.resize(1);
-			block[0] = (quint16)value.toUInt();
-			break;
-		}
-		case Int            :
-		{
-			block.resize(2);
-			int iValue = value.toInt();
-			// i32 Least Significant Register First
-			block[0] = (quint16)(iValue & 0x0000FFFFuL);
-			block[1] = (quint16)(iValue >> 16);
-			break;
-		}
-		case IntSwapped     :
-		{
-			block.resize(2);
-			int iValue = value.toInt();
-			// i32 Most Significant Register First
-			block[1] = (quint16)(iValue & 0x0000FFFFuL);
-			block[0] = (quint16)(iValue >> 16);
-			break;
-		}
-		case Float          :
-		{
-			block.resize(2);
-			float fValue = value.toFloat();
-			// f32 Least Significant Register First
-			quint32 iTmp;
-			memcpy(&iTmp, &fValue, sizeof(quint32));
-			block[0] = (quint16)(iTmp & 0x0000FFFFuL);
-			block[1] = (quint16)(iTmp >> 16);
-			break;
-		}
-		case FloatSwapped   :
-		{
-			block.resize(2);
-			float fValue = value.toFloat();
-			// f32 Most Significant Register First
-			quint32 iTmp;
-			memcpy(&iTmp, &fValue, sizeof(quint32));
-			block[1] = (quint16)(iTmp & 0x0000FFFFuL);
-			block[0] = (quint16)(iTmp >> 16);
-			break;
-		}
-		case Int64          :
-		{
-			block.resize(4);
-			qint64 iValue = value.toLongLong();
-			// i64 Least Significant Register First
-			quint64 iTmp;
-			memcpy(&iTmp, &iValue, sizeof(quint64));
-			block[0] = (quint16)(iTmp & 0x000000000000FFFFuLL);
-			block[1] = (quint16)(iTmp >> 16);
-			block[2] = (quint16)(iTmp >> 32);
-			block[3] = (quint16)(iTmp >> 48);
-			break;
-		}
-		case Int64Swapped   :
-		{
-			block.resize(4);
-			qint64 iValue = value.toLongLong();
-			// i64 Most Significant Register First
-			quint64 iTmp;
-			memcpy(&iTmp, &iValue, sizeof(quint64));
-			block[3] = (quint16)(iTmp & 0x000000000000FFFFuLL);
-			block[2] = (quint16)(iTmp >> 16);
-			block[1] = (quint16)(iTmp >> 32);
-			block[0] = (quint16)(iTmp >> 48);
-			break;
-		}
-		case Float64        :
+		*ok = true;
+	}
+	auto typeCodec = codec(type);
+	if (!typeCodec)
+	{
+		return QVector<quint16>();
+	}
+	// strings use all registers as characters
+	if (QUaModbusValue::typeIsString(type))
+	{
+		QVector<quint16> block(count);
+		if (type == QModbusValueType::String)
 		{
-			block.resize(4);
-			double dValue = value.toDouble();
-			// f64 Least Significant Register First
-			quint64 iTmp;
-			memcpy(&iTmp, &dValue, sizeof(quint64));
-			block[0] = (quint16)(iTmp & 0x000000000000FFFFuLL);
-			block[1] = (quint16)(iTmp >> 16);
-			block[2] = (quint16)(iTmp >> 32);
-			block[3] = (quint16)(iTmp >> 48);
-			break;
+			encodeString<false>(value.toString(), block.data(), count);
 		}
-		case Float64Swapped :
+		else
 		{
-			block.resize(4);
-			double dValue = value.toDouble();
-			// f64 Most Significant Register First
-			quint64 iTmp;
-			memcpy(&iTmp, &dValue, sizeof(quint64));
-			block[3] = (quint16)(iTmp & 0x000000000000FFFFuLL);
-			block[2] = (quint16)(iTmp >> 16);
-			block[1] = (quint16)(iTmp >> 32);
-			block[0] = (quint16)(iTmp >> 48);
-			break;
+			encodeString<true>(value.toString(), block.data(), count);
 		}
-		default : // Invalid
+		return block;
+	}
+	// array, encode each element
+	if (count > 1)
+	{
+		auto list = value.toList();
+		int  num  = qMin(static_cast<int>(count), list.count());
+		QVector<quint16> block(num * typeCodec->size);
+		for (int i = 0; i < num; i++)
 		{
-			break;
+			if (!typeCodec->encode(list.at(i), block.data() + i * typeCodec->size) && ok)
+			{
+				*ok = false;
+			}
 		}
+		return block;
+	}
+	QVector<quint16> block(typeCodec->size);
+	if (!typeCodec->encode(value, block.data()) && ok)
+	{
+		*ok = false;
 	}
 	return block;
 }
@@ -1098,3 +1607,15 @@ QUaModbusClient* QUaModbusValue::client() const
 {
 	return this->block()->client();
 }
+
+QUaModbusMemoryUsage QUaModbusValue::memoryUsage() const
+{
+	QUaModbusMemoryUsage usage;
+	usage.objects  += sizeof(QUaModbusValue);
+	usage.addNodes(const_cast<QUaModbusValue*>(this));
+	// optimistic write and deadband caches
+	usage.variants += QUaModbusMemoryUsage::variantBytes(m_pendingValue);
+	usage.variants += QUaModbusMemoryUsage::variantBytes(m_confirmedValue);
+	usage.variants += QUaModbusMemoryUsage::variantBytes(m_deadbandReference);
+	return usage;
+}
@@ -12,6 +12,9 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QDateTime>
+
+#include "quamodbusmemoryusage.h"
 
 class QUaModbusDataBlock;
 class QUaModbusValueList;
@@ -34,13 +37,21 @@ class QUaModbusValue : public QUaBaseObjectProtected
 	Q_PROPERTY(QUaProperty * Type              READ type             )
 	Q_PROPERTY(QUaProperty * RegistersUsed     READ registersUsed    )
 	Q_PROPERTY(QUaProperty * AddressOffset     READ addressOffset    )
+	Q_PROPERTY(QUaProperty * Count             READ count            )
+	Q_PROPERTY(QUaProperty * OptimisticWrite   READ optimisticWrite  )
+	Q_PROPERTY(QUaProperty * AbsoluteDeadband  READ absoluteDeadband )
+	Q_PROPERTY(QUaProperty * PercentDeadband   READ percentDeadband  )
+	Q_PROPERTY(QUaProperty * RangeLow          READ rangeLow         )
+	Q_PROPERTY(QUaProperty * RangeHigh         READ rangeHigh        )
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	Q_PROPERTY(QUaProperty * CyclicWritePeriod READ cyclicWritePeriod)
 	Q_PROPERTY(QUaProperty * CyclicWriteMode   READ cyclicWriteMode  )
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 	// UA variables
 	Q_PROPERTY(QUaBaseDataVariable * Value     READ value    )
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	Q_PROPERTY(QUaBaseDataVariable * LastError READ lastError)
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 
 public:
 	Q_INVOKABLE explicit QUaModbusValue(QUaServer *server);
@@ -74,6 +85,27 @@ public:
 		Int64Swapped   = 22, // i64 Most Significant Register First
 		Float64        = 23, // f64 Least Significant Register First
 		Float64Swapped = 24, // f64 Most Significant Register First
+		Int16             = 25, // i16 (Decimal is u16)
+		UInt              = 26, // u32 Least Significant Register First
+		UIntSwapped       = 27, // u32 Most Significant Register First
+		UInt64            = 28, // u64 Least Significant Register First
+		UInt64Swapped     = 29, // u64 Most Significant Register First
+		IntBADC           = 30, // i32 Most Significant Register First, bytes swapped
+		IntDCBA           = 31, // i32 Least Significant Register First, bytes swapped
+		UIntBADC          = 32, // u32 Most Significant Register First, bytes swapped
+		UIntDCBA          = 33, // u32 Least Significant Register First, bytes swapped
+		FloatBADC         = 34, // f32 Most Significant Register First, bytes swapped
+		FloatDCBA         = 35, // f32 Least Significant Register First, bytes swapped
+		Int64BADC         = 36, // i64 Most Significant Register First, bytes swapped
+		Int64DCBA         = 37, // i64 Least Significant Register First, bytes swapped
+		UInt64BADC        = 38, // u64 Most Significant Register First, bytes swapped
+		UInt64DCBA        = 39, // u64 Least Significant Register First, bytes swapped
+		Float64BADC       = 40, // f64 Most Significant Register First, bytes swapped
+		Float64DCBA       = 41, // f64 Least Significant Register First, bytes swapped
+		Bcd16             = 42, // 4 digit binary coded decimal
+		Bcd32             = 43, // 8 digit binary coded decimal, Most Significant Register First
+		String            = 44, // 2 chars per register, first in high byte, length is Count registers
+		StringByteSwapped = 45, // 2 chars per register, first in low byte, length is Count registers
 	};
 	Q_ENUM(ValueType)
 	typedef QUaModbusValue::ValueType QModbusValueType;
@@ -83,11 +115,19 @@ public:
 	QUaProperty * type();
 	QUaProperty * registersUsed();
 	QUaProperty * addressOffset();
+	QUaProperty * count();
+	QUaProperty * optimisticWrite();
+	QUaProperty * absoluteDeadband();
+	QUaProperty * percentDeadband();
+	QUaProperty * rangeLow();
+	QUaProperty * rangeHigh();
 
 	// UA variables
 
 	QUaBaseDataVariable * value();
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	QUaBaseDataVariable * lastError();
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 
 	// UA methods
 
@@ -102,9 +142,34 @@ public:
 	int  getAddressOffset() const;
 	void setAddressOffset(const int &addressOffset);
 
+	// number of consecutive elements of type, value is an array if greater than one
+	quint16 getCount() const;
+	void    setCount(const quint16 &count);
+
 	QVariant getValue() const;
 	void     setValue(const QVariant &value);
 
+	// publish written value at once as uncertain, confirm on reply or read, roll back on failure
+	bool getOptimisticWrite() const;
+	void setOptimisticWrite(const bool &optimisticWrite);
+
+	// read values within deadband of last published value are not published (0 disables)
+	double getAbsoluteDeadband() const;
+	void   setAbsoluteDeadband(const double &absoluteDeadband);
+
+	// percent of [RangeLow, RangeHigh], only used if range is valid
+	double getPercentDeadband() const;
+	void   setPercentDeadband(const double &percentDeadband);
+
+	double getRangeLow() const;
+	void   setRangeLow(const double &rangeLow);
+
+	double getRangeHigh() const;
+	void   setRangeHigh(const double &rangeHigh);
+
+	// number of read values not published because within deadband
+	quint64 getDeadbandSuppressed() const;
+
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	enum CyclicWriteMode
 	{
@@ -139,61 +204,118 @@ public:
 
 	QUaModbusClient    * client() const;
 
+	// approximate memory owned by this value (call in ua server thread)
+	QUaModbusMemoryUsage memoryUsage() const;
+
 	static int              typeBlockSize(const QModbusValueType &type);
 	static QMetaType::Type  typeToMeta   (const QModbusValueType &type);
-	static QVariant         blockToValue (const QVector<quint16> &block, const QModbusValueType &type);
-	static QVector<quint16> valueToBlock (const QVariant         &value, const QModbusValueType &type);
+	static bool             typeIsString (const QModbusValueType &type);
+	static QUaStatus        errorToStatus(const QModbusError     &error);
+	// ok is false if registers do not hold a valid value (e.g. bad BCD digit)
+	static QVariant         blockToValue (const QVector<quint16> &block, const QModbusValueType &type, const quint16 &count = 1, bool * ok = nullptr);
+	// ok is false if value cannot be represented (e.g. too many BCD digits)
+	static QVector<quint16> valueToBlock (const QVariant         &value, const QModbusValueType &type, const quint16 &count = 1, bool * ok = nullptr);
 
 signals:
 	// C++ API
 	void typeChanged         (const QModbusValueType &type         );
 	void registersUsedChanged(const quint16          &registersUsed);
 	void addressOffsetChanged(const int              &addressOffset);
+	void countChanged        (const quint16          &count        );
 	void valueChanged        (const QVariant         &value        );
 	void lastErrorChanged    (const QModbusError     &error        );
+	void optimisticWriteChanged(const bool           &optimisticWrite);
+	void absoluteDeadbandChanged(const double        &absoluteDeadband);
+	void percentDeadbandChanged (const double        &percentDeadband);
+	void rangeLowChanged        (const double        &rangeLow);
+	void rangeHighChanged       (const double        &rangeHigh);
 	// (internal) to safely update error in ua server thread
 	void updateLastError(const QModbusError &error);
+	// (internal) to safely confirm or roll back optimistic write in ua server thread
+	void updateWriteResult(const quint32 &writeId, const QModbusError &error);
 	void aboutToDestroy();
 
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	void cyclicWritePeriodChanged(const quint32& cyclicWritePeriod);
 	void cyclicWriteModeChanged  (const QModbusCyclicWriteMode& cyclicWriteMode);
-	// (internal) used by cycle in thread
-	void cyclicWrite();
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
 private slots:
 	void on_typeChanged             (const QVariant     &value, const bool& networkChange);
 	void on_addressOffsetChanged    (const QVariant     &value, const bool& networkChange);
+	void on_countChanged            (const QVariant     &value, const bool& networkChange);
 	void on_valueChanged            (const QVariant     &value, const bool& networkChange);
+	void on_optimisticWriteChanged  (const QVariant     &value, const bool& networkChange);
+	void on_absoluteDeadbandChanged (const QVariant     &value, const bool& networkChange);
+	void on_percentDeadbandChanged  (const QVariant     &value, const bool& networkChange);
+	void on_rangeLowChanged         (const QVariant     &value, const bool& networkChange);
+	void on_rangeHighChanged        (const QVariant     &value, const bool& networkChange);
 	void on_updateLastError         (const QModbusError &error);
+	void on_updateWriteResult       (const quint32 &writeId, const QModbusError &error);
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	void on_cyclicWritePeriodChanged(const QVariant     &value, const bool& networkChange);
 	void on_cyclicWriteModeChanged  (const QVariant     &value, const bool& networkChange);
-	// cyclic write with last value
-	void on_cyclicWrite();
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 
 private:
-	int m_loopId;
 	bool m_wellConfigured;
 	QModbusValueType m_typeCache;
 	int m_addressOffsetCache;
+	quint16 m_countCache;
 	QModbusError m_lastErrorCache;
+	// optimistic write (only access in ua server thread)
+	quint32  m_writeId;
+	bool     m_writePending;
+	QVariant m_pendingValue;
+	QVariant m_confirmedValue;
+	// deadband (only access in ua server thread)
+	double   m_absoluteDeadbandCache;
+	double   m_percentDeadbandCache;
+	double   m_rangeLowCache;
+	double   m_rangeHighCache;
+	double   m_deadband;
+	QVariant m_deadbandReference;
+	quint64  m_deadbandSuppressed;
 	QUaProperty* m_type;
 	QUaProperty* m_registersUsed;
 	QUaProperty* m_addressOffset;
+	QUaProperty* m_count;
+	QUaProperty* m_optimisticWrite;
+	QUaProperty* m_absoluteDeadband;
+	QUaProperty* m_percentDeadband;
+	QUaProperty* m_rangeLow;
+	QUaProperty* m_rangeHigh;
 #ifndef QUAMODBUS_NOCYCLIC_WRITE
 	QUaProperty* m_cyclicWritePeriod;
 	QUaProperty* m_cyclicWriteMode;
 #endif // !QUAMODBUS_NOCYCLIC_WRITE
 	QUaBaseDataVariable* m_value;
+#ifndef QUAMODBUS_NOVALUE_LASTERROR
 	QUaBaseDataVariable* m_lastError;
+#endif // !QUAMODBUS_NOVALUE_LASTERROR
 
-	void setValue(const QVector<quint16> &block, const QModbusError &blockError, const bool forceIfSame = false);
+	void setValue(const QVector<quint16> &block, const QModbusError &blockError, const bool forceIfSame = false, const QDateTime &sourceTimestamp = QDateTime());
 
 	void updateWellConfigured(const QModbusValueType& type, const int& addressOffset);
 
+	// element type, value rank and dimensions of value node from type and count
+	void updateValueDataType();
+
+	// uncertain while optimistic write pending, else quality from last error (if no LastError node)
+	void updateStatusCode();
+
+	// registers used by all elements
+	int blockSize() const;
+
+	void updateDeadband();
+	bool isWithinDeadband(const QVariant &value) const;
+
+#ifndef QUAMODBUS_NOCYCLIC_WRITE
+	// next value to write according to cyclic write mode (written by block)
+	QVariant cyclicWriteValue() const;
+	static QVariant cyclicWriteValue(const QVariant &current, const QModbusCyclicWriteMode &mode);
+#endif // !QUAMODBUS_NOCYCLIC_WRITE
+
 	// XML import / export
 	QDomElement toDomElement  (QDomDocument & domDoc) const;
 	void        fromDomElement(QDomElement  & domElem, QQueue<QUaLog>& errorLogs);
@@ -424,8 +424,7 @@ void QUaModbusClientTree::setClientList(QUaModbusClientList * listClients)
 			if (value)
 			{
 				auto enumError = QMetaEnum::fromType<QModbusError>();
-				auto error     = value->lastError();
-				auto modError  = error->value().value<QModbusError>();
+				auto modError  = value->getLastError();
 				auto strError  = QString(enumError.valueToKey(modError));
 				return strError;
 			}
@@ -995,6 +994,93 @@ void QUaModbusClientTree::setupExportButton()
 	[this](){
 		this->saveContentsCsvToFile(m_listClients->csvValues());
 	});
+	exportMenu->addSeparator();
+	// bus load analysis
+	exportMenu->addAction(tr("Bus Load"), this,
+	[this](){
+		this->saveContentsCsvToFile(m_listClients->csvBusLoad());
+	});
+	exportMenu->addAction(tr("Check Bus Load"), this,
+	[this](){
+		auto logs = m_listClients->checkBusLoad();
+		this->displayLogs(logs, tr("Bus Load Check"));
+	});
+	exportMenu->addSeparator();
+	// partitioning advisor
+	auto changeAction = exportMenu->addAction(tr("Collect Change Statistics"));
+	changeAction->setCheckable(true);
+	QObject::connect(exportMenu, &QMenu::aboutToShow, changeAction,
+	[this, changeAction](){
+		QSignalBlocker blocker(changeAction);
+		changeAction->setChecked(m_listClients && m_listClients->getChangeStatistics());
+	});
+	QObject::connect(changeAction, &QAction::toggled, this,
+	[this](bool checked){
+		m_listClients->setChangeStatistics(checked);
+	});
+	exportMenu->addAction(tr("Partition Blocks"), this,
+	[this](){
+		this->saveContentsCsvToFile(m_listClients->csvPartitionBlocks());
+	});
+	exportMenu->addAction(tr("Partition Values"), this,
+	[this](){
+		this->saveContentsCsvToFile(m_listClients->csvPartitionValues());
+	});
+	exportMenu->addSeparator();
+	// lock profiling
+	auto lockAction = exportMenu->addAction(tr("Lock Profiling"));
+	lockAction->setCheckable(true);
+	QObject::connect(exportMenu, &QMenu::aboutToShow, lockAction,
+	[this, lockAction](){
+		QSignalBlocker blocker(lockAction);
+		lockAction->setChecked(m_listClients && m_listClients->getLockProfiling());
+	});
+	QObject::connect(lockAction, &QAction::toggled, this,
+	[this](bool checked){
+		m_listClients->setLockProfiling(checked);
+	});
+	exportMenu->addAction(tr("Lock Profile"), this,
+	[this](){
+		this->saveContentsCsvToFile(m_listClients->csvLockProfile());
+	});
+	exportMenu->addSeparator();
+	// request tracing
+	auto tracingAction = exportMenu->addAction(tr("Request Tracing"));
+	tracingAction->setCheckable(true);
+	QObject::connect(exportMenu, &QMenu::aboutToShow, tracingAction,
+	[this, tracingAction](){
+		QSignalBlocker blocker(tracingAction);
+		tracingAction->setChecked(m_listClients && m_listClients->getTracing());
+	});
+	QObject::connect(tracingAction, &QAction::toggled, this,
+	[this](bool checked){
+		m_listClients->setTracing(checked);
+	});
+	exportMenu->addAction(tr("Request Trace"), this,
+	[this](){
+		QString strSaveFile = QFileDialog::getSaveFileName(this, tr("Export Request Trace"),
+			m_strLastPathUsed.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::DesktopLocation) : m_strLastPathUsed,
+			tr("Chrome Trace (*.json)")
+#if defined(Q_OS_LINUX) && QT_VERSION_MAJOR == 5 && QT_VERSION_MINOR == 12
+			, nullptr, QFileDialog::DontUseNativeDialog
+#endif
+			);
+		// ignore if empty
+		if (strSaveFile.isEmpty())
+		{
+			return;
+		}
+		if (!m_listClients->dumpTrace(strSaveFile))
+		{
+			QMessageBox::critical(
+				this,
+				tr("Error"),
+				tr("Error opening file %1 for write operations.").arg(strSaveFile)
+			);
+			return;
+		}
+		m_strLastPathUsed = QFileInfo(strSaveFile).absoluteFilePath();
+	});
 	// set menu
 	ui->toolButtonExport->setMenu(exportMenu);
 	// default action
@@ -1187,6 +1273,11 @@ void QUaModbusClientTree::displayCsvLoadResult(QQueue<QUaLog>& errorLogs)
 	{
 		return;
 	}
+	this->displayLogs(errorLogs, tr("CSV Import Issues"));
+}
+
+void QUaModbusClientTree::displayLogs(QQueue<QUaLog>& logs, const QString & strTitle)
+{
 	// setup log widget
 	auto logWidget = new QUaLogWidget;
 	logWidget->setFilterVisible(false);
@@ -1197,13 +1288,13 @@ void QUaModbusClientTree::displayCsvLoadResult(QQueue<QUaLog>& errorLogs)
 	logWidget->setLevelColor(QUaLogLevel::Error, QBrush(m_colorLogError));
 	logWidget->setLevelColor(QUaLogLevel::Warning, QBrush(m_colorLogWarn));
 	logWidget->setLevelColor(QUaLogLevel::Info, QBrush(m_colorLogInfo));
-	while (errorLogs.count() > 0)
+	while (logs.count() > 0)
 	{
-		logWidget->addLog(errorLogs.dequeue());
+		logWidget->addLog(logs.dequeue());
 	}
 	// NOTE : dialog takes ownershit
 	QUaCommonDialog dialog(this);
-	dialog.setWindowTitle(tr("CSV Import Issues"));
+	dialog.setWindowTitle(strTitle);
 	dialog.setWidget(logWidget);
 	dialog.clearButtons();
 	dialog.addButton(tr("Close"), QDialogButtonBox::ButtonRole::AcceptRole);
@@ -214,6 +214,7 @@ private:
 	void    saveContentsCsvToFile(const QString &strContents, const QString &strFileName = "");
 	QString loadContentsCsvFromFile();
 	void    displayCsvLoadResult(QQueue<QUaLog>& errorLogs);
+	void    displayLogs(QQueue<QUaLog>& logs, const QString &strTitle);
 	void    exportAllCsv();
 
 	bool isFilterVisible() const;
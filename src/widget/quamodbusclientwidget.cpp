@@ -2,6 +2,9 @@
 #include "ui_quamodbusclientwidget.h"
 
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QFile>
+#include <QStandardPaths>
 
 #include <QUaModbusTcpClient>
 #include <QUaModbusRtuSerialClient>
@@ -126,12 +129,14 @@ void QUaModbusClientWidget::bindClient(QUaModbusClient * client)
 		ui->pushButtonClear   ->setEnabled(canWrite);
 		ui->pushButtonPerms   ->setVisible(canWrite); // NOTE : only hide this one
 		ui->pushButtonConnect ->setEnabled(canWrite); // NOTE : dont know if permission to connect/disconnect belongs here
+		ui->pushButtonLogRequests ->setEnabled(canWrite);
 		// tooltips
 		ui->pushButtonApply   ->setToolTip(strToolTip);
 		ui->pushButtonDelete  ->setToolTip(strToolTip);
 		ui->pushButtonAddBlock->setToolTip(strToolTip);
 		ui->pushButtonClear   ->setToolTip(strToolTip);
 		ui->pushButtonConnect ->setToolTip(strToolTip);
+		ui->pushButtonLogRequests ->setToolTip(strToolTip);
 	});
 #endif // QUA_ACCESS_CONTROL
 	// bind buttons
@@ -216,6 +221,53 @@ void QUaModbusClientWidget::bindClient(QUaModbusClient * client)
 		// clear
 		client->dataBlocks()->clear();
 	});
+	// request log
+	ui->pushButtonLogRequests->setChecked(client->getLogRequests());
+	m_connections <<
+	QObject::connect(ui->pushButtonLogRequests, &QPushButton::toggled, client,
+	[client](bool checked) {
+		Q_CHECK_PTR(client);
+		if (client->getLogRequests() == checked)
+		{
+			return;
+		}
+		client->setLogRequests(checked);
+	});
+	m_connections <<
+	QObject::connect(client, &QUaModbusClient::logRequestsChanged, ui->pushButtonLogRequests,
+	[this](const bool &logRequests) {
+		ui->pushButtonLogRequests->setChecked(logRequests);
+	});
+	m_connections <<
+	QObject::connect(ui->pushButtonExportRequestLog, &QPushButton::clicked, client,
+	[this, client]() {
+		Q_CHECK_PTR(client);
+		QString strSaveFile = QFileDialog::getSaveFileName(this, tr("Export Request Log"),
+			QStandardPaths::writableLocation(QStandardPaths::DesktopLocation) + 
+			QString("/%1.pcap").arg(client->browseName().name()),
+			tr("Packet Capture (*.pcap)")
+#if defined(Q_OS_LINUX) && QT_VERSION_MAJOR == 5 && QT_VERSION_MINOR == 12
+			, nullptr, QFileDialog::DontUseNativeDialog
+#endif
+			);
+		// ignore if empty
+		if (strSaveFile.isEmpty())
+		{
+			return;
+		}
+		QFile file(strSaveFile);
+		if (!file.open(QIODevice::WriteOnly | QFile::Truncate))
+		{
+			QMessageBox::critical(
+				this,
+				tr("Error"),
+				tr("Error opening file %1 for write operations.").arg(strSaveFile)
+			);
+			return;
+		}
+		file.write(client->exportRequestLog());
+		file.close();
+	});
 	// NOTE : apply button bound in bindClientWidgetEdit
 }
 
@@ -415,6 +467,25 @@ void QUaModbusClientWidget::bindClientWidgetStatus(QUaModbusClient * client)
 	[this](const QModbusState & state) {
 		ui->widgetClientStatus->setState(state);
 	});
+	// statistics
+	ui->widgetClientStatus->setStatistics(
+		client->getRequestRate(),
+		client->getByteRate(),
+		client->getBusUsage(),
+		client->getQueueDepth(),
+		client->getCpuUsage()
+	);
+	m_connections <<
+	QObject::connect(client, &QUaModbusClient::statisticsChanged, ui->widgetClientStatus,
+	[this, client]() {
+		ui->widgetClientStatus->setStatistics(
+			client->getRequestRate(),
+			client->getByteRate(),
+			client->getBusUsage(),
+			client->getQueueDepth(),
+			client->getCpuUsage()
+		);
+	});
 }
 
 void QUaModbusClientWidget::showNewBlockDialog(QUaModbusClient * client, QUaModbusClientDialog &dialog)
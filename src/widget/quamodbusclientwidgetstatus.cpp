@@ -26,3 +26,17 @@ void QUaModbusClientWidgetStatus::setState(const QModbusState & state)
 	auto strState  = QString(metaState.valueToKey(state));
 	ui->lineEditState->setText(strState);
 }
+
+void QUaModbusClientWidgetStatus::setStatistics(const double  &requestRate,
+	                                            const double  &byteRate,
+	                                            const double  &busUsage,
+	                                            const quint32 &queueDepth,
+	                                            const double  &cpuUsage)
+{
+	ui->lineEditTraffic->setText(tr("%1 req/s, %2 B/s")
+		.arg(requestRate, 0, 'f', 1)
+		.arg(byteRate   , 0, 'f', 0));
+	ui->lineEditBusUsage->setText(QString("%1 %").arg(busUsage, 0, 'f', 1));
+	ui->lineEditQueueDepth->setText(QString::number(queueDepth));
+	ui->lineEditCpuUsage->setText(QString("%1 %").arg(cpuUsage, 0, 'f', 1));
+}
@@ -20,6 +20,12 @@ public:
 
 	void setState(const QModbusState &state);
 
+	void setStatistics(const double  &requestRate,
+		               const double  &byteRate,
+		               const double  &busUsage,
+		               const quint32 &queueDepth,
+		               const double  &cpuUsage);
+
 private:
     Ui::QUaModbusClientWidgetStatus *ui;
 };
@@ -231,11 +231,17 @@ void QUaModbusValueWidget::bindValueWidgetStatus(QUaModbusValue * value)
 	// unfreeze status widget
 	ui->widgetValueStatus->setIsFrozen(false);
 	// type
-	ui->widgetValueStatus->setType(value->getType());
+	ui->widgetValueStatus->setType(value->getType(), value->getCount());
 	m_connections <<
 	QObject::connect(value, &QUaModbusValue::typeChanged, ui->widgetValueStatus,
 	[this, value](const QModbusValueType & type) {
-		ui->widgetValueStatus->setType(type);
+		ui->widgetValueStatus->setType(type, value->getCount());
+		ui->widgetValueStatus->setValue(value->getValue());
+	});
+	m_connections <<
+	QObject::connect(value, &QUaModbusValue::countChanged, ui->widgetValueStatus,
+	[this, value](const quint16 & count) {
+		ui->widgetValueStatus->setType(value->getType(), count);
 		ui->widgetValueStatus->setValue(value->getValue());
 	});
 	// status
@@ -255,7 +261,7 @@ void QUaModbusValueWidget::bindValueWidgetStatus(QUaModbusValue * value)
 	// data & value
 	auto data   = value->block()->getData();
 	auto offset = value->getAddressOffset();
-	auto size   = QUaModbusValue::typeBlockSize(value->getType());
+	auto size   = value->getRegistersUsed();
 	ui->widgetValueStatus->setData(data.mid(offset, size));
 	ui->widgetValueStatus->setValue(value->getValue());
 	m_connections <<
@@ -263,7 +269,7 @@ void QUaModbusValueWidget::bindValueWidgetStatus(QUaModbusValue * value)
 	[this, value](const QVariant & varVal) {
 		auto block  = value->block()->getData();
 		auto offset = value->getAddressOffset();
-		auto size   = QUaModbusValue::typeBlockSize(value->getType());
+		auto size   = value->getRegistersUsed();
 		ui->widgetValueStatus->setData(block.mid(offset, size));
 		ui->widgetValueStatus->setValue(varVal);
 	});
@@ -36,6 +36,8 @@ QUaModbusValueWidgetStatus::QUaModbusValueWidgetStatus(QWidget *parent) :
 	ui->spinBoxValue->setVisible(false);
 	ui->doubleSpinBoxValue->setEnabled(false);
 	ui->doubleSpinBoxValue->setVisible(false);
+	ui->lineEditValue->setEnabled(false);
+	ui->lineEditValue->setVisible(false);
 	// block wheel on widgets
 	auto spinBoxValueEventHandler = new QUaWidgetEventFilter(ui->spinBoxValue);
 	spinBoxValueEventHandler->installEventCallback(QEvent::Wheel, blockWheel);
@@ -60,7 +62,7 @@ void QUaModbusValueWidgetStatus::setIsFrozen(const bool & frozen)
 	ui->checkBoxFreeze->setChecked(frozen);
 }
 
-void QUaModbusValueWidgetStatus::setType(const QModbusValueType & type)
+void QUaModbusValueWidgetStatus::setType(const QModbusValueType & type, const quint16 & count/* = 1*/)
 {
 	// hide all
 	ui->checkBoxValue->setEnabled(false);
@@ -69,6 +71,17 @@ void QUaModbusValueWidgetStatus::setType(const QModbusValueType & type)
 	ui->spinBoxValue->setVisible(false);
 	ui->doubleSpinBoxValue->setEnabled(false);
 	ui->doubleSpinBoxValue->setVisible(false);
+	ui->lineEditValue->setEnabled(false);
+	ui->lineEditValue->setVisible(false);
+	// force display update on next value
+	m_valueOld = QVariant();
+	// arrays have no editor
+	if (count > 1 && !QUaModbusValue::typeIsString(type))
+	{
+		ui->lineEditValue->setEnabled(true);
+		ui->lineEditValue->setVisible(true);
+		return;
+	}
 	// show specific
 	switch (type)
 	{
@@ -96,23 +109,57 @@ void QUaModbusValueWidgetStatus::setType(const QModbusValueType & type)
 	case QModbusValueType::Decimal:
 	case QModbusValueType::Int:
 	case QModbusValueType::IntSwapped:
-	case QModbusValueType::Int64:
-	case QModbusValueType::Int64Swapped:
+	case QModbusValueType::Int16:
+	case QModbusValueType::IntBADC:
+	case QModbusValueType::IntDCBA:
+	case QModbusValueType::Bcd16:
+	case QModbusValueType::Bcd32:
 	case QModbusValueType::Invalid: // NOTE : invalid
 		{
+			this->setSpinBoxRange(type);
 			ui->spinBoxValue->setEnabled(true);
 			ui->spinBoxValue->setVisible(true);
 			break;
 		}
+	case QModbusValueType::Int64:
+	case QModbusValueType::Int64Swapped:
+	case QModbusValueType::UInt:
+	case QModbusValueType::UIntSwapped:
+	case QModbusValueType::UInt64:
+	case QModbusValueType::UInt64Swapped:
+	case QModbusValueType::UIntBADC:
+	case QModbusValueType::UIntDCBA:
+	case QModbusValueType::Int64BADC:
+	case QModbusValueType::Int64DCBA:
+	case QModbusValueType::UInt64BADC:
+	case QModbusValueType::UInt64DCBA:
+		{
+			// NOTE : no editor for values beyond int range
+			ui->lineEditValue->setEnabled(true);
+			ui->lineEditValue->setVisible(true);
+			break;
+		}
 	case QModbusValueType::Float:
 	case QModbusValueType::FloatSwapped:
 	case QModbusValueType::Float64:
 	case QModbusValueType::Float64Swapped:
+	case QModbusValueType::FloatBADC:
+	case QModbusValueType::FloatDCBA:
+	case QModbusValueType::Float64BADC:
+	case QModbusValueType::Float64DCBA:
 		{
 			ui->doubleSpinBoxValue->setEnabled(true);
 			ui->doubleSpinBoxValue->setVisible(true);
 			break;
 		}
+	case QModbusValueType::String:
+	case QModbusValueType::StringByteSwapped:
+		{
+			// NOTE : no editor for strings
+			ui->lineEditValue->setEnabled(true);
+			ui->lineEditValue->setVisible(true);
+			break;
+		}
 	default:
 		{
 			Q_ASSERT(false);
@@ -170,9 +217,23 @@ void QUaModbusValueWidgetStatus::setValue(const QVariant & value)
 		auto newVal = value.toDouble();
 		ui->doubleSpinBoxValue->setValue(newVal);
 	}
-	else
+	else if (ui->lineEditValue->isEnabled())
 	{
-		Q_ASSERT(false);
+		QString strValue;
+		if (value.type() == QVariant::List)
+		{
+			QStringList listValues;
+			for (auto &element : value.toList())
+			{
+				listValues << element.toString();
+			}
+			strValue = "[" + listValues.join(", ") + "]";
+		}
+		else
+		{
+			strValue = value.toString();
+		}
+		ui->lineEditValue->setText(strValue);
 	}
 	// update internal values
 	m_valueOld  = value;
@@ -186,6 +247,30 @@ void QUaModbusValueWidgetStatus::setWritable(const bool & writable)
 	ui->doubleSpinBoxValue->setReadOnly(!writable);
 }
 
+void QUaModbusValueWidgetStatus::setSpinBoxRange(const QModbusValueType & type)
+{
+	// NOTE : block signals, clamping the old value is not a user edit
+	QSignalBlocker blocker(ui->spinBoxValue);
+	switch (type)
+	{
+	case QModbusValueType::Decimal:
+		ui->spinBoxValue->setRange(0, std::numeric_limits<quint16>::max());
+		break;
+	case QModbusValueType::Int16:
+		ui->spinBoxValue->setRange(std::numeric_limits<qint16>::min(), std::numeric_limits<qint16>::max());
+		break;
+	case QModbusValueType::Bcd16:
+		ui->spinBoxValue->setRange(0, 9999);
+		break;
+	case QModbusValueType::Bcd32:
+		ui->spinBoxValue->setRange(0, 99999999);
+		break;
+	default:
+		ui->spinBoxValue->setRange(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+		break;
+	}
+}
+
 void QUaModbusValueWidgetStatus::on_checkBoxValue_stateChanged(int arg1)
 {
 	Q_UNUSED(arg1);
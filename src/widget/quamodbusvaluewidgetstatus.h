@@ -20,7 +20,8 @@ public:
 	bool isFrozen() const;
 	void setIsFrozen(const bool &frozen);
 
-	void setType(const QModbusValueType &type);
+	// arrays and values beyond the int range of the spinbox are shown read only
+	void setType(const QModbusValueType &type, const quint16 &count = 1);
 
 	void setStatus(const QModbusError &status);
 
@@ -45,6 +46,7 @@ private slots:
 
 private:
     Ui::QUaModbusValueWidgetStatus *ui;
+	void setSpinBoxRange(const QModbusValueType &type);
 	QVariant m_valueOld;
 	QVariant m_valueCurr;
 };
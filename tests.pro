@@ -6,14 +6,17 @@ amalgamation \
 qadvanceddocking \
 01_console \
 02_widget \
-03_access_control
+03_access_control \
+04_codec_bench
 # directories
 amalgamation.subdir      = $$PWD/libs/QUaServer.git/src/amalgamation
 qadvanceddocking.subdir  = $$PWD/libs/QAdvancedDocking.git/src
 01_console.subdir        = $$PWD/tests/01_console
 02_widget.subdir         = $$PWD/tests/02_widget
 03_access_control.subdir = $$PWD/tests/03_access_control
+04_codec_bench.subdir    = $$PWD/tests/04_codec_bench
 # dependencies
 01_console.depends         = amalgamation
 02_widget.depends          = amalgamation
 03_access_control.depends  = amalgamation qadvanceddocking
+04_codec_bench.depends     = amalgamation
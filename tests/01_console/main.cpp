@@ -1,5 +1,6 @@
 #include <QCoreApplication>
 #include <QDebug>
+#include <QTimer>
 
 #include <QUaServer>
 
@@ -14,7 +15,14 @@ int main(int argc, char *argv[])
 	QUaFolderObject * objsFolder = server.objectsFolder();
 
 	// add list entry point to object's folder
-	objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+	auto clientList = objsFolder->addChild<QUaModbusClientList>("ModbusClients");
+
+	// print approximate memory usage periodically, for capacity planning
+	QTimer memoryTimer;
+	QObject::connect(&memoryTimer, &QTimer::timeout, clientList, [clientList]() {
+		qInfo().noquote() << clientList->memorySummary();
+	});
+	memoryTimer.start(60000);
 
 	server.start();
 
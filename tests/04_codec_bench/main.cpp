@@ -0,0 +1,472 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QMetaEnum>
+
+#include <QUaModbusValue>
+
+#include <cstring>
+
+// compares value codec table against the switch based codec it replaced,
+// first checks both produce the same results and that types added with the
+// table decode known register patterns, then times them
+
+namespace legacy
+{
+
+int typeBlockSize(const QModbusValueType & type)
+{
+	switch (type)
+	{
+		case QModbusValueType::Decimal:
+			return 1;
+		case QModbusValueType::Int:
+		case QModbusValueType::IntSwapped:
+		case QModbusValueType::Float:
+		case QModbusValueType::FloatSwapped:
+			return 2;
+		case QModbusValueType::Int64:
+		case QModbusValueType::Int64Swapped:
+		case QModbusValueType::Float64:
+		case QModbusValueType::Float64Swapped:
+			return 4;
+		default:
+			break;
+	}
+	// binary
+	return type >= QModbusValueType::Binary0 && type <= QModbusValueType::Binary15 ? 1 : 0;
+}
+
+QVariant blockToValue(const QVector<quint16>& block, const QModbusValueType & type, const quint16 &count = 1)
+{
+	// array, decode each element
+	if (count > 1)
+	{
+		int size = legacy::typeBlockSize(type);
+		QVariantList listRes;
+		listRes.reserve(count);
+		for (int i = 0; i < count && (i + 1) * size <= block.count(); i++)
+		{
+			listRes << legacy::blockToValue(block.mid(i * size, size), type);
+		}
+		return listRes;
+	}
+	QVariant retVar;
+	switch (type)
+	{
+		case QModbusValueType::Binary0:
+		{
+			retVar = QVariant::fromValue(block.first() > 0);
+			break;
+		}
+		case QModbusValueType::Decimal:
+		{
+			retVar = QVariant::fromValue(block.first());
+			break;
+		}
+		case QModbusValueType::Int:
+		{
+			int iRes = (int)(((quint32)block.at(1) << 16) | ((quint32)block.at(0)));
+			retVar = QVariant::fromValue(iRes);
+			break;
+		}
+		case QModbusValueType::IntSwapped:
+		{
+			int iRes = (int)(((quint32)block.at(0) << 16) | ((quint32)block.at(1)));
+			retVar = QVariant::fromValue(iRes);
+			break;
+		}
+		case QModbusValueType::Float:
+		{
+			float fRes = 0;
+			quint32 iTmp = (((quint32)block.at(1) << 16) | ((quint32)block.at(0)));
+			memcpy(&fRes, &iTmp, sizeof(quint32));
+			retVar = QVariant::fromValue(fRes);
+			break;
+		}
+		case QModbusValueType::FloatSwapped:
+		{
+			float fRes = 0;
+			quint32 iTmp = (((quint32)block.at(0) << 16) | ((quint32)block.at(1)));
+			memcpy(&fRes, &iTmp, sizeof(quint32));
+			retVar = QVariant::fromValue(fRes);
+			break;
+		}
+		case QModbusValueType::Int64:
+		{
+			qint64 iRes = 0;
+			quint64 iTmp = (((quint64)block.at(3) << 48) |
+			                ((quint64)block.at(2) << 32) |
+			                ((quint64)block.at(1) << 16) |
+			                ((quint64)block.at(0)));
+			memcpy(&iRes, &iTmp, sizeof(quint64));
+			retVar = QVariant::fromValue(iRes);
+			break;
+		}
+		case QModbusValueType::Int64Swapped:
+		{
+			qint64 iRes = 0;
+			quint64 iTmp = (((quint64)block.at(0) << 48) |
+			                ((quint64)block.at(1) << 32) |
+			                ((quint64)block.at(2) << 16) |
+			                ((quint64)block.at(3)));
+			memcpy(&iRes, &iTmp, sizeof(quint64));
+			retVar = QVariant::fromValue(iRes);
+			break;
+		}
+		case QModbusValueType::Float64:
+		{
+			double dRes = 0;
+			quint64 iTmp = (((quint64)block.at(3) << 48) |
+			                ((quint64)block.at(2) << 32) |
+			                ((quint64)block.at(1) << 16) |
+			                ((quint64)block.at(0)));
+			memcpy(&dRes, &iTmp, sizeof(quint64));
+			retVar = QVariant::fromValue(dRes);
+			break;
+		}
+		case QModbusValueType::Float64Swapped:
+		{
+			double dRes = 0;
+			quint64 iTmp = (((quint64)block.at(0) << 48) |
+			                ((quint64)block.at(1) << 32) |
+			                ((quint64)block.at(2) << 16) |
+			                ((quint64)block.at(3)));
+			memcpy(&dRes, &iTmp, sizeof(quint64));
+			retVar = QVariant::fromValue(dRes);
+			break;
+		}
+		default:
+		{
+			// Binary1 to Binary15
+			if (type > QModbusValueType::Binary0 && type <= QModbusValueType::Binary15)
+			{
+				retVar = QVariant::fromValue(((block.first() >> type) & 0x0001) == 1);
+			}
+			break;
+		}
+	}
+	return retVar;
+}
+
+QVector<quint16> valueToBlock(const QVariant & value, const QModbusValueType & type, const quint16 &count = 1)
+{
+	// array, encode each element
+	if (count > 1)
+	{
+		QVector<quint16> blockRes;
+		auto list = value.toList();
+		for (int i = 0; i < count && i < list.count(); i++)
+		{
+			blockRes << legacy::valueToBlock(list.at(i), type);
+		}
+		return blockRes;
+	}
+	QVector<quint16> block;
+	switch (type)
+	{
+		case QModbusValueType::Binary0:
+		{
+			block.resize(1);
+			block[0] = value.toBool() ? 1 : 0;
+			break;
+		}
+		case QModbusValueType::Decimal:
+		{
+			block.resize(1);
+			block[0] = (quint16)value.toUInt();
+			break;
+		}
+		case QModbusValueType::Int:
+		case QModbusValueType::IntSwapped:
+		{
+			block.resize(2);
+			int iValue = value.toInt();
+			bool swapped = type == QModbusValueType::IntSwapped;
+			block[swapped ? 1 : 0] = (quint16)(iValue & 0x0000FFFFuL);
+			block[swapped ? 0 : 1] = (quint16)(iValue >> 16);
+			break;
+		}
+		case QModbusValueType::Float:
+		case QModbusValueType::FloatSwapped:
+		{
+			block.resize(2);
+			float fValue = value.toFloat();
+			quint32 iTmp;
+			memcpy(&iTmp, &fValue, sizeof(quint32));
+			bool swapped = type == QModbusValueType::FloatSwapped;
+			block[swapped ? 1 : 0] = (quint16)(iTmp & 0x0000FFFFuL);
+			block[swapped ? 0 : 1] = (quint16)(iTmp >> 16);
+			break;
+		}
+		case QModbusValueType::Int64:
+		case QModbusValueType::Int64Swapped:
+		case QModbusValueType::Float64:
+		case QModbusValueType::Float64Swapped:
+		{
+			block.resize(4);
+			quint64 iTmp;
+			if (type == QModbusValueType::Int64 || type == QModbusValueType::Int64Swapped)
+			{
+				qint64 iValue = value.toLongLong();
+				memcpy(&iTmp, &iValue, sizeof(quint64));
+			}
+			else
+			{
+				double dValue = value.toDouble();
+				memcpy(&iTmp, &dValue, sizeof(quint64));
+			}
+			bool swapped = type == QModbusValueType::Int64Swapped || type == QModbusValueType::Float64Swapped;
+			for (int i = 0; i < 4; i++)
+			{
+				block[swapped ? 3 - i : i] = (quint16)(iTmp >> (16 * i));
+			}
+			break;
+		}
+		default:
+		{
+			// Binary1 to Binary15
+			if (type > QModbusValueType::Binary0 && type <= QModbusValueType::Binary15)
+			{
+				block.resize(1);
+				block[0] = value.toBool() ? (quint16)(0x0001 << type) : 0;
+			}
+			break;
+		}
+	}
+	return block;
+}
+
+} // namespace legacy
+
+// register pattern and the value it must decode to (and encode from)
+struct QUaCodecCase
+{
+	QModbusValueType type;
+	QVector<quint16> regs;
+	QVariant         value;
+	quint16          count;
+};
+
+// types added with the codec table, bytes chosen so any word or byte order mistake shows
+QList<QUaCodecCase> knownCases()
+{
+	return {
+		{ QModbusValueType::Int16            , { 0xFFFE }                        , QVariant::fromValue<qint16 >(-2)                     , 1 },
+		{ QModbusValueType::UInt             , { 0xBA98, 0xFEDC }                , QVariant::fromValue<quint32>(4275878552u)            , 1 },
+		{ QModbusValueType::UIntSwapped      , { 0xFEDC, 0xBA98 }                , QVariant::fromValue<quint32>(4275878552u)            , 1 },
+		{ QModbusValueType::UInt64           , { 0x3210, 0x7654, 0xBA98, 0xFEDC }, QVariant::fromValue<quint64>(18364758544493064720ull), 1 },
+		{ QModbusValueType::UInt64Swapped    , { 0xFEDC, 0xBA98, 0x7654, 0x3210 }, QVariant::fromValue<quint64>(18364758544493064720ull), 1 },
+		{ QModbusValueType::IntBADC          , { 0x3412, 0x7856 }                , QVariant::fromValue<qint32 >(305419896)              , 1 },
+		{ QModbusValueType::IntDCBA          , { 0x98BA, 0xDCFE }                , QVariant::fromValue<qint32 >(-19088744)              , 1 },
+		{ QModbusValueType::UIntBADC         , { 0xDCFE, 0x98BA }                , QVariant::fromValue<quint32>(4275878552u)            , 1 },
+		{ QModbusValueType::UIntDCBA         , { 0x98BA, 0xDCFE }                , QVariant::fromValue<quint32>(4275878552u)            , 1 },
+		{ QModbusValueType::FloatBADC        , { 0xF642, 0x79E9 }                , QVariant::fromValue<float  >(123.456f)               , 1 },
+		{ QModbusValueType::FloatDCBA        , { 0x79E9, 0xF642 }                , QVariant::fromValue<float  >(123.456f)               , 1 },
+		{ QModbusValueType::Int64BADC        , { 0x0201, 0x0403, 0x0605, 0x0807 }, QVariant::fromValue<qint64 >(72623859790382856ll)    , 1 },
+		{ QModbusValueType::Int64DCBA        , { 0x1032, 0x5476, 0x98BA, 0xDCFE }, QVariant::fromValue<qint64 >(-81985529216486896ll)   , 1 },
+		{ QModbusValueType::UInt64BADC       , { 0xDCFE, 0x98BA, 0x5476, 0x1032 }, QVariant::fromValue<quint64>(18364758544493064720ull), 1 },
+		{ QModbusValueType::UInt64DCBA       , { 0x1032, 0x5476, 0x98BA, 0xDCFE }, QVariant::fromValue<quint64>(18364758544493064720ull), 1 },
+		{ QModbusValueType::Float64BADC      , { 0x9340, 0x454A, 0x5C6D, 0xADFA }, QVariant::fromValue<double >(1234.5678)              , 1 },
+		{ QModbusValueType::Float64DCBA      , { 0xADFA, 0x5C6D, 0x454A, 0x9340 }, QVariant::fromValue<double >(1234.5678)              , 1 },
+		{ QModbusValueType::Bcd16            , { 0x1234 }                        , QVariant::fromValue<quint16>(1234)                   , 1 },
+		{ QModbusValueType::Bcd32            , { 0x1234, 0x5678 }                , QVariant::fromValue<quint32>(12345678u)              , 1 },
+		{ QModbusValueType::String           , { 0x4142, 0x4300 }                , QVariant::fromValue<QString>(QString("ABC"))         , 2 },
+		{ QModbusValueType::StringByteSwapped, { 0x4241, 0x0043 }                , QVariant::fromValue<QString>(QString("ABC"))         , 2 },
+	};
+}
+
+// returns number of failed checks
+int checkKnownCases()
+{
+	int failures = 0;
+	for (auto &known : knownCases())
+	{
+		bool ok = false;
+		auto value = QUaModbusValue::blockToValue(known.regs, known.type, known.count, &ok);
+		if (!ok || value != known.value)
+		{
+			qWarning() << "Decode mismatch" << known.type << known.regs << value << "expected" << known.value;
+			failures++;
+		}
+		ok = false;
+		auto regs = QUaModbusValue::valueToBlock(known.value, known.type, known.count, &ok);
+		if (!ok || regs != known.regs)
+		{
+			qWarning() << "Encode mismatch" << known.type << known.value << regs << "expected" << known.regs;
+			failures++;
+		}
+	}
+	// digits above 9 are not bcd
+	QList<QPair<QModbusValueType, QVector<quint16>>> badDigits = {
+		{ QModbusValueType::Bcd16, { 0x12A4 } },
+		{ QModbusValueType::Bcd32, { 0x1234, 0x567F } },
+	};
+	for (auto &bad : badDigits)
+	{
+		bool ok = true;
+		QUaModbusValue::blockToValue(bad.second, bad.first, 1, &ok);
+		if (ok)
+		{
+			qWarning() << "Decode accepted bad digit" << bad.first << bad.second;
+			failures++;
+		}
+	}
+	// negative or more digits than fit
+	QList<QPair<QModbusValueType, QVariant>> badValues = {
+		{ QModbusValueType::Bcd16, 10000 },
+		{ QModbusValueType::Bcd16, -1 },
+		{ QModbusValueType::Bcd32, 100000000 },
+	};
+	for (auto &bad : badValues)
+	{
+		bool ok = true;
+		QUaModbusValue::valueToBlock(bad.second, bad.first, 1, &ok);
+		if (ok)
+		{
+			qWarning() << "Encode accepted out of range" << bad.first << bad.second;
+			failures++;
+		}
+	}
+	return failures;
+}
+
+struct QUaCodecBenchResult
+{
+	double tableNs;
+	double legacyNs;
+};
+
+// nanoseconds per call of each codec, both run the same inputs
+template<typename TableFunc, typename LegacyFunc>
+QUaCodecBenchResult measure(const int &iterations, TableFunc tableFunc, LegacyFunc legacyFunc)
+{
+	QUaCodecBenchResult result;
+	QElapsedTimer timer;
+	// warm up
+	for (int i = 0; i < iterations / 10; i++)
+	{
+		tableFunc(i);
+		legacyFunc(i);
+	}
+	timer.start();
+	for (int i = 0; i < iterations; i++)
+	{
+		tableFunc(i);
+	}
+	result.tableNs = static_cast<double>(timer.nsecsElapsed()) / iterations;
+	timer.restart();
+	for (int i = 0; i < iterations; i++)
+	{
+		legacyFunc(i);
+	}
+	result.legacyNs = static_cast<double>(timer.nsecsElapsed()) / iterations;
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	const int iterations = argc > 1 ? QString(argv[1]).toInt() : 200000;
+	const int samples    = 256;
+	const quint16 arrayCount = 64;
+
+	// types supported before the codec table
+	QList<QModbusValueType> types;
+	for (int t = QModbusValueType::Binary0; t <= QModbusValueType::Float64Swapped; t++)
+	{
+		types << static_cast<QModbusValueType>(t);
+	}
+
+	// random registers, NOTE : fixed seed so runs are comparable
+	QRandomGenerator random(1234);
+	QVector<QVector<quint16>> blocks;
+	for (int i = 0; i < samples; i++)
+	{
+		QVector<quint16> block(arrayCount * 4);
+		for (auto &reg : block)
+		{
+			reg = static_cast<quint16>(random.bounded(0x10000));
+		}
+		blocks << block;
+	}
+
+	// check both codecs agree, NaN payloads compared by register round trip
+	int mismatches = 0;
+	for (auto type : types)
+	{
+		int size = QUaModbusValue::typeBlockSize(type);
+		if (size != legacy::typeBlockSize(type))
+		{
+			qWarning() << "Size mismatch" << type;
+			mismatches++;
+			continue;
+		}
+		for (auto &block : blocks)
+		{
+			auto part   = block.mid(0, size);
+			auto value  = QUaModbusValue::blockToValue(part, type);
+			auto valueLegacy = legacy::blockToValue(part, type);
+			if (QUaModbusValue::valueToBlock(value, type) != legacy::valueToBlock(valueLegacy, type))
+			{
+				qWarning() << "Codec mismatch" << type << part;
+				mismatches++;
+			}
+		}
+	}
+	mismatches += checkKnownCases();
+	if (mismatches > 0)
+	{
+		qWarning() << mismatches << "mismatches, benchmark aborted";
+		return 1;
+	}
+
+	// time decode and encode of scalars and arrays
+	qInfo().noquote() << QString("%1, %2, %3, %4, %5")
+		.arg("Type", -16).arg("Operation", -14).arg("Table ns", 10).arg("Switch ns", 10).arg("Ratio", 6);
+	double tableTotal  = 0.0;
+	double legacyTotal = 0.0;
+	auto report = [&tableTotal, &legacyTotal](const QModbusValueType &type, const QString &strOperation, const QUaCodecBenchResult &result) {
+		tableTotal  += result.tableNs;
+		legacyTotal += result.legacyNs;
+		auto strType = QString(QMetaEnum::fromType<QModbusValueType>().valueToKey(type));
+		qInfo().noquote() << QString("%1, %2, %3, %4, %5")
+			.arg(strType, -16)
+			.arg(strOperation, -14)
+			.arg(result.tableNs , 10, 'f', 1)
+			.arg(result.legacyNs, 10, 'f', 1)
+			.arg(result.tableNs / result.legacyNs, 6, 'f', 2);
+	};
+	for (auto type : types)
+	{
+		int size = QUaModbusValue::typeBlockSize(type);
+		QVector<QVector<quint16>> scalarBlocks;
+		QVector<QVector<quint16>> arrayBlocks;
+		QVector<QVariant> scalarValues;
+		QVector<QVariant> arrayValues;
+		for (auto &block : blocks)
+		{
+			scalarBlocks << block.mid(0, size);
+			arrayBlocks  << block.mid(0, size * arrayCount);
+			scalarValues << QUaModbusValue::blockToValue(scalarBlocks.last(), type);
+			arrayValues  << QUaModbusValue::blockToValue(arrayBlocks.last(), type, arrayCount);
+		}
+		report(type, "decode", measure(iterations,
+			[&](int i) { return QUaModbusValue::blockToValue(scalarBlocks.at(i % samples), type); },
+			[&](int i) { return legacy::blockToValue        (scalarBlocks.at(i % samples), type); }));
+		report(type, "encode", measure(iterations,
+			[&](int i) { return QUaModbusValue::valueToBlock(scalarValues.at(i % samples), type); },
+			[&](int i) { return legacy::valueToBlock        (scalarValues.at(i % samples), type); }));
+		report(type, "decode array", measure(iterations / arrayCount,
+			[&](int i) { return QUaModbusValue::blockToValue(arrayBlocks.at(i % samples), type, arrayCount); },
+			[&](int i) { return legacy::blockToValue        (arrayBlocks.at(i % samples), type, arrayCount); }));
+		report(type, "encode array", measure(iterations / arrayCount,
+			[&](int i) { return QUaModbusValue::valueToBlock(arrayValues.at(i % samples), type, arrayCount); },
+			[&](int i) { return legacy::valueToBlock        (arrayValues.at(i % samples), type, arrayCount); }));
+	}
+	qInfo().noquote() << QString("Total ratio (table / switch) : %1").arg(tableTotal / legacyTotal, 0, 'f', 2);
+
+	return 0;
+}